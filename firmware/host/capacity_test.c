@@ -0,0 +1,213 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include "host.h"
+#include "trace.h"
+
+/* Site coordinator water-fill
+ *
+ * The coordinator stand-in of capacity.c shares the site limit over the
+ * chargers. Its targets are checked against the CHARGE_CURRENT_MIN drop
+ * rule, a random walk of demands checks that the amps committed never add
+ * up past the site limit, and a lowered grant must stay committed for
+ * COORD_SETTLE_SEC before another charger gets the amps. Last, this
+ * charger books through Capacity_Reserve and must lower its share at once.
+ */
+
+void Trace_Record(TTraceEvent e, uint8_t arg) {}
+
+#define COORDINATOR_EMULATION
+#include "capacity.c"
+
+static void reset(void)
+{
+  memset(&Booking, 0, sizeof(Booking));
+  memset(Demand, 0, sizeof(Demand));
+  memset(Slots, 0, sizeof(Slots));
+  SiteLimit = COORD_SITE_LIMIT;
+}
+
+static uint16_t used(void)
+{
+  uint16_t sum = 0;
+  int i;
+  for (i=0; i<COORD_CHARGERS; i++)
+    sum += committed(&Slots[i]);
+  return sum;
+}
+
+//the targets for the demands of slots 1..3 under a limit
+static void fill(uint16_t limit, uint16_t d1, uint16_t d2, uint16_t d3, uint16_t t1, uint16_t t2, uint16_t t3)
+{
+  uint16_t t[COORD_CHARGERS];
+  reset();
+  SiteLimit = limit;
+  Slots[1].Demand = d1;
+  Slots[2].Demand = d2;
+  Slots[3].Demand = d3;
+  coordAllocate(t);
+  CHECK((t[0] == 0) && (t[1] == t1) && (t[2] == t2) && (t[3] == t3), "%uA over %u %u %u: %u %u %u, not %u %u %u",
+    limit, d1, d2, d3, t[1], t[2], t[3], t1, t2, t3);
+}
+
+static void drop(void)
+{
+  fill(32, 16, 16, 16, 10, 10, 10);
+  fill(32, 6, 30, 30, 6, 13, 13);   //the small demand is met, the rest share what is left
+  fill(18, 16, 16, 16, 6, 6, 6);    //just enough to go around
+  fill(17, 16, 16, 16, 8, 8, 0);    //5A each is too little, the last one goes
+  fill(11, 4, 16, 0, 4, 0, 0);      //the drop is by share, not by what the others need
+  fill(5, 16, 0, 0, 0, 0, 0);
+  fill(32, 0, 0, 0, 0, 0, 0);
+
+  //this charger counts only while its lease runs
+  uint16_t t[COORD_CHARGERS];
+  reset();
+  Slots[0].Demand = 16;
+  coordAllocate(t);
+  CHECK(t[0] == 0, "slot 0 without a lease got %u", t[0]);
+  Slots[0].LeaseLeft = 1;
+  coordAllocate(t);
+  CHECK(t[0] == 16, "slot 0 with a lease got %u", t[0]);
+}
+
+//random demands under a fixed limit, then a lower limit
+static void limit(void)
+{
+  int k, i, over = 0, lag = 0;
+  uint16_t seq = 0, limits[] = {32, 24, 12};
+  unsigned n;
+
+  srand(1);
+  for (n=0; n<CountOf(limits); n++)
+  {
+    reset();
+    SiteLimit = limits[n];
+    for (k=0; k<3000; k++)
+    {
+      if (rand()%4 == 0)
+        Coordinator_SetDemand(1+rand()%(COORD_CHARGERS-1), rand()%33);
+      if (k%10 == 0) //this charger renews its lease, now and then with new amps
+      {
+        if (!++seq)
+          seq = 1;
+        Coord_Request(seq, (rand()%3)? Slots[0].Demand: rand()%33);
+      }
+      Coord_Tick();
+      if (used() > SiteLimit)
+        over++;
+      for (i=0; i<COORD_CHARGERS; i++)
+        if (Slots[i].Alloc > Slots[i].Demand)
+          lag++;
+    }
+    CHECK(over == 0, "%uA: %d ticks over the limit", limits[n], over);
+    CHECK(lag == 0, "%uA: %d grants over the demand", limits[n], lag);
+  }
+
+  //a lower limit holds the lowered grants, then fits
+  reset();
+  for (i=1; i<COORD_CHARGERS; i++)
+    Slots[i].Demand = 16;
+  Coord_Tick();
+  CHECK(used() == 30, "three at 10A, used %u", used());
+  Coordinator_SetSiteLimit(20);
+  Coord_Tick();
+  CHECK((Slots[1].Alloc+Slots[2].Alloc+Slots[3].Alloc <= 20) && (used() == 30), "at 20A alloc %u %u %u, used %u",
+    Slots[1].Alloc, Slots[2].Alloc, Slots[3].Alloc, used());
+  for (k=0; k<COORD_SETTLE_SEC; k++)
+    Coord_Tick();
+  CHECK(used() <= 20, "after settling used %u", used());
+}
+
+//a lowered grant stays committed for COORD_SETTLE_SEC
+static void settle(void)
+{
+  int k;
+
+  reset();
+  SiteLimit = 24;
+  Coordinator_SetDemand(1, 24);
+  Coord_Tick();
+  CHECK(Slots[1].Alloc == 24, "slot 1 alone got %u", Slots[1].Alloc);
+  Coordinator_SetDemand(2, 12);
+  Coord_Tick();
+  CHECK((Slots[1].Alloc == 12) && (committed(&Slots[1]) == 24), "slot 1 lowered to %u, committed %u", Slots[1].Alloc, committed(&Slots[1]));
+  for (k=0; (k<2*COORD_SETTLE_SEC) && (Slots[2].Alloc == 0); k++)
+  {
+    CHECK(used() <= SiteLimit, "used %u while settling", used());
+    Coord_Tick();
+  }
+  CHECK(k == COORD_SETTLE_SEC, "slot 2 granted %ds after the lowering", k);
+  CHECK((Slots[1].Alloc == 12) && (Slots[2].Alloc == 12) && (used() == 24), "settled %u %u, used %u", Slots[1].Alloc, Slots[2].Alloc, used());
+}
+
+//this charger through the booking
+static void charger(void)
+{
+  int k;
+
+  reset();
+  CHECK(Capacity_Reserve(0, 32) == 0, "share before the grant");
+  Capacity_Tick();
+  CHECK((Booking.State == cbGranted) && (Capacity_Reserve(0, 32) == 32), "granted %u", Booking.Granted);
+
+  //another charger comes, this one drops to its share at once
+  Coordinator_SetDemand(1, 16);
+  Capacity_Tick();
+  CHECK(Capacity_Reserve(0, 32) == 16, "lowered share %u", Capacity_Reserve(0, 32));
+  CHECK(Slots[1].Alloc == 0, "slot 1 granted before the lowering settled");
+  for (k=0; k<COORD_SETTLE_SEC-1; k++)
+  {
+    Capacity_Tick();
+    CHECK(Slots[1].Alloc == 0, "slot 1 granted %ds after the lowering", k+1);
+  }
+  Capacity_Tick();
+  CHECK(Slots[1].Alloc == 16, "slot 1 got %u after settling", Slots[1].Alloc);
+
+  //too little for this charger alone, nothing is drawn
+  Coordinator_SetDemand(1, 0);
+  Coordinator_SetSiteLimit(CHARGE_CURRENT_MIN-1);
+  Capacity_Tick();
+  CHECK(Capacity_Reserve(0, 32) == 0, "share %u under the minimum", Capacity_Reserve(0, 32));
+
+  //a grant below the minimum is not shared out either
+  Capacity_Grant(0, CHARGE_CURRENT_MIN-1, 0);
+  CHECK(share(0) == 0, "share %u of a %uA grant", share(0), Booking.Granted);
+  Capacity_Grant(0, CHARGE_CURRENT_MIN, 0);
+  CHECK(share(0) == CHARGE_CURRENT_MIN, "share %u of a %uA grant", share(0), Booking.Granted);
+
+  Capacity_Release(0);
+  Capacity_Tick();
+  CHECK((Booking.State == cbIdle) && (Slots[0].Demand == 0), "release left %d, %uA", Booking.State, Slots[0].Demand);
+}
+
+int main(void)
+{
+  drop();
+  limit();
+  settle();
+  charger();
+  printf("fails %d\n", Fails);
+  return Fails;
+}
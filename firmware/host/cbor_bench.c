@@ -0,0 +1,80 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "jsonw.h"
+#include "jsmn.h"
+#include "cbor.h"
+
+/* Encode and decode cost of a bill/read reply, JSON against CBOR
+ *
+ * Host figures, only the ratio carries over to the target.
+ */
+
+#define BUF   264
+#define RUNS  300000
+
+static int billRead(char *buf, int cbor)
+{
+  TJsonW w;
+  static const uint32_t classWh[] = {1, 20, 300, 4000000};
+  int i;
+  JsonW_Begin(&w, buf, BUF, cbor);
+  JsonW_Str(&w, "action", "bill/read");
+  JsonW_Str(&w, "devId", "ABCDEFGHIJKLMNOPQRSTUVWX");
+  JsonW_Str(&w, "tState", "Charging");
+  JsonW_Fixed(&w, "chargeMin", 620833, 4);
+  JsonW_Milli(&w, "kWh", 12345);
+  JsonW_Milli(&w, "energyFee", -4567);
+  JsonW_Int(&w, "parkMin", 12);
+  JsonW_Bool(&w, "isPaid", 0);
+  JsonW_Float(&w, "temp", 23.0625f, 4);
+  JsonW_Float(&w, "i", -15.93f, 4);
+  JsonW_Open(&w, "classWh", '[');
+  for (i=0; i<4; i++)
+    JsonW_Uint(&w, NULL, classWh[i]);
+  JsonW_Close(&w, ']');
+  return JsonW_End(&w);
+}
+
+int main(void)
+{
+  char json[BUF], cbor[BUF], text[2*BUF];
+  jsmntok_t tokens[80];
+  jsmn_parser p;
+  int jl = billRead(json, 0), cl = billRead(cbor, 1);
+  volatile int sink = 0;
+  double encJson, encCbor, decJson, decCbor;
+
+  encJson = BENCH_NS(RUNS, sink += billRead(json, 0));
+  encCbor = BENCH_NS(RUNS, sink += billRead(cbor, 1));
+  decJson = BENCH_NS(RUNS, jsmn_init(&p); sink += jsmn_parse(&p, json, jl, tokens, CountOf(tokens)));
+  decCbor = BENCH_NS(RUNS, sink += Cbor_ToJson((uint8_t*)cbor, cl, text, sizeof(text), tokens, CountOf(tokens)));
+  printf("bill/read json %d bytes, cbor %d bytes\n", jl, cl);
+  printf("encode: json %.0f ns, cbor %.0f ns\n", encJson, encCbor);
+  printf("decode: jsmn %.0f ns, cbor to json and tokens %.0f ns\n", decJson, decCbor);
+  return 0;
+}
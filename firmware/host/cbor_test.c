@@ -0,0 +1,144 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "jsonw.h"
+#include "jsmn.h"
+#include "cbor.h"
+
+/* Cbor_ToJson round trip and malformed input
+ *
+ * A reply built with JsonW in both encodings must come back from
+ * Cbor_ToJson as the JSON text and the tokens jsmn gives for it. Every
+ * truncation and the broken items below must be refused.
+ */
+
+#define BUF   264
+
+static int billRead(char *buf, int cbor)
+{
+  TJsonW w;
+  static const uint32_t classWh[] = {1, 20, 300, 4000000};
+  int i;
+  JsonW_Begin(&w, buf, BUF, cbor);
+  JsonW_Str(&w, "action", "bill/read");
+  JsonW_Str(&w, "devId", "ABCDEFGHIJKLMNOPQRSTUVWX");
+  JsonW_Str(&w, "tState", "Charging");
+  JsonW_Fixed(&w, "chargeMin", 620833, 4);
+  JsonW_Milli(&w, "kWh", 12345);
+  JsonW_Milli(&w, "energyFee", -4567);
+  JsonW_Int(&w, "parkMin", 12);
+  JsonW_Bool(&w, "isPaid", 0);
+  JsonW_Float(&w, "temp", 23.0625f, 4);
+  JsonW_Float(&w, "i", -15.93f, 4);
+  JsonW_Open(&w, "classWh", '[');
+  for (i=0; i<4; i++)
+    JsonW_Uint(&w, NULL, classWh[i]);
+  JsonW_Close(&w, ']');
+  JsonW_Open(&w, "o", '{');
+  JsonW_Int(&w, "n", -70000);
+  JsonW_Bool(&w, "t", 1);
+  JsonW_Close(&w, '}');
+  return JsonW_End(&w);
+}
+
+static int batch(char *buf, int cbor)
+{
+  TJsonW w;
+  int i;
+  JsonW_Begin(&w, buf, BUF, cbor);
+  JsonW_Str(&w, "action", "batch");
+  JsonW_Open(&w, "cmds", '[');
+  for (i=0; i<3; i++)
+  {
+    JsonW_Open(&w, NULL, '{');
+    JsonW_Str(&w, "action", "rates/write");
+    JsonW_Milli(&w, "energy", 1234+i);
+    JsonW_Close(&w, '}');
+  }
+  JsonW_Close(&w, ']');
+  return JsonW_End(&w);
+}
+
+static void roundTrip(const char *name, int (*build)(char*, int))
+{
+  char json[BUF], cbor[BUF], text[2*BUF];
+  jsmntok_t a[80], b[80];
+  jsmn_parser p;
+  int jl = build(json, 0), cl = build(cbor, 1), n, m, i, k;
+
+  CHECK((jl > 0) && (cl > 0), "%s: build %d %d", name, jl, cl);
+  n = Cbor_ToJson((uint8_t*)cbor, cl, text, sizeof(text), b, CountOf(b));
+  jsmn_init(&p);
+  m = jsmn_parse(&p, json, jl, a, CountOf(a));
+  CHECK((n == m) && !strcmp(text, json), "%s: text\n%s\n%s", name, json, text);
+  for (i=0; (n == m) && (i<n); i++)
+    CHECK((a[i].type == b[i].type) && (a[i].start == b[i].start) && (a[i].end == b[i].end) && (a[i].size == b[i].size),
+          "%s: token %d", name, i);
+  for (k=1; k<cl; k++)
+    CHECK(Cbor_ToJson((uint8_t*)cbor, k, text, sizeof(text), b, CountOf(b)) < 0, "%s: truncated to %d accepted", name, k);
+  CHECK(Cbor_ToJson((uint8_t*)cbor, cl, text, jl, b, CountOf(b)) < 0, "%s: text overflow accepted", name);
+  CHECK(Cbor_ToJson((uint8_t*)cbor, cl, text, sizeof(text), b, n-1) < 0, "%s: token overflow accepted", name);
+  printf("%s: json %d bytes, cbor %d bytes, %d tokens\n", name, jl, cl, n);
+}
+
+static void refused(const char *name, const uint8_t *in, int len)
+{
+  char text[64];
+  jsmntok_t t[8];
+  CHECK(Cbor_ToJson(in, len, text, sizeof(text), t, CountOf(t)) < 0, "%s accepted", name);
+}
+
+int main(void)
+{
+  //{"a": ...} with a broken value
+  static const uint8_t bytes[] = {0xA1, 0x61, 'a', 0x58, 1, 0};
+  static const uint8_t quote[] = {0xA1, 0x61, 'a', 0x61, '"'};
+  static const uint8_t longText[] = {0xA1, 0x61, 'a', 0x7A, 0xFF, 0xFF, 0xFF, 0xF0, 'x'};
+  static const uint8_t longMap[] = {0xA1, 0x61, 'a', 0xBA, 0xFF, 0xFF, 0xFF, 0xFF, 0x61, 'b', 0};
+  static const uint8_t longArray[] = {0xA1, 0x61, 'a', 0x9A, 0x7F, 0xFF, 0xFF, 0xFF, 0};
+  static const uint8_t intKey[] = {0xA1, 0x01, 0x02};
+  static const uint8_t deep[] = {0xA1, 0x61, 'a', 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0};
+  static const uint8_t trailing[] = {0xA1, 0x61, 'a', 0x01, 0x00};
+  static const uint8_t half[] = {0xA1, 0x61, 'a', 0xF9, 0x3C, 0x00};
+  char text[64];
+  jsmntok_t t[8];
+
+  roundTrip("bill/read", billRead);
+  roundTrip("batch", batch);
+  refused("byte string", bytes, sizeof(bytes));
+  refused("quote in text", quote, sizeof(quote));
+  refused("text longer than input", longText, sizeof(longText));
+  refused("map longer than input", longMap, sizeof(longMap));
+  refused("array longer than input", longArray, sizeof(longArray));
+  refused("integer key", intKey, sizeof(intKey));
+  refused("nesting", deep, sizeof(deep));
+  refused("trailing bytes", trailing, sizeof(trailing));
+  CHECK((Cbor_ToJson(half, sizeof(half), text, sizeof(text), t, CountOf(t)) == 3) && !strcmp(text, "{\"a\":1.0000}"),
+        "half float %s", text);
+  printf("fails %d\n", Fails);
+  return Fails;
+}
@@ -0,0 +1,333 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Command argument checks
+ *
+ * Requests go in as frames on the WiFi port and the result comes back in
+ * the reply. A request out of range must answer -1 and change nothing.
+ * A batch in either encoding must come back as frames that all parse,
+ * holding every reply in order, one too big to share a frame included.
+ */
+
+static int SetAmps = -2, SetRamp = -2;
+
+void Setpoint_Set(TSetpointSource source, uint16_t amps) { SetAmps = amps; }
+void Setpoint_SetRampRate(uint16_t ampsPerSec) { SetRamp = ampsPerSec; }
+
+static int Authens;
+static TMilli AuthenCredit;
+
+void Trans_Authen(uint8_t conn, TMilli credit, uint32_t delaySec, uint32_t capWh, TMilli capAmount)
+{
+  Authens++;
+  AuthenCredit = credit;
+}
+
+//"result" of the reply to a request, -100 if none
+static int cmd(const char *json)
+{
+  char f[UART_BUF_SIZE];
+  const THostFrame *reply;
+  uint32_t sent = HostTxCount[0];
+  int n = strlen(json);
+  TPacket *pkt;
+  const char *r;
+
+  memcpy(f, json, n);
+  hostRxFrame(&WiFiPort, f, n);
+  pkt = hostTake();
+  if (!pkt)
+    return -100;
+  hostProcess(pkt);
+  reply = hostLastTx(&WiFiPort);
+  if ((HostTxCount[0] == sent) || !reply)
+    return -100;
+  r = strstr((const char*)reply->Data, "\"result\":");
+  return r? atoi(r+9): -100;
+}
+
+static void setpoint(void)
+{
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":16,\"ramp_Aps\":4}") == 0, "setpoint");
+  CHECK((SetAmps == 16) && (SetRamp == 4), "setpoint %d %d", SetAmps, SetRamp);
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":-1}") == 0, "setpoint release");
+  CHECK(SetAmps == SETPOINT_NONE, "setpoint release %d", SetAmps);
+  SetAmps = SetRamp = -2;
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":5}") == -1, "amps below minimum");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":64}") == -1, "amps above maximum");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":-7}") == -1, "negative amps");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":70000}") == -1, "amps wrapping uint16_t");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"ramp_Aps\":-1}") == -1, "negative ramp");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\",\"amps\":16,\"ramp_Aps\":-1}") == -1, "good amps, negative ramp");
+  CHECK(cmd("{\"cmd\":\"setpoint/write\"}") == -1, "no arguments");
+  CHECK((SetAmps == -2) && (SetRamp == -2), "rejected setpoint applied %d %d", SetAmps, SetRamp);
+}
+
+static void authen(void)
+{
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":12.5,\"delay_s\":30}") == 0, "authen");
+  CHECK((Authens == 1) && (AuthenCredit == 12500), "authen %d %d", Authens, AuthenCredit);
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":-12.5}") == -1, "negative deposit");
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":10,\"cap\":-1}") == -1, "negative cap");
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":10,\"conn\":9}") == -1, "bad connector");
+  //values past TMilli are refused, not wrapped
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":5000000}") == -1, "deposit wrapping TMilli");
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":2147483.648}") == -1, "deposit just past TMilli");
+  CHECK(Authens == 1, "rejected authen applied %d", Authens);
+  CHECK(cmd("{\"cmd\":\"trans/authen\",\"deposit\":2147483.647}") == 0, "largest deposit");
+  CHECK((Authens == 2) && (AuthenCredit == INT32_MAX), "largest deposit %d", AuthenCredit);
+}
+
+static uint32_t TimeSet;
+
+void LocalTime_Set(uint32_t secs) { TimeSet = secs; }
+
+static void timeWriteArgs(void)
+{
+  CHECK(cmd("{\"cmd\":\"time/write\",\"unix\":1700000000}") == 0, "time");
+  CHECK(TimeSet == 1700000000-LOCAL_EPOCH_UNIX, "time set %u", TimeSet);
+  TimeSet = 0;
+  CHECK(cmd("{\"cmd\":\"time/write\",\"unix\":5994967296}") == -1, "unix wrapping uint32_t");
+  CHECK(cmd("{\"cmd\":\"time/write\",\"unix\":99999999999999999999}") == -1, "unix far past uint32_t");
+  CHECK(TimeSet == 0, "rejected time set %u", TimeSet);
+}
+
+static void tariff(void)
+{
+  TTariff *t = &Config.Public.Tariff;
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"rates\":[0.1,0.2,0.3,0.4],\"weekday\":[\"00:00/0\",\"07:00/2\"]}") == 0, "tariff");
+  CHECK((t->Energy_kWh[3] == 400) && (t->Count[TARIFF_WEEKDAY] == 2) &&
+    (TARIFF_BAND_MIN(t->Band[TARIFF_WEEKDAY][1]) == 7*60) && (TARIFF_BAND_CLASS(t->Band[TARIFF_WEEKDAY][1]) == 2), "tariff stored");
+  //a nested value is skipped whole, not walked as the next key
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"rates\":[1,2,3,4],\"note\":{\"rates\":[9,9,9,9]}}") == 0, "tariff nested key");
+  CHECK((t->Energy_kWh[0] == 1000) && (t->Energy_kWh[3] == 4000), "tariff nested key stored %d", t->Energy_kWh[0]);
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"rates\":[[5,6],7,8,9]}") == -1, "nested rate");
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"weekday\":[\"00:00/0\",{\"x\":\"07:00/1\"}]}") == -1, "nested band");
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"weekday\":\"00:00/0\"}") == -1, "band not in an array");
+  CHECK(cmd("{\"cmd\":\"tariff/write\",\"weekend\":[\"0:0/0\",\"1:0/0\",\"2:0/0\",\"3:0/0\",\"4:0/0\",\"5:0/0\",\"6:0/0\"]}") == -1, "too many bands");
+  CHECK((t->Energy_kWh[0] == 1000) && (t->Count[TARIFF_WEEKDAY] == 2), "rejected tariff stored");
+}
+
+static void schedule(void)
+{
+  TSchedule *s = &Config.Public.Schedule;
+  CHECK(cmd("{\"cmd\":\"schedule/write\",\"weekday\":[\"23:00-06:00\"],\"weekend\":[]}") == 0, "schedule");
+  CHECK((s->Count[TARIFF_WEEKDAY] == 1) && (s->Count[TARIFF_WEEKEND] == 0) &&
+    (s->Window[TARIFF_WEEKDAY][0][0] == 23*60) && (s->Window[TARIFF_WEEKDAY][0][1] == 6*60), "schedule stored");
+  CHECK(cmd("{\"cmd\":\"schedule/write\",\"weekend\":[\"00:00-24:00\"],\"x\":{\"weekday\":[]}}") == 0, "schedule nested key");
+  CHECK((s->Count[TARIFF_WEEKDAY] == 1) && (s->Count[TARIFF_WEEKEND] == 1), "schedule nested key stored");
+  CHECK(cmd("{\"cmd\":\"schedule/write\",\"weekday\":[[\"01:00-02:00\"]]}") == -1, "nested window");
+  CHECK(cmd("{\"cmd\":\"schedule/write\",\"weekday\":{\"a\":\"01:00-02:00\"}}") == -1, "window not in an array");
+  CHECK((s->Window[TARIFF_WEEKDAY][0][0] == 23*60) && (s->Count[TARIFF_WEEKDAY] == 1), "rejected schedule stored");
+}
+
+static void policy(void)
+{
+  TPricePolicy *p = &Config.Public.Policy;
+  CHECK(cmd("{\"cmd\":\"policy/write\",\"groups\":[100,100,0,80,50,1]}") == 0, "policy");
+  CHECK((p->Group[1].EnergyPct == 80) && (p->Group[1].ParkingPct == 50) && (p->Group[1].Flags == 1), "policy stored");
+  CHECK(cmd("{\"cmd\":\"policy/write\",\"groups\":[90,70,0],\"note\":{\"groups\":[1,1,1]}}") == 0, "policy nested key");
+  CHECK((p->Group[0].EnergyPct == 90) && (p->Group[0].ParkingPct == 70), "policy nested key stored %d", p->Group[0].EnergyPct);
+  CHECK(cmd("{\"cmd\":\"policy/write\",\"groups\":[[1,2],3,4]}") == -1, "nested group value");
+  CHECK(cmd("{\"cmd\":\"policy/write\",\"groups\":[1,2,3,{\"a\":1},5,6]}") == -1, "object group value");
+  CHECK(cmd("{\"cmd\":\"policy/write\",\"groups\":[256,0,0]}") == -1, "group value range");
+  CHECK((p->Group[0].EnergyPct == 90) && (p->Group[1].EnergyPct == 80), "rejected policy stored");
+}
+
+//a trace/read that fills a frame on its own
+uint32_t Trace_Read(uint32_t from, TTraceEntry *entries, int count, int *read)
+{
+  memset(entries, 0x5A, count*sizeof(*entries));
+  *read = count;
+  return from+count;
+}
+
+#define BATCH_SEEN (2*BATCH_CMDS) //room for replies sent twice
+
+static const char *BatchCmds[BATCH_CMDS] = {"time/write", "setpoint/write", "trace/read", "trans/stop",
+  "time/write", "link/read", "setpoint/write", "trans/stop"};
+
+//the head of a CBOR item, its major type or -1; indefinite lengths come back as -1
+static int cborHead(const uint8_t **in, const uint8_t *end, uint32_t *v)
+{
+  int major, info, k;
+  if (*in >= end)
+    return -1;
+  major = **in>>5;
+  info = *(*in)++&0x1F;
+  if (info < 24)
+    *v = info;
+  else if (info == 31)
+    *v = 0xFFFFFFFF;
+  else if (info <= 27)
+  {
+    k = 1<<(info-24);
+    if (end-*in < k)
+      return -1;
+    for (*v=0; k--; )
+      *v = *v<<8 | *(*in)++; //a 64 bit head keeps the low word, the walk only skips it
+  }
+  else
+    return -1;
+  return major;
+}
+
+//skips one well formed CBOR item; the "action" of a map at depth 0, a reply
+//sent alone, or at depth 2, a reply in a batch, goes to actions
+static const uint8_t *cborSkip(const uint8_t *in, const uint8_t *end, int depth, int *n, char actions[][24])
+{
+  const uint8_t *val;
+  uint32_t v, i, len;
+  int major = cborHead(&in, end, &v), action;
+
+  switch (major)
+  {
+    case 0: case 1: case 7:
+      return in;
+    case 2: case 3:
+      if ((v == 0xFFFFFFFF) || (v > (uint32_t)(end-in)))
+        return NULL;
+      return in+v;
+    case 6:
+      return cborSkip(in, end, depth, n, actions);
+    case 4: case 5:
+      for (i=0; (v == 0xFFFFFFFF)? (in < end) && (*in != 0xFF): i < v; i++)
+      {
+        action = (major == 5) && ((depth == 0) || (depth == 2)) && (end-in >= 7) && !memcmp(in, "\x66" "action", 7);
+        if (major == 5)
+          if (!(in = cborSkip(in, end, depth+1, n, actions)))
+            return NULL;
+        val = in;
+        if (!(in = cborSkip(in, end, depth+1, n, actions)))
+          return NULL;
+        if (action && (*n < BATCH_SEEN) && (cborHead(&val, end, &len) == 3) && (len < 24))
+        {
+          memcpy(actions[*n], val, len);
+          actions[*n][len] = 0;
+          *n += !!strcmp(actions[*n], "batch");
+        }
+      }
+      if (v == 0xFFFFFFFF)
+        return (in < end)? in+1: NULL;
+      return in;
+  }
+  return NULL;
+}
+
+//the actions of the replies in a sent frame, appended to actions
+static int batchReplies(const THostFrame *f, int cbor, char actions[][24], int n)
+{
+  static char text[2*UART_BUF_SIZE];
+  static jsmntok_t tok[200];
+  jsmn_parser p;
+  int r, i, k;
+
+  if (!ValidateCrc32Blk((void*)f->Data, f->Len))
+    return -1;
+  if (cbor) //the data of trace/read is a byte string, which Cbor_ToJson does not take
+    return (cborSkip(f->Data, f->Data+f->Len-4, 0, &n, actions) == f->Data+f->Len-4)? n: -1;
+  memcpy(text, f->Data, f->Len-4);
+  text[f->Len-4] = 0;
+  jsmn_init(&p);
+  r = jsmn_parse(&p, text, f->Len-4, tok, CountOf(tok));
+  if ((r < 1) || (tok[0].type != JSMN_OBJECT))
+    return -1;
+  for (i=1; i+1<r; i++) //the replies array of the batch frame
+    if ((tok[i].type == JSMN_STRING) && (tok[i].end-tok[i].start == 7) && !memcmp(text+tok[i].start, "replies", 7))
+      break;
+  if ((i+1 >= r) || (tok[i+1].type != JSMN_ARRAY)) //a reply sent on its own
+    i = -1;
+  for (k=(i<0)? 0: i+2; k+1<r; k++)
+    if ((tok[k].type == JSMN_STRING) && (tok[k].end-tok[k].start == 6) && !memcmp(text+tok[k].start, "action", 6) &&
+      (tok[k+1].end-tok[k+1].start < 24) && (i>=0 || k==1) && (n < BATCH_SEEN))
+    {
+      memcpy(actions[n], text+tok[k+1].start, tok[k+1].end-tok[k+1].start);
+      actions[n][tok[k+1].end-tok[k+1].start] = 0;
+      if (strcmp(actions[n], "batch"))
+        n++;
+    }
+  return n;
+}
+
+static void batch(int cbor)
+{
+  char f[UART_BUF_SIZE], actions[BATCH_SEEN][24];
+  const char *enc = cbor? "CBOR": "JSON";
+  uint32_t sent = HostTxCount[0], frames;
+  TPacket *pkt;
+  TJsonW w;
+  int k, n = 0;
+
+  JsonW_Begin(&w, f, PKT_PLAYLOAD_SIZE, cbor);
+  JsonW_Str(&w, "cmd", "batch");
+  JsonW_Open(&w, "cmds", '[');
+  for (k=0; k<BATCH_CMDS; k++)
+  {
+    JsonW_Open(&w, NULL, '{');
+    JsonW_Str(&w, "cmd", BatchCmds[k]);
+    JsonW_Close(&w, '}');
+  }
+  JsonW_Close(&w, ']');
+  k = JsonW_End(&w);
+  CHECK(k > 0, "%s batch request", enc);
+  hostRxFrame(&WiFiPort, f, k);
+  pkt = hostTake();
+  CHECK(pkt != NULL, "%s batch not taken", enc);
+  if (!pkt)
+    return;
+  hostProcess(pkt);
+  frames = HostTxCount[0]-sent;
+  CHECK((frames >= 3) && (frames <= HOST_TX_LOG), "%s batch in %u frames", enc, frames);
+  for (; (sent < HostTxCount[0]) && (n >= 0); sent++)
+  {
+    n = batchReplies(&HostTxLog[0][sent%HOST_TX_LOG], cbor, actions, n);
+    CHECK(n >= 0, "%s batch frame %u does not parse", enc, frames-(HostTxCount[0]-sent));
+  }
+  CHECK(n == BATCH_CMDS, "%s batch %d replies", enc, n);
+  for (k=0; (k<n) && (k<BATCH_CMDS); k++)
+    CHECK(!strcmp(actions[k], BatchCmds[k]), "%s batch reply %d is %s, not %s", enc, k, actions[k], BatchCmds[k]);
+  printf("%s batch: %d replies in %u frames\n", enc, n, frames);
+}
+
+int main(void)
+{
+  hostInit();
+  setpoint();
+  authen();
+  timeWriteArgs();
+  tariff();
+  schedule();
+  policy();
+  batch(0);
+  batch(1);
+  printf("fails %d\n", Fails);
+  return Fails;
+}
@@ -0,0 +1,226 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "hal.h"
+#include "crc32.h"
+#define DH_MODEL_C
+#include "dh_model.h"
+#include "app_main.h"
+#include "mem.h"
+#include "PilotThread.h"
+#include "trans.h"
+#include "CT_Thread.h"
+#include "capacity.h"
+#include "setpoint.h"
+#include "trace.h"
+#include "taper.h"
+#include "tariff.h"
+#include "schedule.h"
+#include "ledger.h"
+#include "totals.h"
+#include "telemetry.h"
+
+#define WEAK                __attribute__((weak))
+uint32_t HostTick;
+uint32_t HostTxCount[2];
+THostFrame HostTxLog[2][HOST_TX_LOG];
+
+/* RTOS, one queue and one pool as dhThread has */
+
+typedef struct
+{
+  uint32_t Size, Count, Head;
+  void **Items;
+} THostQueue;
+
+typedef struct
+{
+  uint32_t Count, Block;
+  uint8_t *Mem, *Used;
+} THostPool;
+
+osMessageQueueId_t osMessageQueueNew(uint32_t count, uint32_t size, const osMessageQueueAttr_t *attr)
+{
+  THostQueue *q = calloc(1, sizeof(*q));
+  q->Size = count;
+  q->Items = calloc(count, sizeof(void*));
+  return q;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t id, const void *msg, uint8_t prio, uint32_t timeout)
+{
+  THostQueue *q = id;
+  if (q->Count == q->Size)
+    return osErrorResource;
+  q->Items[(q->Head+q->Count++)%q->Size] = *(void* const*)msg;
+  return osOK;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t id, void *msg, uint8_t *prio, uint32_t timeout)
+{
+  THostQueue *q = id;
+  if (!q->Count)
+  {
+    HostTick += timeout;
+    return osErrorTimeout;
+  }
+  *(void**)msg = q->Items[q->Head];
+  q->Head = (q->Head+1)%q->Size;
+  q->Count--;
+  return osOK;
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t id)
+{
+  return ((THostQueue*)id)->Count;
+}
+
+osMemoryPoolId_t osMemoryPoolNew(uint32_t count, uint32_t size, const osMemoryPoolAttr_t *attr)
+{
+  THostPool *p = calloc(1, sizeof(*p));
+  p->Count = count;
+  p->Block = size;
+  p->Mem = attr? attr->mp_mem: calloc(count, size);
+  p->Used = calloc(count, 1);
+  return p;
+}
+
+void* osMemoryPoolAlloc(osMemoryPoolId_t id, uint32_t timeout)
+{
+  THostPool *p = id;
+  uint32_t i;
+  for (i=0; i<p->Count; i++)
+    if (!p->Used[i])
+    {
+      p->Used[i] = 1;
+      return &p->Mem[i*((p->Block+3)/4*4)];
+    }
+  return NULL;
+}
+
+osStatus_t osMemoryPoolFree(osMemoryPoolId_t id, void *block)
+{
+  THostPool *p = id;
+  p->Used[((uint8_t*)block-p->Mem)/((p->Block+3)/4*4)] = 0;
+  return osOK;
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+  return HostTick;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+  HostTick += ticks;
+  return osOK;
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t id, uint32_t flags)
+{
+  return flags;
+}
+
+/* Peripherals, a TX DMA completes as soon as it is enabled */
+
+static void txDone(TSPort *port, int n)
+{
+  THostFrame *f = &HostTxLog[n][HostTxCount[n]++%HOST_TX_LOG];
+  f->Len = port->TxDma->CNDTR;
+  memcpy(f->Data, port->TxBuffer, f->Len);
+  SPort_TxDone(port);
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef *ch, FunctionalState state)
+{
+  if (state && (ch == WiFiPort.TxDma))
+    txDone(&WiFiPort, 0);
+  else if (state && (ch == GprsPort.TxDma))
+    txDone(&GprsPort, 1);
+}
+
+void DMA_DeInit(DMA_Channel_TypeDef *ch) {}
+void DMA_Init(DMA_Channel_TypeDef *ch, DMA_InitTypeDef *init) { ch->CNDTR = init->DMA_BufferSize; }
+void DMA_ITConfig(DMA_Channel_TypeDef *ch, uint32_t it, FunctionalState state) {}
+void USART_Cmd(USART_TypeDef *uart, FunctionalState state) {}
+void USART_DMACmd(USART_TypeDef *uart, uint16_t req, FunctionalState state) {}
+void USART_ITConfig(USART_TypeDef *uart, uint16_t it, FunctionalState state) {}
+void SetTimeout_us(TIM_TypeDef *tim, uint16_t us) { tim->CR1 |= TIM_CR1_CEN; }
+
+/* The rest of the firmware, defaults a test may replace */
+
+TConfig Config;
+__IO float CurTemperature = 25;
+__IO uint16_t CapacityReserved, CapacityOffered;
+osThreadId_t CTThread_id, PilotThread_id, DhThread_id;
+
+WEAK void WiFi_Reset(void) {}
+WEAK void GPRS_PowerStep(TGprsStep step) {}
+WEAK int EEP_WriteBlk(uint16_t eepromAddr, void* src, uint16_t size, void* updateObj, TRangeCheckFunc RangechckFunc) { memcpy(updateObj, src, size); return 1; }
+WEAK void GetPowerVar(float *CurrentA, uint32_t *EnergyWh) { if (CurrentA) *CurrentA = 0; if (EnergyWh) *EnergyWh = 0; }
+WEAK int IsCoverOpended(void) { return 0; }
+WEAK int IsFatalError(void) { return 0; }
+WEAK int IsPanic(void) { return 0; }
+WEAK uint32_t LocalTime_Get(void) { return 0; }
+WEAK void LocalTime_Set(uint32_t secs) {}
+WEAK void SetTempTestPin(uint8_t value) {}
+WEAK void SetVoltage(TVoltageLevel state) {}
+WEAK void Pilot_GetEdgeOffLatency(TLatencyStat *stat) { memset(stat, 0, sizeof(*stat)); }
+
+WEAK void Capacity_GetBooking(TCapBooking *booking) { memset(booking, 0, sizeof(*booking)); }
+WEAK int Capacity_Grant(uint16_t seq, uint16_t amps, uint16_t leaseSec) { return 1; }
+WEAK int Capacity_PeekPending(TCapMsg *msg) { return 0; }
+WEAK void Capacity_Sent(uint16_t seq) {}
+WEAK void Setpoint_Set(TSetpointSource source, uint16_t amps) {}
+WEAK void Setpoint_SetRampRate(uint16_t ampsPerSec) {}
+WEAK void Taper_GetInfo(TTaperInfo *info) { memset(info, 0, sizeof(*info)); }
+WEAK void RangeCheck_Tariff(void *obj) {}
+WEAK void Tariff_Changed(void) {}
+WEAK void RangeCheck_Schedule(void *obj) {}
+WEAK void Schedule_Changed(void) {}
+WEAK void RangeCheck_Telemetry(void *obj) {}
+WEAK uint8_t Telemetry_Peek(uint8_t *conn, TTeleSample *sample) { return 0; }
+WEAK void Telemetry_Sent(uint8_t conn, uint8_t fields, const TTeleSample *sample) {}
+WEAK void Telemetry_Tick(void) {}
+WEAK void Totals_Get(TTotalsRec *totals) { memset(totals, 0, sizeof(*totals)); }
+WEAK void Ledger_Ack(uint32_t serial) {}
+WEAK uint32_t Ledger_GetAcked(void) { return 0; }
+WEAK int Ledger_GetPending(void) { return 0; }
+WEAK uint32_t Ledger_GetDropped(void) { return 0; }
+WEAK int Ledger_Next(uint32_t after, TLedgerRec *rec) { return 0; }
+WEAK uint32_t Trace_GetIrqOff(uint32_t *pc) { *pc = 0; return 0; }
+WEAK uint32_t Trace_GetMaxCycles(void) { return 0; }
+WEAK uint32_t Trace_Read(uint32_t from, TTraceEntry *entries, int count, int *read) { *read = 0; return from; }
+
+WEAK void Trans_Authen(uint8_t conn, TMilli credit, uint32_t delaySec, uint32_t capWh, TMilli capAmount) {}
+WEAK void Trans_GetBill(uint8_t conn, TBill *bill) { memset(bill, 0, sizeof(*bill)); }
+WEAK TTransState Trans_GetState(uint8_t conn) { return trIdle; }
+WEAK char* Trans_GetStateName(uint8_t conn) { return "idle"; }
+WEAK int Trans_SetState(uint8_t conn, TTransState newState, TMilli paidAmount) { return 1; }
@@ -0,0 +1,113 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#ifndef __DH_MODEL_H__
+#define __DH_MODEL_H__
+
+/* Host model around dhThread.c
+ *
+ * A test includes dhThread.c for its static parts, then this header, and
+ * links dh_model.c. That models the RTOS calls, the UART DMA and the
+ * modules dhThread talks to. The module calls are weak, a test defines its
+ * own to see what a command did.
+ */
+
+#include "dhThread.h"
+
+#define HOST_TX_LOG         16
+
+typedef struct
+{
+  uint16_t Len; //with the CRC
+  uint8_t Data[UART_BUF_SIZE];
+} THostFrame;
+
+extern uint32_t HostTick; //osKernelGetTickCount(), osDelay() moves it on
+extern uint32_t HostTxCount[2]; //frames sent on WiFiPort, GprsPort
+extern THostFrame HostTxLog[2][HOST_TX_LOG]; //the last ones, by HostTxCount%HOST_TX_LOG
+
+#ifndef DH_MODEL_C
+
+//what dhThread() does before its loop
+static void hostInit(void)
+{
+  buildCmdHash();
+  SPortMsgQ = osMessageQueueNew(RX_FRAMES, sizeof(TPacket*), NULL);
+  RxPool = osMemoryPoolNew(RX_FRAMES, sizeof(TPacket), &RxPoolAttr);
+  sportInit(&WiFiPort);
+  sportInit(&GprsPort);
+}
+
+//bytes as the RX DMA writes them into the ring, with its half and full
+//ring interrupts
+static void hostRxBytes(TSPort *port, const void *b, int n)
+{
+  const uint8_t *s = b;
+  uint16_t head;
+  while (n--)
+  {
+    head = (UART_RX_RING-port->RxDma->CNDTR)%UART_RX_RING;
+    port->Ring[head] = *s++;
+    head = (head+1)%UART_RX_RING;
+    port->RxDma->CNDTR = UART_RX_RING-head;
+    if ((head == UART_RX_RING/2) || (head == 0))
+      SPort_RxDrain(port);
+  }
+}
+
+//a frame with its CRC then an idle line, frame holds n+4 bytes
+static void hostRxFrame(TSPort *port, void *frame, int n)
+{
+  CalcCrc32Blk(frame, n+4);
+  hostRxBytes(port, frame, n+4);
+  SPort_RxIdle(port);
+}
+
+//the next posted frame, NULL if none
+static TPacket* hostTake(void)
+{
+  TPacket *pkt;
+  return (osMessageQueueGet(SPortMsgQ, &pkt, NULL, 0) == osOK)? pkt: NULL;
+}
+
+//dhThread's handling of a taken frame
+static void hostProcess(TPacket *pkt)
+{
+  TSPort *port = pkt->Port;
+  processFrame(pkt);
+  osMemoryPoolFree(RxPool, pkt);
+  port->RxQueued--;
+}
+
+//the last frame sent on a port, NULL if none
+static const THostFrame* hostLastTx(TSPort *port)
+{
+  int n = port == &GprsPort;
+  return HostTxCount[n]? &HostTxLog[n][(HostTxCount[n]-1)%HOST_TX_LOG]: NULL;
+}
+#endif
+
+#endif
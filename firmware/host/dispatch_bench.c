@@ -0,0 +1,68 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Command lookup
+ *
+ * findCommand over every entry of Commands[] in turn, by the seeded hash
+ * and by the linear jsoneq search it replaced, which it still falls back
+ * to with no seed found. On the target diag/read has the worst lookup in
+ * cycles with IRQ_OFF_STATS defined.
+ */
+
+#define RUNS  2000000
+
+int main(void)
+{
+  enum {N = sizeof(Commands)/sizeof(Commands[0])};
+  static char json[N][64];
+  static jsmntok_t tok[N];
+  uint32_t seed;
+  volatile int sink = 0;
+  double hash, linear;
+  int i, k;
+
+  hostInit();
+  for (i=0; i<N; i++)
+  {
+    sprintf(json[i], "{\"cmd\":\"%s\"}", Commands[i].command);
+    tok[i].type = JSMN_STRING;
+    tok[i].start = 8;
+    tok[i].end = 8+strlen(Commands[i].command);
+    CHECK(findCommand(json[i], &tok[i]) == &Commands[i], "%s not found", Commands[i].command);
+  }
+  seed = CmdSeed;
+  k = 0;
+  hash = BENCH_NS(RUNS, sink += findCommand(json[k], &tok[k])!=NULL; k = (k+1)%N);
+  CmdSeed = 0;
+  k = 0;
+  linear = BENCH_NS(RUNS, sink += findCommand(json[k], &tok[k])!=NULL; k = (k+1)%N);
+  printf("%d commands, seed %u: hash %.1f ns, linear %.1f ns a lookup\n", N, seed, hash, linear);
+  return Fails;
+}
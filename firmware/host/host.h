@@ -0,0 +1,57 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#ifndef __HOST_H__
+#define __HOST_H__
+
+/* Host test support
+ *
+ * The tests in this directory build modules of ../main with the host gcc
+ * against small models of the RTOS and the peripherals, see the Makefile.
+ * A test prints one line per finding and returns the failure count.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+static int Fails __attribute__((unused));
+
+#ifndef CountOf
+#define CountOf(x)          (sizeof(x)/sizeof(*x))
+#endif
+
+#define CHECK(cond, ...)    do { if (!(cond)) { Fails++; printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+//ns per call of an expression run n times
+#define BENCH_NS(n, expr)   ({ struct timespec t0_, t1_; int r_; \
+                               clock_gettime(CLOCK_MONOTONIC, &t0_); \
+                               for (r_=0; r_<(n); r_++) { expr; } \
+                               clock_gettime(CLOCK_MONOTONIC, &t1_); \
+                               ((t1_.tv_sec-t0_.tv_sec)*1e9+(t1_.tv_nsec-t0_.tv_nsec))/(n); })
+
+#endif
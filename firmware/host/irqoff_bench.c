@@ -0,0 +1,148 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "hal.h"
+
+/* Longest interrupt masked sections of the billing path
+ *
+ * trans.c is built with MASK_IRQ timing each section in host cycles,
+ * keyed by the line of its UNMASK_IRQ, over charging sessions with a bill
+ * tick per second and the reads the pilot, RFID and server threads make.
+ * The maximum also catches the host scheduler, the mean is the figure to
+ * compare. On the target the worst case comes from IRQ_OFF_STATS and
+ * diag/read.
+ */
+
+#undef MASK_IRQ
+#undef UNMASK_IRQ
+#define MASK_IRQ            int masked = __disable_irq(); uint64_t maskedCyc = nowCyc();
+#define UNMASK_IRQ          if (!masked) { irqOff(__LINE__, nowCyc()-maskedCyc); __enable_irq(); }
+
+//host cycle counter, the DWT->CYCCNT of IRQ_OFF_STATS
+static inline uint64_t nowCyc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec*1000000000+t.tv_nsec;
+#endif
+}
+
+static struct
+{
+  uint32_t Count;
+  uint64_t TotalCyc, MaxCyc;
+} Site[1000];
+
+static void irqOff(int line, uint64_t cyc)
+{
+  Site[line].Count++;
+  Site[line].TotalCyc += cyc;
+  if (cyc > Site[line].MaxCyc)
+    Site[line].MaxCyc = cyc;
+}
+
+#include "app_main.h"
+#include "trace.h"
+#include "ledger.h"
+
+TConfig Config;
+void Trace_Record(TTraceEvent e, uint8_t arg) {}
+TMilli Tariff_GetRate(uint8_t *cls) { *cls = 0; return Config.Public.Rates.Energy_kWh; }
+int Ledger_Push(TLedgerRec *rec) { return 1; }
+uint32_t LocalTime_Get(void) { return 0; }
+int IsHardwareOkay(void) { return 1; }
+void CountUpTimerReset(void) {}
+void CountUpTimerStart(void) {}
+void CountUpTimerStop(void) {}
+void DlyTimerSet(uint32_t seconds) {}
+void ResetPowerVar(void) {}
+void Taper_Reset(void) {}
+
+#include "trans.c"
+
+int main(void)
+{
+  TBill bill;
+  uint32_t wh = 0, sec, s, i, worst = 0, sections = 0;
+  uint64_t clockCyc;
+  double maskedCyc = 0;
+
+  Config.Public.Rates.Energy_kWh = 6500;
+  Config.Public.Rates.Parking_hr = 1000;
+  Config.Public.Rates.FreeParking_min = 2;
+  Config.Public.Rates.ParkPenalty_min = 1000;
+  for (s=0; s<200; s++)
+  {
+    Trans_SetState(0, trHandshake, 0);
+    Trans_SetState(0, trAuthen, 0);
+    Trans_Authen(0, 100000, 0, 0, -1);
+    Trans_SetState(0, trAuthen, 0);
+    for (sec=0; sec<3600; sec++)
+    {
+      if (sec == 3000)
+        Trans_SetState(0, trParking, 0);
+      if (sec < 3000)
+        wh += 2;
+      Trans_BillTick(0, sec < 3000? sec: sec-3000, wh);
+      for (i=0; i<10; i++) //pilot loop, bill/read, meter/read, RFID
+      {
+        Trans_CheckBill(0);
+        Trans_GetBill(0, &bill);
+        Trans_IsBillClosed(0);
+        Trans_GetState(0);
+      }
+    }
+    Trans_SetState(0, trBilling, 0);
+    Trans_BillTick(0, 600, wh);
+    Trans_SetState(0, trPaid, Trans_CheckBill(0));
+    Trans_SetState(0, trIdle, 0);
+    wh = 0;
+  }
+  for (i=0, clockCyc=~0ull; i<1000; i++) //taken off the means
+  {
+    uint64_t c = nowCyc();
+    c = nowCyc()-c;
+    if (c < clockCyc)
+      clockCyc = c;
+  }
+  printf("trans.c masked sections in host cycles, less %llu of the counter read: line count mean max\n", (unsigned long long)clockCyc);
+  for (i=0; i<CountOf(Site); i++)
+    if (Site[i].Count)
+    {
+      printf("%4u %9u %5.0f %6llu\n", i, Site[i].Count, (double)Site[i].TotalCyc/Site[i].Count-(double)clockCyc, (unsigned long long)Site[i].MaxCyc);
+      sections += Site[i].Count;
+      maskedCyc += Site[i].TotalCyc-Site[i].Count*(double)clockCyc;
+      if (Site[i].TotalCyc/Site[i].Count > Site[worst].TotalCyc/(Site[worst].Count? Site[worst].Count: 1))
+        worst = i;
+    }
+  printf("per charging hour: %u sections, %.0f cycles masked\n", sections/s, maskedCyc/s);
+  printf("longest on average: line %u, %.0f cycles\n", worst, (double)Site[worst].TotalCyc/Site[worst].Count-(double)clockCyc);
+  return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <setjmp.h>
+#include "host.h"
+#include "journal.c"
+
+/* Journal records torn by a power cut
+ *
+ * writeRec is cut at each byte of the two pages it writes, with the byte being
+ * written left as is or garbled. Each time a boot replays the journal and
+ * must restore the session of the record before the torn one. A full
+ * write must restore the new record instead, and a restored session must
+ * carry on into the next slot. Once with blank slots ahead, once with the
+ * ring wrapped so the torn slot held an old record. Last, the bill serial
+ * taken from the sequence must stay above the ledger's over a blank ring.
+ */
+
+TI2C I2C2Port;
+static uint8_t Eep[EEP_JOURNAL_ADDR+JOURNAL_SLOTS*sizeof(TJournalRec)];
+static uint32_t Tick;
+static TTransSession Session;
+static TBill Bill, Restored;
+static uint32_t RestoredStart;
+static int Restores;
+static int CutAt = -1, Garble; //byte of the next record write the power goes at
+static jmp_buf PowerCut;
+
+uint32_t osKernelGetTickCount(void) { return Tick; }
+void Trace_Record(TTraceEvent event, uint8_t arg) {}
+static uint32_t LedgerNewest, Pushed;
+
+int Ledger_Push(TLedgerRec *rec) { Pushed = rec->Serial; return 1; }
+uint32_t Ledger_GetNewest(void) { return LedgerNewest; }
+void Trans_GetSession(uint8_t conn, TTransSession *session) { *session = Session; }
+void Trans_GetBill(uint8_t conn, TBill *bill) { *bill = Bill; }
+
+void Trans_GetDone(uint8_t conn, TTransDone *done)
+{
+  memset(done, 0, sizeof(*done));
+  done->Session = Session.Session;
+  done->Bill = Bill;
+}
+
+void Trans_Restore(uint8_t conn, const TTransSession *session, const TBill *bill)
+{
+  Restores++;
+  Restored = *bill;
+  RestoredStart = session->StartTime;
+}
+
+int EEPRead(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  memcpy(buf, &Eep[addr], size);
+  return 1;
+}
+
+int EEPWrite(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  const uint8_t *b = buf;
+  int i;
+  for (i=0; i<size; i++)
+  {
+    if (i == CutAt)
+    {
+      if (Garble)
+        Eep[addr+i] = ~b[i];
+      CutAt = -1;
+      longjmp(PowerCut, 1);
+    }
+    Eep[addr+i] = b[i];
+  }
+  return 1;
+}
+
+static void boot(void)
+{
+  memset(&Jr, 0, sizeof(Jr));
+  memset(Cn, 0, sizeof(Cn));
+  Restores = 0;
+  memset(&Restored, 0, sizeof(Restored));
+  Journal_Replay();
+}
+
+//a checkpoint with the meter moved on, the step split over two classes
+static void meter(uint32_t wh)
+{
+  Bill.ClassWh[1] += (wh-Bill.Energy_Wh)/3;
+  Bill.ClassWh[2] = wh-Bill.ClassWh[0]-Bill.ClassWh[1]-Bill.ClassWh[3];
+  Bill.Energy_Wh = wh;
+  Bill.ChargingSec += JOURNAL_CHECKPOINT_SEC;
+  Bill.EnergyFee = wh*65/10;
+  Tick += MsToOSTicks(JOURNAL_CHECKPOINT_SEC*1000);
+  Journal_Tick();
+}
+
+static void tear(const char *ring)
+{
+  uint8_t saved[sizeof(Eep)];
+  TBill before;
+  uint32_t seq;
+  int cut, garble;
+
+  memcpy(saved, Eep, sizeof(Eep));
+  before = Bill;
+  seq = Jr.Seq;
+  for (cut=0; cut<=(int)sizeof(TJournalRec); cut++)
+    for (garble=0; garble<2; garble++)
+    {
+      memcpy(Eep, saved, sizeof(Eep));
+      boot();
+      Bill = before;
+      CutAt = cut<(int)sizeof(TJournalRec)? cut: -1;
+      Garble = garble;
+      if (!setjmp(PowerCut))
+        meter(before.Energy_Wh+1234);
+      CutAt = -1;
+      boot();
+      CHECK((Restored.ClassWh[0]+Restored.ClassWh[1]+Restored.ClassWh[2]+Restored.ClassWh[3] == Restored.Energy_Wh) &&
+        (RestoredStart == Session.StartTime), "%s ring, cut at byte %d: classes %u of %u Wh, start %u",
+        ring, cut, Restored.ClassWh[1]+Restored.ClassWh[2], Restored.Energy_Wh, RestoredStart);
+      if (cut < (int)sizeof(TJournalRec))
+        CHECK((Restores == 1) && !memcmp(&Restored, &before, sizeof(TBill)) && (Jr.Seq == seq),
+          "%s ring, cut at byte %d%s: %u Wh seq %u", ring, cut, garble? " garbled": "", Restored.Energy_Wh, Jr.Seq);
+      else
+        CHECK((Restores == 1) && (Restored.Energy_Wh == before.Energy_Wh+1234) && (Jr.Seq == seq+1),
+          "%s ring, full write: %u Wh", ring, Restored.Energy_Wh);
+
+      //the restored session goes on in the next slot
+      Session.State = trBilling;
+      Bill = Restored;
+      meter(Restored.Energy_Wh+1);
+      Session.State = trCharging;
+      boot();
+      CHECK((Restores == 1) && (Restored.Energy_Wh == Bill.Energy_Wh), "%s ring, cut at byte %d: no record after it", ring, cut);
+    }
+  memcpy(Eep, saved, sizeof(Eep));
+  boot();
+  Bill = before;
+}
+
+//bill serials keep rising when the ring restarts under an older ledger
+static void serials(void)
+{
+  uint8_t saved[sizeof(Eep)];
+  uint32_t seq;
+
+  memcpy(saved, Eep, sizeof(Eep));
+  boot();
+  seq = Jr.Seq;
+  LedgerNewest = seq+1; //pushed just before its end record was cut
+  boot();
+  CHECK(Jr.Seq == seq, "serial of a cut end record moved %u %u", Jr.Seq, seq);
+  LedgerNewest = seq+50; //ring older than the ledger
+  boot();
+  CHECK(Jr.Seq == seq+50, "ring behind the ledger %u", Jr.Seq);
+
+  memset(Eep, 0xFF, sizeof(Eep));
+  LedgerNewest = 500; //blank ring, bills up to 500 stored or acknowledged
+  boot();
+  Session.Session = 2;
+  Session.State = trCharging;
+  meter(10);
+  Session.State = trPaid;
+  Journal_Tick();
+  CHECK(Pushed == 502, "bill after a blank ring %u", Pushed);
+  memcpy(Eep, saved, sizeof(Eep));
+  LedgerNewest = 0;
+  Session.Session = 1;
+  Session.State = trCharging;
+  boot();
+}
+
+int main(void)
+{
+  int i;
+
+  memset(Eep, 0xFF, sizeof(Eep));
+  Session.Session = 1;
+  Session.State = trCharging;
+  Session.Credit = 50000;
+  Session.StartTime = 123456789;
+  Session.IsPayByRFIDCard = 1;
+  memset(Session.CardSn, 0x5A, sizeof(Session.CardSn));
+  boot();
+  meter(100);
+  meter(200);
+  tear("blank");
+  for (i=0; i<JOURNAL_SLOTS+5; i++)
+    meter(300+i*100);
+  tear("wrapped");
+  serials();
+  printf("fails %d\n", Fails);
+  return Fails;
+}
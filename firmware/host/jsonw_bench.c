@@ -0,0 +1,154 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "hal.h"
+#include "RFID_Card.h"
+#include "dhThread.h"
+#include "jsonw.h"
+
+/* Reply build cost, snprintf against the JSON writer
+ *
+ * rates/read, power/read and bill/read as they were built with snprintf
+ * and %0.4f before, and with the writer calls their handlers make now.
+ * Both must give the same text. Host figures, the gap is wider on the
+ * target where every float conversion is soft-float.
+ */
+
+#define BUF   PKT_PLAYLOAD_SIZE
+#define RUNS  300000
+
+static const char DevId[] = "ABCDEFGHIJKLMNOPQRSTUVWX";
+static volatile float Temp = 23.0625f, Current = 15.93f;
+static volatile uint32_t Sec = 3725, Wh = 12345;
+static volatile int32_t Fee = -4567;
+static char Old[BUF], New[BUF];
+
+static int32_t secToMin4(uint32_t sec)
+{
+  return (sec/60)*10000 + ((sec%60)*10000+30)/60;
+}
+
+static void begin(TJsonW *w, const char *action)
+{
+  JsonW_Begin(w, New, BUF, 0);
+  JsonW_Str(w, "action", action);
+  JsonW_Str(w, "devId", DevId);
+}
+
+static int ratesOld(void)
+{
+  return snprintf(Old, BUF, "{\"action\":\"rates/read\",\"devId\":\"%s\","
+    "\"tState\":\"%s\",\"kWh\":" MILLI_FMT ",\"park_hr\":" MILLI_FMT ",\"parkPen_min\":" MILLI_FMT ","
+    "\"freePark_min\":%d,\"temp\":%0.4f}",
+    DevId, "Idle", MILLI_ARG(6500), MILLI_ARG(1250), MILLI_ARG(100), 15, Temp);
+}
+
+static int ratesNew(void)
+{
+  TJsonW w;
+  begin(&w, "rates/read");
+  JsonW_Str(&w, "tState", "Idle");
+  JsonW_Milli(&w, "kWh", 6500);
+  JsonW_Milli(&w, "park_hr", 1250);
+  JsonW_Milli(&w, "parkPen_min", 100);
+  JsonW_Int(&w, "freePark_min", 15);
+  JsonW_Float(&w, "temp", Temp, 4);
+  return JsonW_End(&w);
+}
+
+static int powerOld(void)
+{
+  return snprintf(Old, BUF, "{\"action\":\"power/read\",\"devId\":\"%s\","
+    "\"tState\":\"%s\",\"v(V)\":%d,\"i(A)\":%0.4f,\"kWh\":" MILLI_FMT ",\"temp\":%0.4f}",
+    DevId, "Charging", 230, Current, MILLI_ARG(Wh), Temp);
+}
+
+static int powerNew(void)
+{
+  TJsonW w;
+  begin(&w, "power/read");
+  JsonW_Str(&w, "tState", "Charging");
+  JsonW_Int(&w, "v(V)", 230);
+  JsonW_Float(&w, "i(A)", Current, 4);
+  JsonW_Milli(&w, "kWh", Wh);
+  JsonW_Float(&w, "temp", Temp, 4);
+  return JsonW_End(&w);
+}
+
+static int billOld(void)
+{
+  return snprintf(Old, BUF, "{\"action\":\"bill/read\",\"devId\":\"%s\","
+    "\"tState\":\"%s\",\"chargeMin\":%0.4f,\"kWh\":" MILLI_FMT ",\"energyFee\":" MILLI_FMT ",\"parkMin\":%d,"
+    "\"parkFee\":" MILLI_FMT ",\"parkPen\":" MILLI_FMT ",\"payable\":" MILLI_FMT ",\"paidAmt\":" MILLI_FMT ",\"isPaid\":%s,\"temp\":%0.4f,"
+    "\"classWh\":[%u,%u,%u,%u]}",
+    DevId, "Charging", (float)Sec/60, MILLI_ARG(Wh), MILLI_ARG(Fee), 12,
+    MILLI_ARG(0), MILLI_ARG(0), MILLI_ARG(Fee), MILLI_ARG(0), "false", Temp, 1, 20, 300, 4000);
+}
+
+static int billNew(void)
+{
+  static const uint32_t classWh[] = {1, 20, 300, 4000};
+  TJsonW w;
+  int i;
+  begin(&w, "bill/read");
+  JsonW_Str(&w, "tState", "Charging");
+  JsonW_Fixed(&w, "chargeMin", secToMin4(Sec), 4);
+  JsonW_Milli(&w, "kWh", Wh);
+  JsonW_Milli(&w, "energyFee", Fee);
+  JsonW_Int(&w, "parkMin", 12);
+  JsonW_Milli(&w, "parkFee", 0);
+  JsonW_Milli(&w, "parkPen", 0);
+  JsonW_Milli(&w, "payable", Fee);
+  JsonW_Milli(&w, "paidAmt", 0);
+  JsonW_Bool(&w, "isPaid", 0);
+  JsonW_Float(&w, "temp", Temp, 4);
+  JsonW_Open(&w, "classWh", '[');
+  for (i=0; i<4; i++)
+    JsonW_Uint(&w, NULL, classWh[i]);
+  JsonW_Close(&w, ']');
+  return JsonW_End(&w);
+}
+
+static void bench(const char *name, int (*old)(void), int (*new)(void))
+{
+  volatile int sink = 0;
+  double o, n;
+  int len = new();
+  old();
+  CHECK(!strcmp(Old, New), "%s\n%s\n%s", name, Old, New);
+  o = BENCH_NS(RUNS, sink += old());
+  n = BENCH_NS(RUNS, sink += new());
+  printf("%-11s %3d bytes: snprintf %4.0f ns, writer %4.0f ns\n", name, len, o, n);
+}
+
+int main(void)
+{
+  bench("rates/read", ratesOld, ratesNew);
+  bench("power/read", powerOld, powerNew);
+  bench("bill/read", billOld, billNew);
+  return Fails;
+}
@@ -0,0 +1,130 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "host.h"
+#include "ledger.c"
+
+/* Ledger slots
+ *
+ * A new bill takes an empty or acknowledged slot, never one still waiting
+ * for the server. With every slot waiting it is dropped and counted, and
+ * the acknowledged serial and the count survive a reset.
+ */
+
+TI2C I2C2Port;
+static uint8_t Eep[EEP_LEDGER_ADDR+LEDGER_SLOTS*sizeof(TLedgerRec)];
+
+int EEPRead(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  memcpy(buf, &Eep[addr], size);
+  return 1;
+}
+
+int EEPWrite(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  memcpy(&Eep[addr], buf, size);
+  return 1;
+}
+
+//the config blocks of app_main, without their CRC16
+int EEP_ReadBlk(uint16_t eepromAddr, void *dest, uint16_t size, TRangeCheckFunc RangechckFunc)
+{
+  static const uint8_t blank[16] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  if (!memcmp(&Eep[eepromAddr], blank, size))
+    return 0;
+  memcpy(dest, &Eep[eepromAddr], size);
+  return 1;
+}
+
+int EEP_WriteBlk(uint16_t eepromAddr, void* src, uint16_t size, void* updateObj, TRangeCheckFunc RangechckFunc)
+{
+  memcpy(&Eep[eepromAddr], src, size);
+  if (updateObj)
+    memcpy(updateObj, src, size);
+  return 1;
+}
+
+static void push(uint32_t serial)
+{
+  TLedgerRec rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.Serial = serial;
+  rec.Energy_Wh = serial*10;
+  CHECK(Ledger_Push(&rec), "push %u", serial);
+}
+
+//serials stored after the acknowledged one, in order
+static int stored(uint32_t *serials)
+{
+  TLedgerRec rec;
+  uint32_t after;
+  int n = 0;
+  for (after=Ledger_GetAcked(); Ledger_Next(after, &rec); after=rec.Serial)
+    serials[n++] = rec.Serial;
+  return n;
+}
+
+int main(void)
+{
+  uint32_t s[LEDGER_SLOTS+1];
+  int i, n;
+
+  memset(Eep, 0xFF, sizeof(Eep));
+  Ledger_Init();
+  CHECK((Ledger_GetAcked() == 0) && (Ledger_GetNewest() == 0) && (Ledger_GetPending() == 0), "blank ledger");
+  for (i=1; i<=LEDGER_SLOTS; i++)
+    push(i);
+  CHECK(Ledger_GetPending() == LEDGER_SLOTS, "full %d", Ledger_GetPending());
+
+  //all waiting, the new one is counted and the stored ones stay
+  push(LEDGER_SLOTS+1);
+  n = stored(s);
+  CHECK((n == LEDGER_SLOTS) && (s[0] == 1) && (s[n-1] == LEDGER_SLOTS), "kept %d, %u..%u", n, s[0], s[n-1]);
+  CHECK(Ledger_GetDropped() == 1, "dropped %u", Ledger_GetDropped());
+
+  //a replayed session replaces its own record even when full
+  push(5);
+  CHECK((stored(s) == LEDGER_SLOTS) && (Ledger_GetDropped() == 1), "replayed session counted as dropped");
+
+  //acknowledged slots are reused, the oldest first
+  Ledger_Ack(3);
+  push(LEDGER_SLOTS+2);
+  push(LEDGER_SLOTS+3);
+  n = stored(s);
+  CHECK((n == LEDGER_SLOTS-1) && (s[0] == 4) && (s[n-1] == LEDGER_SLOTS+3), "after ack %d, %u..%u", n, s[0], s[n-1]);
+  CHECK((Serial[0] == LEDGER_SLOTS+2) && (Serial[1] == LEDGER_SLOTS+3) && (Serial[2] == 3), "slots %u %u %u", Serial[0], Serial[1], Serial[2]);
+  CHECK(Ledger_GetNewest() == LEDGER_SLOTS+3, "newest %u", Ledger_GetNewest());
+
+  //a reset keeps the acknowledged serial and the count
+  memset(Serial, 0, sizeof(Serial));
+  memset(&Ack, 0, sizeof(Ack));
+  Ledger_Init();
+  CHECK((Ledger_GetAcked() == 3) && (Ledger_GetDropped() == 1) && (Ledger_GetPending() == LEDGER_SLOTS-1), "after reset %u %u %d",
+    Ledger_GetAcked(), Ledger_GetDropped(), Ledger_GetPending());
+
+  //an ack past everything stored marks the newest
+  Ledger_Ack(1000);
+  CHECK((Ledger_GetAcked() == LEDGER_SLOTS+3) && (Ledger_GetPending() == 0), "ack all %u", Ledger_GetAcked());
+  printf("fails %d\n", Fails);
+  return Fails;
+}
@@ -0,0 +1,125 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Link failover against a modem model
+ *
+ * The server never answers on WiFi, so pushes move to GPRS. The modem
+ * is powered up in steps, each a pass of the loop apart with its delay
+ * between, and drops what it is sent until it has attached, MODEM_ATTACH
+ * after its reset pulse ends. Then it loops frames through to the server, which
+ * answers a link/up with a request on the same port. link/up has to be
+ * sent again until it gets through, and no more once the server answers.
+ */
+
+#define MODEM_ATTACH        MsToOSTicks(25000)
+
+static uint32_t AttachTick = -1;
+static int LinkUps, LinkUpsHeard, Answered;
+static uint32_t LastLinkUpTick, MinLinkUpGap = -1;
+static uint32_t StepTick[gprsResetOff+1];
+static int Steps;
+
+void GPRS_PowerStep(TGprsStep step)
+{
+  CHECK(step == Steps+1, "power step %d after %d", step, Steps);
+  Steps = step;
+  StepTick[step] = HostTick;
+  if (step == gprsResetOff)
+    AttachTick = HostTick+MODEM_ATTACH;
+}
+
+//what the server makes of the frames sent on GPRS since the last look
+static void server(void)
+{
+  static uint32_t seen;
+  char req[32] = "{\"cmd\":\"link/read\"}";
+
+  for (; seen<HostTxCount[1]; seen++)
+  {
+    const THostFrame *f = &HostTxLog[1][seen%HOST_TX_LOG];
+    if (!strstr((const char*)f->Data, "\"link/up\""))
+      continue;
+    if (LinkUps++ && (HostTick-LastLinkUpTick < MinLinkUpGap))
+      MinLinkUpGap = HostTick-LastLinkUpTick;
+    LastLinkUpTick = HostTick;
+    if (HostTick < AttachTick)
+      continue; //dropped by the modem
+    LinkUpsHeard++;
+    hostRxFrame(&GprsPort, req, strlen(req));
+    Answered++;
+  }
+}
+
+//one pass of the dhThread loop, a DH_IDLE_DLY wait when there is no frame
+static void step(void)
+{
+  TPacket *pkt = hostTake();
+  if (pkt)
+    hostProcess(pkt);
+  else
+    HostTick += DH_IDLE_DLY;
+  linkTick();
+  server();
+}
+
+int main(void)
+{
+  int ups;
+
+  hostInit();
+  while (HostTick < LINK_SILENT_DLY+MODEM_ATTACH+LINK_ANNOUNCE_DLY*2)
+    step();
+  CHECK(Link == &GprsPort, "link %s", linkName(Link));
+  CHECK(Failovers == 1, "failovers %u", Failovers);
+  CHECK((Steps == gprsResetOff) && (StepTick[gprsResetOn]-StepTick[gprsPowerOn] >= GPRS_POWER_DLY) &&
+    (StepTick[gprsResetOff]-StepTick[gprsResetOn] >= GPRS_RESET_DLY), "power-up steps %d at %u %u %u",
+    Steps, StepTick[gprsPowerOn], StepTick[gprsResetOn], StepTick[gprsResetOff]);
+  CHECK(LinkUps > 1, "link/up not sent again, %d", LinkUps);
+  CHECK(MinLinkUpGap >= LINK_ANNOUNCE_DLY, "link/up every %u ticks", MinLinkUpGap);
+  CHECK(LinkUpsHeard == 1, "link/up heard %d times", LinkUpsHeard);
+  CHECK(GprsPort.RxFrames == 1, "gprs frames %u", GprsPort.RxFrames);
+  CHECK(!Announce.Pending, "still announcing");
+
+  //answered, so no more link/up while the server keeps the link
+  ups = LinkUps;
+  while (HostTick < LastLinkUpTick+LINK_SILENT_DLY-MsToOSTicks(1000))
+    step();
+  CHECK(LinkUps == ups, "link/up after the answer, %d", LinkUps-ups);
+  CHECK(Link == &GprsPort, "link %s", linkName(Link));
+
+  //silent again, back to WiFi which has no modem to wait for
+  while (Link == &GprsPort)
+    step();
+  CHECK(Failovers == 2, "failovers %u", Failovers);
+  CHECK(strstr((const char*)hostLastTx(&WiFiPort)->Data, "\"link/up\"") != NULL, "link/up on wifi");
+  printf("%d link/up, %d heard, fails %d\n", LinkUps, LinkUpsHeard, Fails);
+  return Fails;
+}
@@ -0,0 +1,310 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include <ucontext.h>
+#include "host.h"
+#include "PilotThread.c"
+
+/* Pilot edge to contactor off
+ *
+ * PilotThread runs as a coroutine on a virtual clock. osDelay, the flags
+ * wait and the timers move the clock, the code itself takes no time. While
+ * charging, the pilot is pulled to 12V (unplug) or 9V (EV stop) the way the
+ * ADC watchdog interrupt reports it: half the edges while the thread is
+ * blocked, half partway through a pass, from the models the thread calls.
+ * With the contactor on the thread must only block in the loop's flags
+ * wait, never in an osDelay such as WaitVoltageStable's or a yield, so
+ * every edge wakes it at once and edgeOff reads 0 us by construction.
+ * This checks the wake path and that no edge is lost, not the latency:
+ * that is the edgeOff figure of diag/read on the target. The host time of
+ * the pass that opens the contactor is printed for the code alone.
+ * First, budgetTick is checked to hand the stop on and lower the offer.
+ */
+
+#define TRIALS              400
+#define EDGE_CALLS          64 //calls to the models in about a second of charging
+
+static ucontext_t Sched, Pilot;
+static uint8_t PilotStack[256*1024];
+static uint64_t NowUs, WakeUs; //the thread runs again at WakeUs
+static uint32_t Flags, WaitMask;
+
+typedef struct
+{
+  osTimerFunc_t Func;
+  void *Arg;
+  uint64_t DueUs; //0 stopped
+} THostTimer;
+
+static THostTimer Timers[8];
+static int TimerCount;
+static TTransState TransState;
+static int DelayedOn; //the thread blocked other than in its flags wait with the contactor on
+static int EdgeIn; //calls to the models until an edge, 0 none
+static TVoltageLevel EdgeLevel;
+static uint64_t EdgeAtUs;
+
+/* RTOS on the virtual clock, PilotThread is the only thread */
+
+static void block(uint64_t us)
+{
+  WakeUs = us;
+  swapcontext(&Pilot, &Sched);
+}
+
+uint32_t osKernelGetTickCount(void) { return NowUs/1000; }
+osStatus_t osDelay(uint32_t ticks) { DelayedOn += IS_CONTACTOR_ON; WaitMask = 0; block(NowUs+ticks*1000ull); return osOK; }
+osStatus_t osThreadYield(void) { DelayedOn += IS_CONTACTOR_ON; WaitMask = 0; block(NowUs); return osOK; }
+uint32_t osThreadFlagsGet(void) { return Flags; }
+uint32_t osThreadFlagsClear(uint32_t flags) { uint32_t f = Flags; Flags &= ~flags; return f; }
+
+uint32_t osThreadFlagsSet(osThreadId_t id, uint32_t flags)
+{
+  Flags |= flags;
+  if (WaitMask & Flags)
+    WakeUs = NowUs;
+  return Flags;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+  if (!(Flags & flags))
+  {
+    WaitMask = flags;
+    block(NowUs+timeout*1000ull);
+    WaitMask = 0;
+  }
+  return (Flags & flags)? Flags: osFlagsErrorTimeout;
+}
+
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *arg, const osTimerAttr_t *attr)
+{
+  Timers[TimerCount].Func = func;
+  Timers[TimerCount].Arg = arg;
+  return &Timers[TimerCount++];
+}
+
+osStatus_t osTimerStart(osTimerId_t id, uint32_t ticks) { ((THostTimer*)id)->DueUs = NowUs+ticks*1000ull; return osOK; }
+osStatus_t osTimerStop(osTimerId_t id) { ((THostTimer*)id)->DueUs = 0; return osOK; }
+uint32_t osTimerIsRunning(osTimerId_t id) { return ((THostTimer*)id)->DueUs != 0; }
+
+/* The rest of the board, charging at 16A of 32A */
+
+//an edge partway through a pass, the thread is in one of the models
+static void irqPoint(void)
+{
+  if (EdgeIn && !--EdgeIn)
+  {
+    EdgeAtUs = NowUs;
+    SetVoltage(EdgeLevel);
+  }
+}
+
+TConfig Config;
+osThreadId_t PilotThread_id;
+__IO uint16_t InjectedGroupIndex, ADC_InjectedConvertedValueTab[10];
+static uint16_t Pulse;
+static uint32_t StopWh = ENERGY_NO_STOP, EnergyStop;
+static uint16_t BudgetAmps = SETPOINT_NONE;
+
+void GPIO_WriteBit(GPIO_TypeDef *port, uint16_t pin, BitAction bit)
+{
+  port->ODR = bit? (port->ODR | pin): (port->ODR & ~pin);
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef *port, uint16_t pin) { return 1; }
+void TIM_SelectOutputTrigger(TIM_TypeDef *tim, uint16_t source) {}
+int PWM_IsDC(void) { return (Pulse==0)||(Pulse==PWM_FREQ); }
+uint16_t PWM_GetPulse(void) { return Pulse; }
+void PWM_SetPulse(uint16_t pulse) { if (pulse<=PWM_FREQ) Pulse = pulse; }
+void PWM_SetDutyCycle(float duty) { PWM_SetPulse(duty*PWM_FREQ+0.5); }
+void PWM_ExtTriggerDisable(void) {}
+void PWM_ExtTriggerEnable(void) {}
+uint16_t Capacity_Reserve(uint8_t conn, uint16_t amps) { return 32; }
+void Capacity_Release(uint8_t conn) {}
+void Capacity_Tick(void) {}
+uint32_t CountUpTimerGet(void) { return 0; }
+void GetPowerVar(float *current, uint32_t *wh) { if (current) *current = 16; if (wh) *wh = 0; }
+float GetChargingCurrents(float phases[3]) { phases[0] = 16; phases[1] = phases[2] = 0; return 16; }
+void ResetChargingCounter(void) {}
+int IsDrawingCurrent(float current) { return current > 1; }
+void SetEnergyStop(uint32_t wh) { EnergyStop = wh; }
+int IsEnergyStopped(void) { irqPoint(); return 0; }
+int IsCoverOpended(void) { return 0; }
+int IsTempOutOfRange(void) { return 0; }
+int IsHardwareOkay(void) { return 1; }
+int IsDlyTimerStopped(void) { return 1; }
+int Schedule_IsOpen(void) { return 1; }
+void Setpoint_Set(TSetpointSource source, uint16_t amps) { if (source == spBudget) BudgetAmps = amps; }
+uint16_t Setpoint_GetLimit(void) { return 32; }
+uint32_t Setpoint_Ramp(uint16_t target, int ramp) { return target*1000; }
+uint16_t Setpoint_ResponseRef(uint16_t offered) { return offered; }
+void Taper_Reset(void) {}
+uint32_t Trace_NowUs(void) { return NowUs; }
+void Trace_Record(TTraceEvent event, uint8_t arg) {}
+void Trace_Tick(void) {}
+TTransState Trans_GetState(uint8_t conn) { irqPoint(); return TransState; }
+void Trans_BillTick(uint8_t conn, uint32_t sec, uint32_t wh) { irqPoint(); }
+uint8_t Trans_IsCreditOut(uint8_t conn) { return 0; }
+uint32_t Trans_GetEnergyStop(uint8_t conn) { return StopWh; }
+void Trans_PaidStateDelayTick(uint8_t conn) { irqPoint(); }
+
+int Trans_SetState(uint8_t conn, TTransState state, TMilli paid)
+{
+  if ((state != trAuthen) || (TransState < trAuthen)) //authorised at once, and only once
+    TransState = state==trAuthen? trCharging: state;
+  return 1;
+}
+
+/* Scheduler */
+
+static void pilotEntry(void)
+{
+  PilotThread(NULL);
+}
+
+//timers and the thread up to NowUs+us
+static void run(uint64_t us)
+{
+  uint64_t end = NowUs+us, next;
+  int i;
+  while (1)
+  {
+    next = WakeUs<end? WakeUs: end;
+    for (i=0; i<TimerCount; i++)
+      if (Timers[i].DueUs && (Timers[i].DueUs < next))
+        next = Timers[i].DueUs;
+    NowUs = next;
+    for (i=0; i<TimerCount; i++)
+      if (Timers[i].DueUs && (Timers[i].DueUs <= NowUs))
+      {
+        Timers[i].DueUs = 0;
+        Timers[i].Func(Timers[i].Arg);
+      }
+    if (WakeUs <= NowUs)
+      swapcontext(&Sched, &Pilot);
+    else if (NowUs == end)
+      return;
+  }
+}
+
+//a pilot level from the EV, the ADC watchdog interrupt reports it
+static void pilot(TVoltageLevel level, uint64_t runUs)
+{
+  SetVoltage(level);
+  run(runUs);
+}
+
+//the session's stop goes to the CT thread, the offer drops to the minimum
+//BUDGET_WARN_SEC ahead of it at the present 16A
+static void budget(void)
+{
+  uint32_t warnWh = 16*230*BUDGET_WARN_SEC/3600;
+
+  budgetTick(500);
+  CHECK((EnergyStop == ENERGY_NO_STOP) && (BudgetAmps == SETPOINT_NONE), "no cap: stop %u, %u A", EnergyStop, BudgetAmps);
+  StopWh = 1000;
+  budgetTick(1000-warnWh-1);
+  CHECK((EnergyStop == 1000) && (BudgetAmps == SETPOINT_NONE), "cap ahead: stop %u, %u A", EnergyStop, BudgetAmps);
+  budgetTick(1000-warnWh);
+  CHECK(BudgetAmps == CHARGE_CURRENT_MIN, "cap within %u Wh: %u A", warnWh, BudgetAmps);
+  budgetTick(1000);
+  CHECK(BudgetAmps == CHARGE_CURRENT_MIN, "cap reached: %u A", BudgetAmps);
+  StopWh = ENERGY_NO_STOP;
+  budgetTick(1000);
+  CHECK((EnergyStop == ENERGY_NO_STOP) && (BudgetAmps == SETPOINT_NONE), "cap lifted: stop %u, %u A", EnergyStop, BudgetAmps);
+}
+
+int main(void)
+{
+  TLatencyStat stat;
+  uint64_t offUs[2] = {0, 0}, maxUs[2] = {0, 0}, t;
+  double ns, passNs = 0, passMaxNs = 0;
+  int k, n[2] = {0, 0}, stop, blocked = 0;
+
+  Config.Private.Power.ChargeCurrentMax = 32;
+  Config.Private.Power.ChargeVoltage = 230;
+  budget();
+  CONTACTOR(OFF);
+  osThreadFlagsSet(PilotThread_id, PILOT_UPD_VARS); //app_main does it once the config is read
+  getcontext(&Pilot);
+  Pilot.uc_stack.ss_sp = PilotStack;
+  Pilot.uc_stack.ss_size = sizeof(PilotStack);
+  makecontext(&Pilot, pilotEntry, 0);
+  run(1000000);
+  srand(29);
+  for (k=0; k<TRIALS; k++)
+  {
+    stop = k&1;
+    EdgeLevel = stop? pi9VDC: pi12VDC;
+    pilot(pi9VDC, 3500000); //S9Vdc, then S9Vac once its timer is out
+    pilot(pi6VDC, 500000); //S6Vac, authorised and charging
+    CHECK(IS_CONTACTOR_ON && (ReadCurStateObj()==&S6Vac), "trial %d not charging, %s", k, ReadCurStateObj()->Name);
+    if (k&2) //partway through a pass
+    {
+      EdgeIn = 1+rand()%EDGE_CALLS;
+      for (t=NowUs; IS_CONTACTOR_ON && (NowUs-t < 4000000); )
+        run(100);
+      CHECK(EdgeIn == 0, "trial %d edge not injected", k);
+      EdgeIn = 0;
+      t = EdgeAtUs;
+    }
+    else //while the thread is blocked
+    {
+      run(rand()%500000);
+      t = NowUs;
+      ns = BENCH_NS(1, pilot(EdgeLevel, 0));
+      passNs += ns;
+      if (ns > passMaxNs)
+        passMaxNs = ns;
+      blocked++;
+      while (IS_CONTACTOR_ON && (NowUs-t < 2000000))
+        run(100);
+    }
+    t = NowUs-t;
+    offUs[stop] += t;
+    if (t > maxUs[stop])
+      maxUs[stop] = t;
+    n[stop]++;
+    //unplugged back to S12Vdc, an unplug under load is an error to reset
+    pilot(pi12VDC, 500000);
+    osThreadFlagsSet(PilotThread_id, PILOT_RESET_ERROR);
+    run(500000);
+    CHECK(ReadCurStateObj()==&S12Vdc, "trial %d not idle again, %s", k, ReadCurStateObj()->Name);
+    TransState = trIdle;
+  }
+  Pilot_GetEdgeOffLatency(&stat);
+  printf("unplug:  %d edges, contactor off after %.1f ms mean, %.1f ms max\n", n[0], offUs[0]/1000.0/n[0], maxUs[0]/1000.0);
+  printf("EV stop: %d edges, contactor off after %.1f ms mean, %.1f ms max\n", n[1], offUs[1]/1000.0/n[1], maxUs[1]/1000.0);
+  printf("edgeOff: %u edges, %u/%u/%u us min/avg/max\n", stat.Count, stat.MinUs, stat.Count? stat.TotalUs/stat.Count: 0, stat.MaxUs);
+  printf("edge pass on the host: %.0f ns mean, %.0f ns max\n", passNs/blocked, passMaxNs);
+  CHECK(stat.Count == TRIALS, "edgeOff counted %u of %d", stat.Count, TRIALS);
+  CHECK(DelayedOn == 0, "%d delays or yields with the contactor on", DelayedOn);
+  CHECK(stat.MaxUs == 0, "edge waited %u us on the virtual clock", stat.MaxUs);
+  printf("fails %d\n", Fails);
+  return Fails;
+}
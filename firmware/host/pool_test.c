@@ -0,0 +1,198 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Receive buffers handed off by pointer
+ *
+ * One port, then both, blast frames back to back, an idle line right after
+ * the last byte, while dhThread takes from 8 to 900 byte times over each.
+ * Every frame must come through whole and in order, or be counted in
+ * RxDrops. Then an
+ * overrun, and noise before a frame paused half way.
+ */
+
+#define FRAMES              3000
+#define SENT                64 //frames kept to check against, per port
+
+typedef struct
+{
+  TSPort *Port;
+  uint8_t Tag;
+  uint8_t Sent[SENT][UART_BUF_SIZE];
+  uint16_t Len[SENT];
+  int Pos, Next; //byte of frame Next being sent, Next-1 its last one
+  int Got, Last; //frames taken by dhThread, the id of the last one
+} TStream;
+
+static TStream Stream[2];
+
+static void streamFrame(TStream *s)
+{
+  uint8_t *f = s->Sent[s->Next%SENT];
+  int n = 9+rand()%(UART_BUF_SIZE-9), i;
+  f[0] = s->Tag; //never '{', CBOR or one that ends too soon
+  memcpy(&f[1], &s->Next, 4);
+  for (i=5; i<n-4; i++)
+    f[i] = rand();
+  CalcCrc32Blk(f, n);
+  s->Len[s->Next%SENT] = n;
+  s->Pos = 0;
+}
+
+//the next byte of a stream, or the idle line after a frame
+static void streamByte(TStream *s)
+{
+  if (s->Pos == s->Len[s->Next%SENT])
+  {
+    SPort_RxIdle(s->Port);
+    s->Next++;
+    streamFrame(s);
+  }
+  else
+    hostRxBytes(s->Port, &s->Sent[s->Next%SENT][s->Pos++], 1);
+}
+
+static void check(TPacket *pkt)
+{
+  TStream *s = &Stream[pkt->Port == &GprsPort];
+  int id, ok;
+  memcpy(&id, &pkt->payload[1], 4);
+  ok = (pkt->payload[0] == s->Tag) && (id > s->Last) && (id > s->Next-SENT) && (id < s->Next);
+  CHECK(ok, "%c frame %d after %d", s->Tag, id, s->Last);
+  if (!ok)
+    return;
+  CHECK((pkt->len == s->Len[id%SENT]) && !memcmp(pkt->payload, s->Sent[id%SENT], pkt->len), "%c frame %d content", s->Tag, id);
+  s->Last = id;
+  s->Got++;
+}
+
+//dhThread done with a frame, without dispatching it
+static void release(TPacket *pkt)
+{
+  TSPort *port = pkt->Port;
+  osMemoryPoolFree(RxPool, pkt);
+  port->RxQueued--;
+}
+
+static void blast(int parse, int ports)
+{
+  TPacket *pkt = NULL;
+  int busy = 0, k, lost;
+
+  for (k=0; k<2; k++)
+  {
+    Stream[k].Port = k? &GprsPort: &WiFiPort;
+    Stream[k].Tag = k? 'G': 'W';
+    Stream[k].Next = k<ports? 0: FRAMES;
+    Stream[k].Got = 0;
+    Stream[k].Last = -1;
+    Stream[k].Port->RxDrops = Stream[k].Port->RxOverruns = 0;
+    streamFrame(&Stream[k]);
+  }
+  while ((Stream[0].Next < FRAMES) || (Stream[1].Next < FRAMES))
+  {
+    for (k=0; k<2; k++)
+      if (Stream[k].Next < FRAMES)
+        streamByte(&Stream[k]);
+    if (pkt && (--busy <= 0))
+    {
+      release(pkt);
+      pkt = NULL;
+    }
+    if (!pkt && (pkt = hostTake()))
+    {
+      check(pkt);
+      busy = parse;
+    }
+  }
+  if (pkt)
+    release(pkt);
+  while ((pkt = hostTake()))
+  {
+    check(pkt);
+    release(pkt);
+  }
+  for (k=0; k<ports; k++)
+  {
+    lost = FRAMES-Stream[k].Got-Stream[k].Port->RxDrops;
+    printf("parse %4d byte times: %c sent %d, taken %d, rxDrops %u, lost unaccounted %d\n",
+      parse, Stream[k].Tag, FRAMES, Stream[k].Got, Stream[k].Port->RxDrops, lost);
+    CHECK((lost == 0) && !Stream[k].Port->RxOverruns, "%c lost %d", Stream[k].Tag, lost);
+  }
+  //one port the shortest frame apart, two take a buffer each while dhThread has the third
+  if ((ports == 1) && (parse < 9))
+    CHECK(!Stream[0].Port->RxDrops, "drops while keeping up");
+}
+
+int main(void)
+{
+  static const int parse[] = {8, 100, 300, 600, 900};
+  uint8_t f[40], b[400];
+  TPacket *pkt;
+  int i;
+
+  hostInit();
+  for (i=0; i<CountOf(parse); i++)
+    blast(parse[i], 1);
+  for (i=0; i<CountOf(parse); i++)
+    blast(parse[i], 2);
+
+  //longer than a buffer
+  memset(b, 0x55, sizeof(b));
+  hostRxBytes(&WiFiPort, b, sizeof(b));
+  SPort_RxIdle(&WiFiPort);
+  CHECK((WiFiPort.RxOverruns == 1) && !WiFiPort.RxPos && !hostTake(), "overrun %u", WiFiPort.RxOverruns);
+
+  //noise, then a frame with an idle line half way
+  for (i=0; i<36; i++)
+    f[i] = i;
+  CalcCrc32Blk(f, 40);
+  hostRxBytes(&WiFiPort, b, 10);
+  SPort_RxIdle(&WiFiPort);
+  hostRxBytes(&WiFiPort, f, 20);
+  SPort_RxIdle(&WiFiPort);
+  hostRxBytes(&WiFiPort, &f[20], 20);
+  SPort_RxIdle(&WiFiPort);
+  pkt = hostTake();
+  CHECK(pkt && (pkt->len == 40) && !memcmp(pkt->payload, f, 40), "noise then paused frame");
+  if (pkt)
+    hostProcess(pkt);
+
+  //noise the gap timer ends, then a frame
+  hostRxBytes(&WiFiPort, b, 7);
+  SPort_RxIdle(&WiFiPort);
+  SPort_RxGap(&WiFiPort);
+  hostRxBytes(&WiFiPort, f, 40);
+  SPort_RxIdle(&WiFiPort);
+  pkt = hostTake();
+  CHECK(pkt && (pkt->len == 40) && !memcmp(pkt->payload, f, 40), "noise then frame");
+  printf("fails %d\n", Fails);
+  return Fails;
+}
@@ -0,0 +1,91 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Idle line to a tokenised frame
+ *
+ * Before, the idle line ISR ran the CRC over the whole frame and dhThread
+ * then ran jsmn over it. Now both run on the drains as bytes arrive and
+ * the idle line finishes the tail. Host figures for a rates/write request.
+ */
+
+#define RUNS  200000
+
+static uint64_t nowNs(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec*1000000000+t.tv_nsec;
+}
+
+int main(void)
+{
+  static char f[UART_BUF_SIZE] = "{\"cmd\":\"rates/write\",\"conn\":1,\"kWh\":6.500,\"park_hr\":10.000,"
+    "\"parkPen_min\":1.000,\"freePark_min\":15,\"list\":[1,20,300,4000],\"s\":\"ab\",\"t\":true}";
+  jsmntok_t tokens[RX_TOKENS];
+  jsmn_parser p;
+  uint64_t t, before = 0, idle = 0, drains = 0;
+  int n = strlen(f), r, i;
+  volatile int sink = 0;
+
+  hostInit();
+  CalcCrc32Blk(f, n+4);
+  for (r=0; r<RUNS; r++)
+  {
+    t = nowNs();
+    sink += ValidateCrc32Blk(f, n+4);
+    jsmn_init(&p);
+    sink += jsmn_parse(&p, f, n, tokens, RX_TOKENS);
+    before += nowNs()-t;
+
+    for (i=0; i<n+4; i++) //hostRxBytes with the drains timed
+    {
+      uint16_t head = (UART_RX_RING-WiFiPort.RxDma->CNDTR)%UART_RX_RING;
+      WiFiPort.Ring[head] = f[i];
+      head = (head+1)%UART_RX_RING;
+      WiFiPort.RxDma->CNDTR = UART_RX_RING-head;
+      if ((head == UART_RX_RING/2) || (head == 0))
+      {
+        t = nowNs();
+        SPort_RxDrain(&WiFiPort);
+        drains += nowNs()-t;
+      }
+    }
+    t = nowNs();
+    SPort_RxIdle(&WiFiPort);
+    idle += nowNs()-t;
+    TPacket *pkt = hostTake();
+    sink += pkt->TokenCount;
+    osMemoryPoolFree(RxPool, pkt);
+    WiFiPort.RxQueued--;
+  }
+  printf("%d byte request, idle line to tokens: before %.0f ns, now %.0f ns, with the drains %.0f ns\n",
+    n+4, (double)before/RUNS, (double)idle/RUNS, (double)(idle+drains)/RUNS);
+  return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <stdlib.h>
+#include "host.h"
+#include "dhThread.c"
+#include "dh_model.h"
+
+/* Frames tokenised as they arrive
+ *
+ * Random requests, with numbers cut by the half ring drains, must get the
+ * tokens a one-shot jsmn_parse gives. A frame arriving while one of its
+ * port is queued is left to dhThread, CBOR too, and bad JSON comes through
+ * as an error.
+ */
+
+//a request with numbers of varied length so drains fall inside them
+static int request(char *f)
+{
+  int n, k, i;
+  n = sprintf(f, "{\"cmd\":\"rates/write\",\"conn\":%d,\"kWh\":%d.%03d,\"park_hr\":%d,\"parkPen_min\":-%d,\"list\":[",
+    rand()%3, rand()%100000, rand()%1000, rand()%1000000, rand()%99);
+  for (k=rand()%12, i=0; i<k; i++)
+    n += sprintf(f+n, "%s%d", i? ",": "", rand()%(1<<(rand()%30)));
+  n += sprintf(f+n, "],\"s\":\"a b,c:d}e\",\"t\":true}");
+  return n;
+}
+
+//the count and tokens of a one-shot parse
+static int sameTokens(const char *f, int n, int count, const jsmntok_t *tokens)
+{
+  jsmntok_t ref[RX_TOKENS];
+  jsmn_parser p;
+  int r;
+  jsmn_init(&p);
+  r = jsmn_parse(&p, f, n, ref, RX_TOKENS);
+  return (count == r) && !memcmp(ref, tokens, r*sizeof(jsmntok_t));
+}
+
+int main(void)
+{
+  char f[UART_BUF_SIZE], g[UART_BUF_SIZE];
+  int k, n, m, early = 0;
+  TPacket *pkt, *next;
+
+  hostInit();
+  for (k=0; k<20000; k++)
+  {
+    n = request(f);
+    hostRxFrame(&WiFiPort, f, n);
+    pkt = hostTake();
+    CHECK(pkt, "frame %d not posted", k);
+    if (!pkt)
+      break;
+    early += pkt->TokenCount > 0;
+    CHECK(sameTokens(f, n, pkt->TokenCount, WiFiPort.Tokens), "frame %d tokens differ: %.*s", k, n, f);
+    osMemoryPoolFree(RxPool, pkt);
+    WiFiPort.RxQueued--;
+  }
+  CHECK(early == k, "%d of %d tokenised on receive", early, k);
+
+  //the second frame of a port waits for the tokens, the other port's not
+  n = request(f);
+  m = request(g);
+  hostRxFrame(&WiFiPort, f, n);
+  hostRxFrame(&WiFiPort, g, m);
+  hostRxFrame(&GprsPort, g, m);
+  pkt = hostTake();
+  CHECK(pkt && (pkt->TokenCount > 0) && sameTokens(f, n, pkt->TokenCount, WiFiPort.Tokens), "first frame");
+  next = hostTake();
+  CHECK(next && (next->TokenCount == 0), "second frame tokenised over the first");
+  CHECK(sameTokens(f, n, pkt->TokenCount, WiFiPort.Tokens), "first frame tokens overwritten");
+  hostProcess(pkt);
+  pkt = hostTake();
+  CHECK(pkt && (pkt->Port == &GprsPort) && (pkt->TokenCount > 0) && sameTokens(g, m, pkt->TokenCount, GprsPort.Tokens), "other port");
+  hostProcess(pkt);
+  hostProcess(next);
+  jsmn_init(&jsparser);
+  CHECK(sameTokens(g, m, jsmn_parse(&jsparser, g, m, NULL, 0), WiFiPort.Tokens), "second frame tokens");
+  CHECK(!WiFiPort.RxQueued && !GprsPort.RxQueued, "queued %u %u", WiFiPort.RxQueued, GprsPort.RxQueued);
+
+  //CBOR is parsed by dhThread, bad JSON is an error
+  {
+    uint8_t c[8] = {0xA1, 0x61, 'a', 0x01};
+    char b[] = "{\"a\":[1,2}xxxx";
+    hostRxFrame(&WiFiPort, c, 4);
+    pkt = hostTake();
+    CHECK(pkt && (pkt->TokenCount == 0), "CBOR tokenised");
+    hostProcess(pkt);
+    hostRxFrame(&WiFiPort, b, 10);
+    pkt = hostTake();
+    CHECK(pkt && (pkt->TokenCount < 0), "bad JSON tokenised");
+    hostProcess(pkt);
+  }
+  printf("%d frames, fails %d\n", k, Fails);
+  return Fails;
+}
@@ -0,0 +1,2 @@
+#include "stm32f10x.h"
+#define CMSIS_device_header "stm32f10x.h"
@@ -0,0 +1,2 @@
+/* the firmware includes it as Trans.h, Keil on Windows does not mind the case */
+#include "trans.h"
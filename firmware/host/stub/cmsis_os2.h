@@ -0,0 +1,35 @@
+/* Host stand-in for the CMSIS-RTOS2 API
+ *
+ * Declarations only, a test defines the calls its module makes.
+ */
+
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {osOK=0, osError=-1, osErrorTimeout=-2, osErrorResource=-3, osErrorParameter=-4} osStatus_t;
+typedef enum {osPriorityNone=0, osPriorityIdle=1, osPriorityLow=8, osPriorityBelowNormal=16, osPriorityNormal=24, osPriorityAboveNormal=32, osPriorityHigh=40, osPriorityRealtime=48} osPriority_t;
+typedef enum {osTimerOnce=0, osTimerPeriodic=1} osTimerType_t;
+typedef void *osThreadId_t, *osTimerId_t, *osMutexId_t, *osMessageQueueId_t, *osMemoryPoolId_t, *osSemaphoreId_t, *osEventFlagsId_t;
+typedef void (*osThreadFunc_t)(void *);
+typedef void (*osTimerFunc_t)(void *);
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; void *stack_mem; uint32_t stack_size; osPriority_t priority; uint32_t tz_module; uint32_t reserved;} osThreadAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; void *mq_mem; uint32_t mq_size;} osMessageQueueAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; void *mp_mem; uint32_t mp_size;} osMemoryPoolAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size;} osMutexAttr_t, osTimerAttr_t, osSemaphoreAttr_t;
+#define osWaitForever 0xFFFFFFFFU
+#define osFlagsWaitAny 0
+#define osFlagsWaitAll 1
+#define osFlagsNoClear 2
+#define osFlagsError 0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+osStatus_t osKernelInitialize(void); osStatus_t osKernelStart(void); uint32_t osKernelGetTickCount(void); uint32_t osKernelGetTickFreq(void); uint32_t osKernelGetSysTimerCount(void); uint32_t osKernelGetSysTimerFreq(void);
+osThreadId_t osThreadNew(osThreadFunc_t, void *, const osThreadAttr_t *); osThreadId_t osThreadGetId(void); osStatus_t osThreadSetPriority(osThreadId_t, osPriority_t); osStatus_t osThreadYield(void);
+uint32_t osThreadFlagsSet(osThreadId_t, uint32_t); uint32_t osThreadFlagsClear(uint32_t); uint32_t osThreadFlagsGet(void); uint32_t osThreadFlagsWait(uint32_t, uint32_t, uint32_t);
+osStatus_t osDelay(uint32_t); osStatus_t osDelayUntil(uint32_t);
+osTimerId_t osTimerNew(osTimerFunc_t, osTimerType_t, void *, const osTimerAttr_t *); osStatus_t osTimerStart(osTimerId_t, uint32_t); osStatus_t osTimerStop(osTimerId_t); uint32_t osTimerIsRunning(osTimerId_t); osStatus_t osTimerDelete(osTimerId_t);
+osMutexId_t osMutexNew(const osMutexAttr_t *); osStatus_t osMutexAcquire(osMutexId_t, uint32_t); osStatus_t osMutexRelease(osMutexId_t);
+osMemoryPoolId_t osMemoryPoolNew(uint32_t, uint32_t, const osMemoryPoolAttr_t *); void *osMemoryPoolAlloc(osMemoryPoolId_t, uint32_t); osStatus_t osMemoryPoolFree(osMemoryPoolId_t, void *);
+osMessageQueueId_t osMessageQueueNew(uint32_t, uint32_t, const osMessageQueueAttr_t *); osStatus_t osMessageQueuePut(osMessageQueueId_t, const void *, uint8_t, uint32_t); osStatus_t osMessageQueueGet(osMessageQueueId_t, void *, uint8_t *, uint32_t); uint32_t osMessageQueueGetCount(osMessageQueueId_t);
+#endif
@@ -0,0 +1,135 @@
+/* StdPeriph constants the modules use, values do not matter on the host */
+
+#define ADC_AnalogWatchdog_None 0u
+#define ADC_AnalogWatchdog_SingleInjecEnable 1u
+#define ADC_Channel_10 1u
+#define ADC_Channel_11 1u
+#define ADC_Channel_12 1u
+#define ADC_Channel_7 1u
+#define ADC_DataAlign_Right 1u
+#define ADC_ExternalTrigConv_T3_TRGO 1u
+#define ADC_ExternalTrigInjecConv_T1_TRGO 1u
+#define ADC_IT_AWD 1u
+#define ADC_IT_JEOC 1u
+#define ADC_InjectedChannel_1 1u
+#define ADC_Mode_Independent 1u
+#define ADC_SampleTime_239Cycles5 1u
+#define ADC_SampleTime_28Cycles5 1u
+#define BKP_DR1 1u
+#define BKP_DR2 1u
+#define BKP_DR3 1u
+#define BKP_DR4 1u
+#define BKP_DR7 1u
+#define CoreDebug_DEMCR_TRCENA_Msk 1u
+#define DBGMCU_CR_DBG_IWDG_STOP 1u
+#define DBGMCU_CR_DBG_TIM3_STOP 1u
+#define DBGMCU_CR_DBG_TIM4_STOP 1u
+#define DMA1_IT_GL4 1u
+#define DMA1_IT_GL5 1u
+#define DMA2_IT_GL3 1u
+#define DMA2_IT_GL5 1u
+#define DMA_DIR_PeripheralDST 1u
+#define DMA_DIR_PeripheralSRC 1u
+#define DMA_IT_HT 1u
+#define DMA_IT_TC 1u
+#define DMA_M2M_Disable 1u
+#define DMA_MemoryDataSize_Byte 1u
+#define DMA_MemoryDataSize_HalfWord 1u
+#define DMA_MemoryInc_Enable 1u
+#define DMA_Mode_Circular 1u
+#define DMA_Mode_Normal 1u
+#define DMA_PeripheralDataSize_Byte 1u
+#define DMA_PeripheralDataSize_HalfWord 1u
+#define DMA_PeripheralInc_Disable 1u
+#define DMA_Priority_High 1u
+#define DMA_Priority_Medium 1u
+#define DWT_CTRL_CYCCNTENA_Msk 1u
+#define GPIO_Mode_AF_OD 1u
+#define GPIO_Mode_AF_PP 1u
+#define GPIO_Mode_AIN 1u
+#define GPIO_Mode_IN_FLOATING 1u
+#define GPIO_Mode_IPU 1u
+#define GPIO_Mode_Out_OD 1u
+#define GPIO_Mode_Out_PP 1u
+#define GPIO_Pin_0 1u
+#define GPIO_Pin_1 1u
+#define GPIO_Pin_10 1u
+#define GPIO_Pin_11 1u
+#define GPIO_Pin_12 1u
+#define GPIO_Pin_13 1u
+#define GPIO_Pin_14 1u
+#define GPIO_Pin_15 1u
+#define GPIO_Pin_2 1u
+#define GPIO_Pin_3 1u
+#define GPIO_Pin_4 1u
+#define GPIO_Pin_5 1u
+#define GPIO_Pin_6 1u
+#define GPIO_Pin_7 1u
+#define GPIO_Pin_8 1u
+#define GPIO_Pin_9 1u
+#define GPIO_Pin_All 1u
+#define GPIO_Remap_SWJ_JTAGDisable 1u
+#define GPIO_Speed_50MHz 1u
+#define I2C_Ack_Enable 1u
+#define I2C_AcknowledgedAddress_7bit 1u
+#define I2C_Direction_Receiver 1u
+#define I2C_Direction_Transmitter 1u
+#define I2C_DutyCycle_2 1u
+#define I2C_IT_BUF 1u
+#define I2C_IT_ERR 1u
+#define I2C_IT_EVT 1u
+#define I2C_Mode_I2C 1u
+#define I2C_Register_SR1 1u
+#define IWDG_Prescaler_16 1u
+#define IWDG_WriteAccess_Enable 1u
+#define RCC_AHBPeriph_DMA1 1u
+#define RCC_AHBPeriph_DMA2 1u
+#define RCC_APB1Periph_BKP 1u
+#define RCC_APB1Periph_I2C2 1u
+#define RCC_APB1Periph_PWR 1u
+#define RCC_APB1Periph_TIM2 1u
+#define RCC_APB1Periph_TIM3 1u
+#define RCC_APB1Periph_TIM4 1u
+#define RCC_APB1Periph_TIM6 1u
+#define RCC_APB1Periph_TIM7 1u
+#define RCC_APB1Periph_UART4 1u
+#define RCC_APB1Periph_USART2 1u
+#define RCC_APB2Periph_ADC1 1u
+#define RCC_APB2Periph_AFIO 1u
+#define RCC_APB2Periph_GPIOA 1u
+#define RCC_APB2Periph_GPIOB 1u
+#define RCC_APB2Periph_GPIOC 1u
+#define RCC_APB2Periph_GPIOD 1u
+#define RCC_APB2Periph_TIM1 1u
+#define RCC_APB2Periph_USART1 1u
+#define RCC_FLAG_LSIRDY 1u
+#define RCC_LSE_Bypass 1u
+#define RCC_PCLK2_Div8 1u
+#define RCC_RTCCLKSource_LSI 1u
+#define RTC_IT_SEC 1u
+#define TIM_CKD_DIV1 1u
+#define TIM_CR1_CEN 1u
+#define TIM_CounterMode_Up 1u
+#define TIM_EventSource_Update 1u
+#define TIM_FLAG_Update 1u
+#define TIM_IT_Update 1u
+#define TIM_OCMode_PWM1 1u
+#define TIM_OCPolarity_High 1u
+#define TIM_OCPreload_Enable 1u
+#define TIM_OutputNState_Disable 1u
+#define TIM_OutputState_Enable 1u
+#define TIM_TRGOSource_OC1 1u
+#define TIM_TRGOSource_Update 1u
+#define TIM_UpdateSource_Global 1u
+#define USART_DMAReq_Rx 1u
+#define USART_DMAReq_Tx 1u
+#define USART_HardwareFlowControl_None 1u
+#define USART_IT_IDLE 1u
+#define USART_IT_RXNE 1u
+#define USART_IT_TC 1u
+#define USART_IT_TXE 1u
+#define USART_Mode_Rx 1u
+#define USART_Mode_Tx 1u
+#define USART_Parity_No 1u
+#define USART_StopBits_1 1u
+#define USART_WordLength_8b 1u
@@ -0,0 +1,10 @@
+#ifndef RTX_OS_H_
+#define RTX_OS_H_
+
+#include "cmsis_os2.h"
+
+typedef struct { uint32_t x[20]; } osRtxThread_t, osRtxTimer_t, osRtxMutex_t, osRtxMessageQueue_t, osRtxMemoryPool_t;
+
+#define osRtxMemoryPoolMemSize(block_count, block_size) (4*(block_count)*(((block_size)+3)/4))
+
+#endif
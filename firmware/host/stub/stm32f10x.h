@@ -0,0 +1,124 @@
+/* Host stand-in for the StdPeriph device header
+ *
+ * Peripherals are plain memory so register accesses of the modules under
+ * test are harmless, constants only need to compile. The interrupt mask is
+ * a flag the tests may look at.
+ */
+
+#ifndef __STM32F10X_H__
+#define __STM32F10X_H__
+
+#include <stdint.h>
+typedef int32_t s32; typedef int16_t s16; typedef int8_t s8; typedef uint32_t u32; typedef uint16_t u16; typedef uint8_t u8;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrorStatus;
+typedef struct { volatile uint32_t CR, CR1, CR2, CR3, SR, SR1, SR2, DR, BRR, BSRR, BRR_, IDR, ODR, CRL, CRH, ARR, CNT, PSC, CCR1, CCR2, CCR3, CCR4, DIER, EGR, SMCR, CCMR1, CCMR2, CCER, RCR, BDTR, HTR, LTR, JDR1, JDR2, SQR1, SQR2, SQR3, JSQR, SMPR1, SMPR2, ISR, IFCR, CCR, CNDTR, CPAR, CMAR, VAL, LOAD, CTRL, CYCCNT, DEMCR, GTPR, OAR1, OAR2, CCR_, TRISE, KR, PR, RLR, PRLH, PRLL, CNTH, CNTL, ALRH, ALRL, CRH_, CRL_, DR1, DR2, DR3, DR4, DR5, DR6, DR7, DR8, DR9, DR10, RTCCR, ACR, KEYR, OBR, WRPR, AIRCR, ICSR, SCR, SHCSR, CFSR, BFAR, MMFAR, VTOR; } GEN_TypeDef;
+typedef GEN_TypeDef TIM_TypeDef, ADC_TypeDef, USART_TypeDef, DMA_TypeDef, DMA_Channel_TypeDef, GPIO_TypeDef, I2C_TypeDef, RCC_TypeDef, RTC_TypeDef, BKP_TypeDef, PWR_TypeDef, IWDG_TypeDef, SPI_TypeDef, EXTI_TypeDef, AFIO_TypeDef, FLASH_TypeDef, SCB_Type, SysTick_Type, DWT_Type, CoreDebug_Type;
+typedef struct { uint32_t ADC_Mode; FunctionalState ADC_ScanConvMode, ADC_ContinuousConvMode; uint32_t ADC_ExternalTrigConv, ADC_DataAlign; uint8_t ADC_NbrOfChannel; } ADC_InitTypeDef;
+typedef struct { uint32_t DMA_PeripheralBaseAddr, DMA_MemoryBaseAddr, DMA_DIR, DMA_BufferSize, DMA_PeripheralInc, DMA_MemoryInc, DMA_PeripheralDataSize, DMA_MemoryDataSize, DMA_Mode, DMA_Priority, DMA_M2M; } DMA_InitTypeDef;
+typedef struct { uint16_t GPIO_Pin; int GPIO_Speed; int GPIO_Mode; } GPIO_InitTypeDef;
+typedef struct { uint32_t I2C_ClockSpeed; uint16_t I2C_Mode, I2C_DutyCycle, I2C_OwnAddress1, I2C_Ack, I2C_AcknowledgedAddress; } I2C_InitTypeDef;
+typedef struct { uint8_t NVIC_IRQChannel, NVIC_IRQChannelPreemptionPriority, NVIC_IRQChannelSubPriority; FunctionalState NVIC_IRQChannelCmd; } NVIC_InitTypeDef;
+typedef struct { uint32_t USART_BaudRate; uint16_t USART_WordLength, USART_StopBits, USART_Parity, USART_Mode, USART_HardwareFlowControl; } USART_InitTypeDef;
+typedef struct { uint16_t TIM_Prescaler, TIM_CounterMode, TIM_Period, TIM_ClockDivision; uint8_t TIM_RepetitionCounter; } TIM_TimeBaseInitTypeDef;
+typedef struct { uint16_t TIM_OCMode, TIM_OutputState, TIM_OutputNState, TIM_Pulse, TIM_OCPolarity, TIM_OCNPolarity, TIM_OCIdleState, TIM_OCNIdleState; } TIM_OCInitTypeDef;
+typedef struct { uint16_t TIM_Channel, TIM_ICPolarity, TIM_ICSelection, TIM_ICPrescaler, TIM_ICFilter; } TIM_ICInitTypeDef;
+typedef enum { NonMaskableInt_IRQn=-14, SysTick_IRQn=-1, WWDG_IRQn=0, RTC_IRQn=3, DMA1_Channel1_IRQn=11, DMA1_Channel4_IRQn=14, DMA1_Channel5_IRQn=15, ADC1_2_IRQn=18, TIM1_UP_IRQn=25, TIM2_IRQn=28, TIM3_IRQn=29, TIM4_IRQn=30, I2C1_EV_IRQn=31, I2C1_ER_IRQn=32, I2C2_EV_IRQn=33, I2C2_ER_IRQn=34, USART1_IRQn=37, USART2_IRQn=38, USART3_IRQn=39, RTCAlarm_IRQn=41, UART4_IRQn=52, UART5_IRQn=53, TIM6_IRQn=54, TIM7_IRQn=55, DMA2_Channel3_IRQn=58, DMA2_Channel4_IRQn=59, DMA2_Channel5_IRQn=60 } IRQn_Type;
+#define DMA1_IT_GL1 1u
+#define DMA1_IT_TC1 2u
+#define DMA1_IT_HT1 4u
+#define __IO volatile
+#define __I volatile const
+#define __O volatile
+#define __packed
+#define __inline inline
+typedef enum { Bit_RESET = 0, Bit_SET } BitAction;
+
+__attribute__((weak)) GEN_TypeDef HostPeriph[52];
+__attribute__((weak)) int HostPrimask;
+__attribute__((weak)) uint32_t SystemCoreClock = 72000000;
+
+#define TIM1            (&HostPeriph[0])
+#define TIM2            (&HostPeriph[1])
+#define TIM3            (&HostPeriph[2])
+#define TIM4            (&HostPeriph[3])
+#define TIM5            (&HostPeriph[4])
+#define TIM6            (&HostPeriph[5])
+#define TIM7            (&HostPeriph[6])
+#define TIM8            (&HostPeriph[7])
+#define ADC1            (&HostPeriph[8])
+#define ADC2            (&HostPeriph[9])
+#define ADC3            (&HostPeriph[10])
+#define USART1          (&HostPeriph[11])
+#define USART2          (&HostPeriph[12])
+#define USART3          (&HostPeriph[13])
+#define UART4           (&HostPeriph[14])
+#define UART5           (&HostPeriph[15])
+#define DMA1            (&HostPeriph[16])
+#define DMA2            (&HostPeriph[17])
+#define DMA1_Channel1   (&HostPeriph[18])
+#define DMA1_Channel2   (&HostPeriph[19])
+#define DMA1_Channel3   (&HostPeriph[20])
+#define DMA1_Channel4   (&HostPeriph[21])
+#define DMA1_Channel5   (&HostPeriph[22])
+#define DMA1_Channel6   (&HostPeriph[23])
+#define DMA1_Channel7   (&HostPeriph[24])
+#define DMA2_Channel1   (&HostPeriph[25])
+#define DMA2_Channel2   (&HostPeriph[26])
+#define DMA2_Channel3   (&HostPeriph[27])
+#define DMA2_Channel4   (&HostPeriph[28])
+#define DMA2_Channel5   (&HostPeriph[29])
+#define GPIOA           (&HostPeriph[30])
+#define GPIOB           (&HostPeriph[31])
+#define GPIOC           (&HostPeriph[32])
+#define GPIOD           (&HostPeriph[33])
+#define GPIOE           (&HostPeriph[34])
+#define I2C1            (&HostPeriph[35])
+#define I2C2            (&HostPeriph[36])
+#define RCC             (&HostPeriph[37])
+#define RTC             (&HostPeriph[38])
+#define BKP             (&HostPeriph[39])
+#define PWR             (&HostPeriph[40])
+#define IWDG            (&HostPeriph[41])
+#define SPI1            (&HostPeriph[42])
+#define SPI2            (&HostPeriph[43])
+#define EXTI            (&HostPeriph[44])
+#define AFIO            (&HostPeriph[45])
+#define FLASH           (&HostPeriph[46])
+#define SCB             (&HostPeriph[47])
+#define SysTick         (&HostPeriph[48])
+#define DWT             (&HostPeriph[49])
+#define CoreDebug       (&HostPeriph[50])
+#define DBGMCU          (&HostPeriph[51])
+
+static inline int __disable_irq(void) { int m = HostPrimask; HostPrimask = 1; return m; }
+static inline void __enable_irq(void) { HostPrimask = 0; }
+static inline void __DMB(void) { __sync_synchronize(); }
+static inline void __DSB(void) { __sync_synchronize(); }
+static inline void __ISB(void) { }
+static inline void __NOP(void) { }
+static inline void __nop(void) { }
+static inline void __WFI(void) { }
+static inline uint32_t __get_PRIMASK(void) { return HostPrimask; }
+static inline void __set_PRIMASK(uint32_t m) { HostPrimask = m; }
+static inline uint32_t __get_IPSR(void) { return 0; }
+static inline uint32_t __REV(uint32_t v) { return __builtin_bswap32(v); }
+static inline uint32_t __CLZ(uint32_t v) { return v? __builtin_clz(v): 32; }
+#define __return_address()  ((unsigned int)(uintptr_t)__builtin_return_address(0))
+void SystemCoreClockUpdate(void);
+
+void DMA_DeInit(DMA_Channel_TypeDef *ch);
+void DMA_Init(DMA_Channel_TypeDef *ch, DMA_InitTypeDef *init);
+void DMA_ITConfig(DMA_Channel_TypeDef *ch, uint32_t it, FunctionalState state);
+void DMA_Cmd(DMA_Channel_TypeDef *ch, FunctionalState state);
+void USART_Cmd(USART_TypeDef *uart, FunctionalState state);
+void USART_DMACmd(USART_TypeDef *uart, uint16_t req, FunctionalState state);
+void USART_ITConfig(USART_TypeDef *uart, uint16_t it, FunctionalState state);
+void GPIO_WriteBit(GPIO_TypeDef *port, uint16_t pin, BitAction bit);
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef *port, uint16_t pin);
+void TIM_SelectOutputTrigger(TIM_TypeDef *tim, uint16_t source);
+
+#include "periph_const.h"
+
+#endif
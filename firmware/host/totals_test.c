@@ -0,0 +1,221 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <setjmp.h>
+#include <time.h>
+#include "host.h"
+#include "totals.c"
+
+/* Energy registers
+ *
+ * monthOf() against gmtime for every day of 2000-2099. Day and month
+ * rollover over the local time, including skipped periods and an unknown
+ * wall time. The ring over the CRC: a record write is cut at each byte,
+ * left as is or garbled, and a boot must load either the record before it
+ * or the new one, with blank slots ahead and with the ring wrapped.
+ */
+
+TI2C I2C2Port;
+static uint8_t Eep[EEP_TOTALS_ADDR+TOTALS_SLOTS*EEP_PAGE_SIZE];
+static uint32_t EnergyWh, Now;
+static int CutAt = -1, Garble; //byte of the next record write the power goes at
+static jmp_buf PowerCut;
+
+uint32_t GetEnergyTotal(void) { return EnergyWh; }
+uint32_t LocalTime_Get(void) { return Now; }
+
+int EEPRead(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  memcpy(buf, &Eep[addr], size);
+  return 1;
+}
+
+int EEPWrite(TI2C *port, uint16_t addr, void *buf, uint16_t size)
+{
+  const uint8_t *b = buf;
+  int i;
+  for (i=0; i<size; i++)
+  {
+    if (i == CutAt)
+    {
+      if (Garble)
+        Eep[addr+i] = ~b[i];
+      CutAt = -1;
+      longjmp(PowerCut, 1);
+    }
+    Eep[addr+i] = b[i];
+  }
+  return 1;
+}
+
+//power-up, the CT counter starts again from 0
+static void boot(void)
+{
+  memset(&Totals, 0xA5, sizeof(Totals));
+  Slot = 0;
+  EnergyWh = 0;
+  Totals_Init();
+}
+
+static void use(uint32_t wh)
+{
+  EnergyWh += wh;
+  Totals_Tick();
+}
+
+//local seconds at noon of a date
+static uint32_t noon(int year, int month, int mday)
+{
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_year = year-1900;
+  tm.tm_mon = month-1;
+  tm.tm_mday = mday;
+  tm.tm_hour = 12;
+  return timegm(&tm)-LOCAL_EPOCH_UNIX;
+}
+
+static void months(void)
+{
+  uint32_t day, bad = 0;
+  time_t t;
+  struct tm *tm;
+
+  for (day=0; day<36525; day++)
+  {
+    t = LOCAL_EPOCH_UNIX+(time_t)day*SECS_PER_DAY;
+    tm = gmtime(&t);
+    if (monthOf(day) != (tm->tm_year-100)*12+tm->tm_mon)
+    {
+      if (!bad++)
+        CHECK(0, "day %u is %04d-%02d, monthOf %u", day, tm->tm_year+1900, tm->tm_mon+1, monthOf(day));
+    }
+  }
+  CHECK(bad == 0, "%u days in the wrong month", bad);
+}
+
+static void rollover(void)
+{
+  TTotalsRec t;
+
+  memset(Eep, 0xFF, sizeof(Eep));
+  Now = 0;
+  boot();
+  use(50); //wall time not known yet, the energy is kept for the first period
+  Now = noon(2024, 1, 30);
+  use(70);
+  Totals_Get(&t);
+  CHECK((t.Day == Now/SECS_PER_DAY+1) && (t.Month == 24*12) && (t.DayWh == 120) && (t.MonthWh == 120) && (t.LifetimeWh == 120),
+    "first day %u %u %u %u", t.Day, t.Month, t.DayWh, t.MonthWh);
+  Now = noon(2024, 1, 31);
+  use(30);
+  Totals_Get(&t);
+  CHECK((t.PrevDayWh == 120) && (t.DayWh == 30) && (t.MonthWh == 150) && (t.PrevMonthWh == 0), "next day %u %u %u", t.PrevDayWh, t.DayWh, t.MonthWh);
+  Now = noon(2024, 2, 1);
+  use(10);
+  Totals_Get(&t);
+  CHECK((t.PrevDayWh == 30) && (t.DayWh == 10) && (t.PrevMonthWh == 150) && (t.MonthWh == 10) && (t.Month == 24*12+1),
+    "next month %u %u %u %u", t.PrevDayWh, t.DayWh, t.PrevMonthWh, t.MonthWh);
+  Now = noon(2024, 2, 29); //leap day
+  use(5);
+  Totals_Get(&t);
+  CHECK((t.PrevDayWh == 0) && (t.DayWh == 5) && (t.MonthWh == 15), "days skipped %u %u %u", t.PrevDayWh, t.DayWh, t.MonthWh);
+  Now = noon(2024, 4, 1);
+  use(5);
+  Totals_Get(&t);
+  CHECK((t.PrevDayWh == 0) && (t.PrevMonthWh == 0) && (t.MonthWh == 5) && (t.Month == 24*12+3), "month skipped %u %u", t.PrevMonthWh, t.MonthWh);
+  Now += SECS_PER_DAY/4;
+  use(5);
+  Totals_Get(&t);
+  CHECK((t.DayWh == 10) && (t.LifetimeWh == 175), "same day %u %u", t.DayWh, t.LifetimeWh);
+}
+
+//a cut anywhere in a record write loads the record before or the new one
+static void tear(const char *ring)
+{
+  uint8_t saved[sizeof(Eep)];
+  TTotalsRec before, t;
+  int cut, garble;
+
+  memcpy(saved, Eep, sizeof(Eep));
+  boot();
+  Totals_Get(&before);
+  for (cut=0; cut<=(int)sizeof(TTotalsRec); cut++)
+    for (garble=0; garble<2; garble++)
+    {
+      memcpy(Eep, saved, sizeof(Eep));
+      boot();
+      CutAt = cut<(int)sizeof(TTotalsRec)? cut: -1;
+      Garble = garble;
+      if (!setjmp(PowerCut))
+        use(TOTALS_STEP_WH);
+      CutAt = -1;
+      boot();
+      Totals_Get(&t);
+      if (cut < (int)sizeof(TTotalsRec))
+        CHECK(!memcmp(&t, &before, sizeof(t)), "%s ring, cut at byte %d%s: %u Wh seq %u", ring, cut, garble? " garbled": "", t.LifetimeWh, t.Seq);
+      else
+        CHECK((t.LifetimeWh == before.LifetimeWh+TOTALS_STEP_WH) && (t.Seq == before.Seq+1), "%s ring, full write: %u Wh", ring, t.LifetimeWh);
+      //and carries on in the next slot
+      use(TOTALS_STEP_WH);
+      boot();
+      Totals_Get(&t);
+      CHECK(t.LifetimeWh >= before.LifetimeWh+TOTALS_STEP_WH, "%s ring, cut at byte %d: no record after it, %u Wh", ring, cut, t.LifetimeWh);
+    }
+  memcpy(Eep, saved, sizeof(Eep));
+  boot();
+}
+
+static void ring(void)
+{
+  TTotalsRec t;
+  int i;
+
+  memset(Eep, 0xFF, sizeof(Eep));
+  Now = noon(2030, 6, 15);
+  boot();
+  use(TOTALS_STEP_WH-1);
+  boot();
+  Totals_Get(&t);
+  CHECK((t.Seq == 0) && (t.LifetimeWh == 0), "written below a step, %u", t.LifetimeWh);
+  boot();
+  use(TOTALS_STEP_WH);
+  use(TOTALS_STEP_WH);
+  tear("blank");
+  for (i=0; i<TOTALS_SLOTS+5; i++)
+    use(TOTALS_STEP_WH+7);
+  boot();
+  Totals_Get(&t);
+  CHECK((t.Seq == TOTALS_SLOTS+7) && (t.LifetimeWh/TOTALS_STEP_WH == (2+TOTALS_SLOTS+5)*(TOTALS_STEP_WH+7)/TOTALS_STEP_WH),
+    "wrapped ring seq %u, %u Wh", t.Seq, t.LifetimeWh);
+  tear("wrapped");
+}
+
+int main(void)
+{
+  months();
+  rollover();
+  ring();
+  printf("fails %d\n", Fails);
+  return Fails;
+}
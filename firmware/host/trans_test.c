@@ -0,0 +1,168 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "host.h"
+#include "hal.h"
+#include "app_main.h"
+#include "trace.h"
+#include "ledger.h"
+
+/* Caps and credit turned into an energy stop
+ *
+ * A session is charged at a tariff rate with one bill tick per reading.
+ * Each case checks the meter reading the CT thread is told to stop at
+ * and when Trans_IsCreditOut ends the session: an energy cap, a cost cap
+ * at the rate, a card's credit, a zero rate and a zero deposit.
+ */
+
+TConfig Config;
+static TMilli Rate; //milli-currency per kWh
+
+void Trace_Record(TTraceEvent e, uint8_t arg) {}
+TMilli Tariff_GetRate(uint8_t *cls) { *cls = 1; return Rate; }
+int Ledger_Push(TLedgerRec *rec) { return 1; }
+uint32_t LocalTime_Get(void) { return 0; }
+int IsHardwareOkay(void) { return 1; }
+void CountUpTimerReset(void) {}
+void CountUpTimerStart(void) {}
+void CountUpTimerStop(void) {}
+void DlyTimerSet(uint32_t seconds) {}
+void ResetPowerVar(void) {}
+void Taper_Reset(void) {}
+
+#include "trans.c"
+
+//a network session from idle to charging
+static void start(TMilli deposit, uint32_t capWh, TMilli capAmount)
+{
+  setState(0, trIdle);
+  Trans_SetState(0, trHandshake, 0);
+  Trans_SetState(0, trAuthen, 0);
+  Trans_Authen(0, deposit, 0, capWh, capAmount);
+  Trans_SetState(0, trAuthen, 0);
+  CHECK(Trans_GetState(0) == trCharging, "not charging");
+}
+
+//a card session from idle to charging
+static void startCard(TMilli credit, int isFree)
+{
+  TCard card;
+  memset(&card, 0, sizeof(card));
+  memset(card.Serial, 0x11, sizeof(card.Serial));
+  card.As.ChargeCard.Credit = credit;
+  card.As.ChargeCard.IsFreeCard = isFree;
+  setState(0, trIdle);
+  Trans_SetState(0, trHandshake, 0);
+  Trans_SetState(0, trAuthen, 0);
+  Trans_AuthenRFIDCard(0, &card);
+  Trans_SetState(0, trAuthen, 0);
+  CHECK(Trans_GetState(0) == trCharging, "card not charging");
+}
+
+static void tick(uint32_t wh)
+{
+  static uint32_t sec;
+  Trans_BillTick(0, ++sec, wh);
+}
+
+//stop reading and credit out after a tick at wh
+static void expect(const char *what, uint32_t wh, uint32_t stopWh, int out)
+{
+  tick(wh);
+  CHECK(Trans_GetEnergyStop(0) == stopWh, "%s at %u Wh: stop %u, not %u", what, wh, Trans_GetEnergyStop(0), stopWh);
+  CHECK(Trans_IsCreditOut(0) == out, "%s at %u Wh: credit out %d", what, wh, !out);
+}
+
+int main(void)
+{
+  int g;
+
+  for (g=0; g<POLICY_GROUPS; g++)
+  {
+    Config.Public.Policy.Group[g].EnergyPct = 100;
+    Config.Public.Policy.Group[g].ParkingPct = 100;
+  }
+
+  //energy cap below what the deposit buys
+  Rate = 500;
+  start(100000, 5000, 0);
+  expect("energy cap", 1000, 5000, 0);
+  expect("energy cap", 4999, 5000, 0);
+  expect("energy cap", 5000, 5000, 1);
+
+  //cost cap under the deposit, at the rate in force: 10.000 at 2.000/kWh
+  Rate = 2000;
+  start(100000, 0, 10000);
+  expect("cost cap", 1000, 5000, 0);
+  expect("cost cap", 4000, 5000, 0);
+  expect("cost cap", 5000, 5000, 1);
+
+  //the rate goes up halfway, the stop comes nearer
+  start(100000, 0, 10000);
+  expect("rate step", 2000, 5000, 0);
+  Rate = 4000;
+  expect("rate step", 2000, 3500, 0); //6.000 left at 4.000/kWh
+  expect("rate step", 3500, 3500, 1);
+
+  //the lower of an energy cap and a cost cap
+  Rate = 1000;
+  start(100000, 3000, 10000);
+  expect("both caps", 0, 3000, 0);
+
+  //a card's credit, a cost cap does not apply to it
+  Rate = 1500;
+  startCard(3000, 0);
+  expect("card credit", 0, 2000, 0);
+  expect("card credit", 1998, 2000, 0);
+  expect("card credit", 1999, 1999, 1); //the fee rounds up to the credit
+  expect("card credit", 2000, 2000, 1);
+  startCard(3000, 1);
+  expect("free card", 100000, ENERGY_NO_STOP, 0);
+
+  //a zero rate never runs out, only a cap stops it
+  Rate = 0;
+  start(5000, 0, 0);
+  expect("zero rate", 0, ENERGY_NO_STOP, 0);
+  expect("zero rate", 1000000, ENERGY_NO_STOP, 0);
+  start(5000, 3000, 0);
+  expect("zero rate, energy cap", 0, 3000, 0);
+  expect("zero rate, energy cap", 3000, 3000, 1);
+
+  //a zero deposit stops at once, whatever the rate
+  Rate = 1000;
+  start(0, 0, 0);
+  expect("zero deposit", 0, 0, 1);
+  Rate = 0;
+  start(0, 0, 0);
+  expect("zero deposit, zero rate", 0, 0, 1);
+
+  //open and free has no limit
+  Rate = 1000;
+  Config.Private.OpMode.OpenAndFree = 1;
+  start(0, 0, 0);
+  expect("open and free", 50000, ENERGY_NO_STOP, 0);
+  Config.Private.OpMode.OpenAndFree = 0;
+
+  printf("fails %d\n", Fails);
+  return Fails;
+}
@@ -1,45 +1,52 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#ifndef __CT_THREAD_H__
-#define __CT_THREAD_H__
-
-#include "cmsis_os2.h"
-
-#define CT_HALF_TRANS        0x01
-#define CT_TRANS_COMP        0x02
-#define CT_UPD_VARS          0x04
-
-extern const osThreadAttr_t CTThread_attr;
-
-void UpdateVoltLN(void);
-void GetPowerVar(float *CurrentA, float *EnergykWh);
-float GetChargingCurrents(float phases[3]);
-void ResetChargingCounter(void);
-int IsDrawingCurrent(float current);
-void ResetPowerVar(void);
-void CTThread(void *arg);
-
-#endif
-
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __CT_THREAD_H__
+#define __CT_THREAD_H__
+
+#include "cmsis_os2.h"
+#include "stm32f10x.h"
+
+#define CT_HALF_TRANS        0x01
+#define CT_TRANS_COMP        0x02
+#define CT_UPD_VARS          0x04
+
+#define ENERGY_NO_STOP       0xffffffff
+
+extern const osThreadAttr_t CTThread_attr;
+extern __IO uint16_t PhaseDeciAmps[3];
+
+void UpdateVoltLN(void);
+void GetPowerVar(float *CurrentA, uint32_t *EnergyWh);
+float GetChargingCurrents(float phases[3]);
+void ResetChargingCounter(void);
+int IsDrawingCurrent(float current);
+void ResetPowerVar(void);
+uint32_t GetEnergyTotal(void);
+void SetEnergyStop(uint32_t wh);
+int IsEnergyStopped(void);
+void CTThread(void *arg);
+
+#endif
+
@@ -0,0 +1,373 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include <string.h>
+#include "stm32f10x.h"
+#include "hal.h"
+#include "capacity.h"
+#include "trace.h"
+
+static TCapBooking Booking;
+static uint16_t Demand[CONNECTORS]; /* A */
+
+#ifdef COORDINATOR_EMULATION
+static void Coord_Request(uint16_t seq, uint16_t amps);
+static void Coord_Tick(void);
+#endif
+
+static void newRequest(TCapBookingState state)
+{
+  if (++Booking.Seq==0) //seq 0 is reserved for coordinator renegotiation
+    Booking.Seq = 1;
+  Booking.State = state;
+  Booking.ReplyWait = 0;
+  Booking.Pending = 1;
+}
+
+//books the sum of the connector demands, lowering takes effect at once
+static void book(uint16_t amps)
+{
+  if ((Booking.State==cbIdle)||(Booking.State==cbReleasing)||(Booking.Requested!=amps))
+  {
+    Booking.Requested = amps;
+    if (Booking.Granted > amps)
+      Booking.Granted = amps;
+    newRequest(cbReserving);
+  }
+}
+
+//water-fills the lease over the connectors, dropping the last ones if the
+//share falls below CHARGE_CURRENT_MIN
+static uint16_t share(uint8_t conn)
+{
+  uint8_t active[CONNECTORS];
+  uint16_t left = Booking.Granted, each;
+  int i, n, last, satisfied;
+
+  for (i=0; i<CONNECTORS; i++)
+    active[i] = Demand[i]>0;
+  while(1)
+  {
+    for (i=n=last=0; i<CONNECTORS; i++)
+      if (active[i])
+      {
+        n++;
+        last = i;
+      }
+    if (n==0)
+      return 0;
+    each = left/n;
+    if (each < CHARGE_CURRENT_MIN)
+    {
+      if (last==conn)
+        return 0;
+      active[last] = 0;
+      continue;
+    }
+    satisfied = 0;
+    for (i=0; i<CONNECTORS; i++)
+      if (active[i] && (Demand[i] <= each))
+      {
+        if (i==conn)
+          return Demand[i];
+        left -= Demand[i];
+        active[i] = 0;
+        satisfied = 1;
+      }
+    if (!satisfied)
+      return each;
+  }
+}
+
+//non-blocking, returns the connector's share of the amps currently leased
+uint16_t Capacity_Reserve(uint8_t conn, uint16_t amps)
+{
+  uint16_t total;
+  int i;
+  MASK_IRQ
+    Demand[conn] = amps;
+    for (i=0, total=0; i<CONNECTORS; i++)
+      total += Demand[i];
+    book(total);
+    uint16_t ret = share(conn);
+  UNMASK_IRQ
+  return ret;
+}
+
+//the booking is released with the last connector
+void Capacity_Release(uint8_t conn)
+{
+  uint16_t total;
+  int i;
+  MASK_IRQ
+    Demand[conn] = 0;
+    for (i=0, total=0; i<CONNECTORS; i++)
+      total += Demand[i];
+    if (total)
+      book(total);
+    else if ((Booking.State!=cbIdle)&&(Booking.State!=cbReleasing))
+    {
+      Booking.Requested = Booking.Granted = 0;
+      Booking.LeaseLeft = 0;
+      newRequest(cbReleasing);
+    }
+  UNMASK_IRQ
+}
+
+//called every second
+void Capacity_Tick(void)
+{
+  MASK_IRQ
+    if ((Booking.LeaseLeft>0) && (--Booking.LeaseLeft==0))
+      Booking.Granted = 0; //lease lapsed, stop drawing until granted again
+    switch(Booking.State)
+    {
+      case cbGranted:
+        if (Booking.LeaseLeft <= Booking.LeaseSec/2) //renew
+          newRequest(cbReserving);
+        break;
+      case cbReserving:
+        if (!Booking.Pending && (++Booking.ReplyWait>=CAP_REPLY_TIMEOUT_SEC)) //no reply, send again
+        {
+          Booking.ReplyWait = 0;
+          Booking.Pending = 1;
+        }
+        break;
+      default:
+        break;
+    }
+  UNMASK_IRQ
+#ifdef COORDINATOR_EMULATION
+  TCapMsg msg;
+  if (Capacity_PeekPending(&msg))
+  {
+    Capacity_Sent(msg.Seq);
+    Coord_Request(msg.Seq, msg.Amps);
+  }
+  Coord_Tick();
+#endif
+}
+
+//seq 0: renegotiation initiated by coordinator
+int Capacity_Grant(uint16_t seq, uint16_t amps, uint16_t leaseSec)
+{
+  int ret = 0;
+  MASK_IRQ
+    if ((Booking.State==cbReserving)||(Booking.State==cbGranted))
+    {
+      if (seq==Booking.Seq)
+      {
+        Booking.State = cbGranted;
+        Booking.Pending = 0;
+        ret = 1;
+      }
+      else if (seq==0)
+        ret = 1;
+      if (ret)
+      {
+        Booking.Granted = amps>Booking.Requested? Booking.Requested: amps;
+        Trace_Record(teGrant, Booking.Granted);
+        Booking.LeaseSec = Booking.LeaseLeft = leaseSec? leaseSec: CAP_LEASE_SEC;
+      }
+    }
+  UNMASK_IRQ
+  return ret;
+}
+
+int Capacity_PeekPending(TCapMsg *msg)
+{
+  MASK_IRQ
+    int ret = Booking.Pending;
+    msg->Seq = Booking.Seq;
+    msg->Amps = Booking.State==cbReleasing? 0: Booking.Requested;
+  UNMASK_IRQ
+  return ret;
+}
+
+void Capacity_Sent(uint16_t seq)
+{
+  MASK_IRQ
+    if (seq==Booking.Seq)
+    {
+      Booking.Pending = 0;
+      if (Booking.State==cbReleasing)
+        Booking.State = cbIdle;
+    }
+  UNMASK_IRQ
+}
+
+void Capacity_GetBooking(TCapBooking *booking)
+{
+  MASK_IRQ
+    memcpy(booking, &Booking, sizeof(Booking));
+  UNMASK_IRQ
+}
+
+#ifdef COORDINATOR_EMULATION
+/* Site coordinator stand-in
+ *
+ * Slot 0 is this charger, the others are virtual chargers whose demand is set 
+ * by "coordinator/write". Amps are water-filled under the site limit, dropping 
+ * the last chargers if the share falls below CHARGE_CURRENT_MIN. A lowered 
+ * grant stays committed for COORD_SETTLE_SEC since the EV may take up to 5s 
+ * to follow the new duty, so the breaker never sees the sum of old and new.
+ */
+#define COORD_CHARGERS              4
+#define COORD_SITE_LIMIT           32 /* A */
+#define COORD_SETTLE_SEC            6
+#define COORD_LEASE_SEC            30
+
+typedef struct
+{
+  uint16_t Demand, Alloc, Hold;
+  uint16_t Seq;                 /* request to answer */
+  uint8_t HoldSec, LeaseLeft;
+} TCoordSlot;
+
+static TCoordSlot Slots[COORD_CHARGERS];
+static uint16_t SiteLimit = COORD_SITE_LIMIT;
+
+void Coordinator_SetSiteLimit(uint16_t amps)
+{
+  MASK_IRQ
+    SiteLimit = amps;
+  UNMASK_IRQ
+}
+
+int Coordinator_SetDemand(int id, uint16_t amps)
+{
+  if ((id<1)||(id>=COORD_CHARGERS)) //slot 0 is booked by this charger only
+    return 0;
+  MASK_IRQ
+    Slots[id].Demand = amps;
+  UNMASK_IRQ
+  return 1;
+}
+
+static void Coord_Request(uint16_t seq, uint16_t amps)
+{
+  Slots[0].Demand = amps;
+  Slots[0].Seq = amps? seq: 0; //release is not answered
+  Slots[0].LeaseLeft = COORD_LEASE_SEC;
+}
+
+static void coordAllocate(uint16_t *target)
+{
+  uint8_t active[COORD_CHARGERS];
+  uint16_t left = SiteLimit;
+  int i, n, last, satisfied;
+
+  for (i=0; i<COORD_CHARGERS; i++)
+  {
+    target[i] = 0;
+    active[i] = (Slots[i].Demand>0) && ((i>0)||(Slots[i].LeaseLeft>0));
+  }
+  while(1)
+  {
+    for (i=n=last=0; i<COORD_CHARGERS; i++)
+      if (active[i])
+      {
+        n++;
+        last = i;
+      }
+    if (n==0)
+      break;
+    if (left/n < CHARGE_CURRENT_MIN) //not enough to go around, drop the last one
+    {
+      active[last] = 0;
+      continue;
+    }
+    satisfied = 0;
+    for (i=0; i<COORD_CHARGERS; i++)
+      if (active[i] && (Slots[i].Demand <= left/n))
+      {
+        target[i] = Slots[i].Demand;
+        active[i] = 0;
+        satisfied = 1;
+      }
+    if (!satisfied)
+    {
+      for (i=0; i<COORD_CHARGERS; i++)
+        if (active[i])
+          target[i] = left/n;
+      break;
+    }
+    for (i=0, left=SiteLimit; i<COORD_CHARGERS; i++)
+      left -= target[i];
+  }
+}
+
+static uint16_t committed(TCoordSlot *slot)
+{
+  uint16_t hold = slot->HoldSec? slot->Hold: 0;
+  return slot->Alloc>hold? slot->Alloc: hold;
+}
+
+static void Coord_Tick(void)
+{
+  uint16_t target[COORD_CHARGERS], prev0, used, base;
+  int i;
+
+  MASK_IRQ
+    for (i=0; i<COORD_CHARGERS; i++)
+    {
+      if (Slots[i].HoldSec)
+        Slots[i].HoldSec--;
+      if ((i==0) && Slots[i].LeaseLeft && (--Slots[i].LeaseLeft==0))
+        Slots[i].Demand = 0;
+    }
+    prev0 = Slots[0].Alloc;
+    coordAllocate(target);
+    //decrease first, holding the old level until the EV has followed
+    for (i=0, used=0; i<COORD_CHARGERS; i++)
+    {
+      if (target[i] < Slots[i].Alloc)
+      {
+        Slots[i].Hold = committed(&Slots[i]);
+        Slots[i].HoldSec = COORD_SETTLE_SEC;
+        Slots[i].Alloc = target[i];
+      }
+      used += committed(&Slots[i]);
+    }
+    //then increase where the committed total allows
+    for (i=0; i<COORD_CHARGERS; i++)
+      if (target[i] > Slots[i].Alloc)
+      {
+        base = committed(&Slots[i]);
+        if (target[i] <= base)
+          Slots[i].Alloc = target[i];
+        else if (used+target[i]-base <= SiteLimit)
+        {
+          used += target[i]-base;
+          Slots[i].Alloc = target[i];
+        }
+      }
+    uint16_t seq = Slots[0].Seq;
+    uint16_t alloc = Slots[0].Alloc;
+    Slots[0].Seq = 0;
+  UNMASK_IRQ
+  if (seq || (alloc!=prev0))
+    Capacity_Grant(seq, alloc, COORD_LEASE_SEC);
+}
+#endif
@@ -0,0 +1,75 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __CAPACITY_H__
+#define __CAPACITY_H__
+
+#include <stdint.h>
+
+/* Capacity booking with the site coordinator
+ *
+ * charger -> coordinator: capacity/reserve {seq, amps}, capacity/release {seq}
+ * coordinator -> charger: capacity/grant {seq, amps, lease_s}
+ *
+ * A reserve is re-sent to renew the lease or to renegotiate the amps. A grant
+ * with seq 0 is a renegotiation pushed by the coordinator. The charger drops
+ * to 0A if the lease runs out, so a lost link never overloads the feeder.
+ * One booking covers all connectors: it asks for the sum of their demands
+ * and the lease is shared out between them.
+ */
+#define CAP_LEASE_SEC               60
+#define CAP_REPLY_TIMEOUT_SEC       3
+
+typedef enum {cbIdle, cbReserving, cbGranted, cbReleasing} TCapBookingState;
+
+typedef struct
+{
+  TCapBookingState State;
+  uint16_t Requested;           /* A */
+  uint16_t Granted;             /* A */
+  uint16_t LeaseSec, LeaseLeft;
+  uint16_t ReplyWait;
+  uint16_t Seq;
+  uint8_t Pending;              /* message waiting to be sent */
+} TCapBooking;
+
+typedef struct
+{
+  uint16_t Seq;
+  uint16_t Amps;                /* 0: release */
+} TCapMsg;
+
+uint16_t Capacity_Reserve(uint8_t conn, uint16_t amps);
+void Capacity_Release(uint8_t conn);
+void Capacity_Tick(void);
+int Capacity_Grant(uint16_t seq, uint16_t amps, uint16_t leaseSec);
+int Capacity_PeekPending(TCapMsg *msg);
+void Capacity_Sent(uint16_t seq);
+void Capacity_GetBooking(TCapBooking *booking);
+#ifdef COORDINATOR_EMULATION
+void Coordinator_SetSiteLimit(uint16_t amps);
+int Coordinator_SetDemand(int id, uint16_t amps);
+#endif
+
+#endif
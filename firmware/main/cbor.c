@@ -0,0 +1,314 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <string.h>
+#include <math.h>
+#include "cbor.h"
+
+/* CBOR requests
+ *
+ * A CBOR request is turned into the JSON text it stands for, together with
+ * the tokens jsmn would have made of that text, in a single pass. Handlers
+ * then see a JSON request whatever the client sent and share one command
+ * table. Integers, decimal fractions (tag 4) and floats become number text,
+ * floats rounded to 4 decimals. Byte strings, other tags and text needing
+ * escapes are refused.
+ */
+
+#define CBOR_MAX_DEPTH      4
+
+typedef struct
+{
+  const uint8_t *In, *End;
+  char *Text;
+  int Len, Size;
+  jsmntok_t *Tokens;
+  unsigned int Count, Max;
+  int Err;
+} TCborIn;
+
+static void text(TCborIn *c, const char *s, int n)
+{
+  if (c->Len+n >= c->Size)
+  {
+    c->Err = JSMN_ERROR_NOMEM;
+    return;
+  }
+  memcpy(&c->Text[c->Len], s, n);
+  c->Len += n;
+}
+
+static jsmntok_t* token(TCborIn *c, jsmntype_t type)
+{
+  jsmntok_t *tok;
+  if (c->Count >= c->Max)
+  {
+    c->Err = JSMN_ERROR_NOMEM;
+    return NULL;
+  }
+  tok = &c->Tokens[c->Count++];
+  tok->type = type;
+  tok->start = tok->end = c->Len;
+  tok->size = 0;
+  return tok;
+}
+
+//initial byte and its argument, *indef for the 0x1F length
+static int readHead(TCborIn *c, uint8_t *major, uint32_t *v, int *indef)
+{
+  uint8_t info, n, i;
+  if (c->In >= c->End)
+    return 0;
+  *major = *c->In>>5;
+  info = *c->In++ & 0x1F;
+  *indef = info==31;
+  if ((info < 24) || *indef)
+  {
+    *v = info;
+    return 1;
+  }
+  if (info > 26) //64 bit arguments, doubles are read by item()
+    return 0;
+  n = 1<<(info-24);
+  if (n > c->End-c->In)
+    return 0;
+  for (*v=0, i=0; i<n; i++)
+    *v = *v<<8 | *c->In++;
+  return 1;
+}
+
+//a whole number, or v/10^decimals
+static void number(TCborIn *c, uint32_t mag, int neg, uint8_t decimals)
+{
+  char s[16], *p = &s[sizeof(s)];
+  jsmntok_t *tok = token(c, JSMN_PRIMITIVE);
+  do
+  {
+    *--p = '0' + mag%10;
+    mag /= 10;
+    if (decimals && (--decimals == 0))
+    {
+      *--p = '.';
+      if (mag == 0)
+        *--p = '0';
+    }
+  } while (mag || decimals);
+  if (neg)
+    *--p = '-';
+  text(c, p, &s[sizeof(s)]-p);
+  if (tok)
+    tok->end = c->Len;
+}
+
+static void real(TCborIn *c, double v)
+{
+  if (!((v < 214748.0) && (v > -214748.0))) //past a 32 bit mantissa at 4 decimals, or NaN
+  {
+    c->Err = JSMN_ERROR_INVAL;
+    return;
+  }
+  v *= 10000;
+  number(c, (uint32_t)((v<0? -v: v)+0.5), v<=-0.5, 4);
+}
+
+static double half(uint16_t h)
+{
+  int e = (h>>10)&0x1F;
+  double m = h&0x3FF;
+  double v = e? ldexp(m+1024, e-25): ldexp(m, -24);
+  return h&0x8000? -v: v;
+}
+
+static void item(TCborIn *c, int depth);
+
+static void container(TCborIn *c, jsmntype_t type, uint32_t n, int indef, int depth)
+{
+  jsmntok_t *tok;
+  int tokIdx, key, i;
+  if ((depth >= CBOR_MAX_DEPTH) || (!indef && (n > (uint32_t)(c->End-c->In)))) //every entry takes a byte at least
+  {
+    c->Err = JSMN_ERROR_INVAL;
+    return;
+  }
+  tokIdx = c->Count;
+  tok = token(c, type);
+  text(c, type==JSMN_OBJECT? "{": "[", 1);
+  for (i=0; !c->Err && (indef || (i<n)); i++)
+  {
+    if (indef && (c->In<c->End) && (*c->In==0xFF))
+    {
+      c->In++;
+      break;
+    }
+    if (i)
+      text(c, ",", 1);
+    if (type==JSMN_OBJECT)
+    {
+      if ((c->In>=c->End) || ((*c->In>>5) != 3)) //keys are text
+      {
+        c->Err = JSMN_ERROR_INVAL;
+        return;
+      }
+      key = c->Count;
+      item(c, depth+1);
+      if (!c->Err)
+        c->Tokens[key].size = 1; //as jsmn, a key holds its value
+      text(c, ":", 1);
+    }
+    item(c, depth+1);
+  }
+  text(c, type==JSMN_OBJECT? "}": "]", 1);
+  if (tok)
+  {
+    tok = &c->Tokens[tokIdx];
+    tok->size = i;
+    tok->end = c->Len;
+  }
+}
+
+static void item(TCborIn *c, int depth)
+{
+  uint8_t major, info;
+  uint32_t v, lo, hi;
+  int indef, i;
+  jsmntok_t *tok;
+
+  if (c->Err)
+    return;
+  if (c->In >= c->End)
+  {
+    c->Err = JSMN_ERROR_PART;
+    return;
+  }
+  info = *c->In&0x1F;
+  if (((*c->In>>5)==7) && (info==27)) //double, read here whole
+  {
+    uint64_t bits = 0;
+    double d;
+    if (c->End-c->In < 9)
+    {
+      c->Err = JSMN_ERROR_PART;
+      return;
+    }
+    for (c->In++, i=0; i<8; i++)
+      bits = bits<<8 | *c->In++;
+    memcpy(&d, &bits, sizeof(d));
+    real(c, d);
+    return;
+  }
+  if (!readHead(c, &major, &v, &indef))
+  {
+    c->Err = JSMN_ERROR_PART;
+    return;
+  }
+  switch (major)
+  {
+    case 0:
+    case 1:
+      if (indef)
+        break;
+      if ((major==1) && (v==0xFFFFFFFF))
+        break;
+      number(c, major? v+1: v, major, 0);
+      return;
+    case 3:
+      if (indef || (v > (uint32_t)(c->End-c->In))) //wire length, never added to a pointer
+        break;
+      for (i=0; i<v; i++)
+        if ((c->In[i]=='"') || (c->In[i]=='\\') || (c->In[i]<0x20))
+          break;
+      if (i<v)
+        break;
+      text(c, "\"", 1);
+      tok = token(c, JSMN_STRING);
+      text(c, (const char*)c->In, v);
+      if (tok)
+        tok->end = c->Len;
+      text(c, "\"", 1);
+      c->In += v;
+      return;
+    case 4:
+    case 5:
+      container(c, major==5? JSMN_OBJECT: JSMN_ARRAY, v, indef, depth);
+      return;
+    case 6: //decimal fraction [-decimals, mantissa]
+      if ((v != 4) || (c->End-c->In < 3) || (c->In[0] != 0x82) || (c->In[1] < 0x20) || (c->In[1] > 0x28))
+        break;
+      lo = c->In[1]-0x20+1;
+      c->In += 2;
+      if (!readHead(c, &major, &hi, &indef) || (major > 1) || indef || ((major==1) && (hi==0xFFFFFFFF)))
+        break;
+      number(c, major? hi+1: hi, major, lo);
+      return;
+    case 7:
+      if (v==20 || v==21 || v==22)
+      {
+        tok = token(c, JSMN_PRIMITIVE);
+        text(c, v==20? "false": v==21? "true": "null", v==20? 5: 4);
+        if (tok)
+          tok->end = c->Len;
+        return;
+      }
+      if (info==25)
+      {
+        real(c, half(v));
+        return;
+      }
+      if (info==26)
+      {
+        float f;
+        memcpy(&f, &v, sizeof(f));
+        real(c, f);
+        return;
+      }
+      break;
+  }
+  c->Err = JSMN_ERROR_INVAL;
+}
+
+//the JSON text of one CBOR object and its tokens, the token count or a JSMN_ERROR_xxx
+int Cbor_ToJson(const uint8_t *in, int len, char *text, int size, jsmntok_t *tokens, unsigned int numTokens)
+{
+  TCborIn c;
+  c.In = in;
+  c.End = in+len;
+  c.Text = text;
+  c.Len = 0;
+  c.Size = size;
+  c.Tokens = tokens;
+  c.Count = 0;
+  c.Max = numTokens;
+  c.Err = 0;
+  if ((len < 1) || !CBOR_IS_MAP(*in))
+    return JSMN_ERROR_INVAL;
+  item(&c, 0);
+  if (!c.Err && (c.In != c.End))
+    c.Err = JSMN_ERROR_INVAL;
+  if (c.Err)
+    return c.Err;
+  text[c.Len] = 0;
+  return c.Count;
+}
@@ -88,14 +88,18 @@ const uint32_t crc32_tab[] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-uint32_t crc32(const void *buf, uint16_t size)
+uint32_t crc32_add(uint32_t crc, const void *buf, uint16_t size)
 {
-	uint32_t crc = 0xFFFFFFFF;
 	const uint8_t *p = buf;
 	while (size--)
 		crc = crc32_tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
 
-	return ~crc;
+	return crc;
+}
+
+uint32_t crc32(const void *buf, uint16_t size)
+{
+	return ~crc32_add(CRC32_INIT, buf, size);
 }
 
 
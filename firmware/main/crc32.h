@@ -42,6 +42,19 @@
  *	\return 			Calculated CRC32 value.
  */
 uint32_t crc32(const void *buf, uint16_t size);
+
+#define CRC32_INIT		0xFFFFFFFF
+
+/**
+ *	\brief				Add data to a running CRC32, crc32() of all of it is
+ *						the complement of the result.
+ *	\param[in]	crc		CRC32_INIT to start, else the last result.
+ *	\param[in]	buf		Point to data.
+ *	\param[in]	size	Data size in bytes.
+ *	\return 			The running CRC32.
+ */
+uint32_t crc32_add(uint32_t crc, const void *buf, uint16_t size);
+
 int ValidateCrc32Blk(void *src, uint16_t size);
 void CalcCrc32Blk(void *src, uint16_t size);
 #endif /* _CRC32_H_ */
@@ -1,501 +1,1767 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include <stdio.h>
-#include <math.h>
-#include "stm32f10x.h"
-#include "cmsis_os2.h"
-#include "rtx_os.h"
-#include "hal.h"
-#include "stm32f10x_it.h"
-#include "dhThread.h"
-#include "app_main.h"
-#include "mem.h"
-#include "PilotThread.h"
-#include "crc32.h"
-#include  "RFID_Card.h"
-#include "jsmn.h"
-#include "trans.h"
-#include "CT_Thread.h"
-#include "app_main.h"
-
-osRtxThread_t dhThread_tcb;
-uint64_t dhThreadStk[128];
-const osThreadAttr_t dhThread_attr = { 
-  .cb_mem = &dhThread_tcb,
-  .cb_size = sizeof(dhThread_tcb),
-  .stack_mem = dhThreadStk,  
-  .stack_size = sizeof(dhThreadStk), 
-  .priority = osPriorityHigh,
-};
-
-TSPort WiFiPort = {.Uart=WIFI_UART};
-TSPort GprsPort = {.Uart=GPRS_UART};
-osMessageQueueId_t SPortMsgQ;
-
-const char resultJsonStr[] = "{\"action\":\"%s\",\"devId\":\"%s\",\"result\":%d}";
-jsmntok_t tokens[80];
-jsmn_parser jsparser;
-char tokbuf[61];
-
-typedef int(*TAction)(TSPort *port, const char *json, int tokenCount);
-typedef struct
-{
-  const char *command;
-  TAction action;
-} TCommand;
-  
-int SendStr(TSPort *port, const char *s)
-{
-  if (port->TxSize==0) //is idle?
-  {
-    int len = strlen(s);
-    if (len > PKT_PLAYLOAD_SIZE)
-      return 0;    
-    port->TxSize= len+4;
-    port->TxPos = 0;
-    memcpy(port->TxBuffer, s, len);
-    CalcCrc32Blk(port->TxBuffer, port->TxSize);
-    USART_ITConfig(port->Uart, USART_IT_TXE, ENABLE);      
-    return 1;
-  }
-  return 0;
-}
-
-static int Send(TSPort *port, int size)
-{
-  if (size > PKT_PLAYLOAD_SIZE)
-    return 0;
-  while (port->TxSize!=0) //wait until idle
-  {
-    osDelay(2); 
-  }
-  port->TxSize= size+4;
-  port->TxPos = 0;
-  CalcCrc32Blk(port->TxBuffer, port->TxSize);
-  USART_ITConfig(port->Uart, USART_IT_TXE, ENABLE);      
-  return 1;
-}
-
-static int jsoneq(const char *json, jsmntok_t *tok, const char *s) {
-	if (tok->type == JSMN_STRING && (int) strlen(s) == tok->end - tok->start &&
-			strncmp(json + tok->start, s, tok->end - tok->start) == 0) {
-		return 0;
-	}
-	return -1;
-}
-
-static void tokencpy(char *buf, int bufSize, const char *jsStr, jsmntok_t *tok)
-{
-  int len = tok->end-tok->start;
-  if (len>=bufSize)
-    len = sizeof(bufSize)-1;
-  memcpy(buf, &jsStr[tok->start], len);
-  buf[len] = 0;
-}
-
-int wifiRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"wifi/read\",\"wifiMode\":%d,\"ssid\":\"%s\",\"wpa2\":\"%s\"}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr,
-    Config.Public.WifiConfig.Mode,
-    Config.Public.WifiConfig.SsidStr,
-    Config.Public.WifiConfig.Wpa2KeyStr
-  );
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int configRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"config/read\",\"devId\":\"%s\","
-    "\"label\":\"%s\",\"typeId\":%d,\"netId\":%d,"
-    "\"data\":{\"vac\":%d,\"iac\":%d,\"3Ph\":%s,\"pMan\":%s}}";  
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Private.DeviceIdStr,
-    Config.Private.LabelStr, 
-    Config.Public.DhDevice.DeviceType,
-    Config.Public.DhDevice.NetworkId,
-    //data object
-    Config.Private.Power.ChargeVoltage, 
-    Config.Private.Power.ChargeCurrentMax, 
-    IS_3PHASE_POWER?"true":"false",
-    Config.Private.Power.IsManaged?"true":"false"
-  );    
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int serUrlRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"serUrl/read\",\"serUrl\":\"%s\"}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Public.ServerUrlStr
-  );
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int devTokenRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"dT/read\",\"dt\":\"%s\"}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Public.DevRefreshJwtStr
-  );
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int cliTokenRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"cT/read\",\"t\":\"%s\"}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Public.ClientRefreshJwtStr
-  );
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int ratesRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"rates/read\",\"devId\":\"%s\","
-    "\"tState\":\"%s\",\"kWh\":%0.4f,\"park_hr\":%0.4f,\"parkPen_min\":%0.4f,"
-    "\"freePark_min\":%d,\"temp\":%0.4f}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr,
-    Config.Private.DeviceIdStr,
-    Trans_GetStateName(),
-    Config.Public.Rates.Energy_kWh,
-    Config.Public.Rates.Parking_hr,
-    Config.Public.Rates.ParkPenalty_min,
-    Config.Public.Rates.FreeParking_min,
-    CurTemperature
-  );
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-//{"kWh":%f, "park_hr":%f, "parkPen_min":%f, "freePark_min":%f}
-int ratesWrite(TSPort *port, const char *json, int tokenCount)
-{
-  for (int i=3; i<tokenCount; i++) {
-    tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-    i++;
-    if (strcmp(tokbuf, "kWh") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      Config.Public.Rates.Energy_kWh = atof(tokbuf);
-    }
-    else if (strcmp(tokbuf, "park_hr") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      Config.Public.Rates.Parking_hr = atof(tokbuf);
-    }
-    else if (strcmp(tokbuf, "parkPen_min") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      Config.Public.Rates.ParkPenalty_min = atof(tokbuf);
-    }
-    else if (strcmp(tokbuf, "freePark_min") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      Config.Public.Rates.FreeParking_min = atof(tokbuf);
-    }
-  }
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "rates/write",
-    Config.Private.DeviceIdStr, 0);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int powerRead(TSPort *port, const char *json, int tokenCount)
-{
-  float current, KWh;
-  const char fmtStr[] = "{\"action\":\"power/read\",\"devId\":\"%s\","
-    "\"tState\":\"%s\",\"v(V)\":%d,\"i(A)\":%0.4f,\"kWh\":%0.4f,\"temp\":%0.4f}";
-  GetPowerVar(&current, &KWh);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Private.DeviceIdStr,
-    Trans_GetStateName(),
-    Config.Private.Power.ChargeVoltage,
-    current,
-    KWh,
-    CurTemperature
-  );      
-  return Send(port, strlen((char*)port->TxBuffer));  
-}
-
-int stateRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"state/read\",\"devId\":\"%s\","
-    "\"tState\":\"%s\",\"panic\":%s,\"hwError\":%s,\"lidOpen\":%s,\"temp\":%0.4f}";
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr, 
-    Config.Private.DeviceIdStr,
-    Trans_GetStateName(),
-    IsPanic()?"true":"false",
-    IsFatalError()?"true":"false",
-    IsCoverOpended()?"true":"false",
-    CurTemperature
-  );        
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-//{"delay_s":%d, "deposit":%f}
-int transAuthen(TSPort *port, const char *json, int tokenCount)
-{
-  unsigned int delay = 0;
-  double deposit = 0;
-  for (int i=3; i<tokenCount; i++) {
-    tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-    i++;
-    if (strcmp(tokbuf, "delay_s") == 0)
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      delay = round(atof(tokbuf));
-    }
-    else if (strcmp(tokbuf,  "deposit") == 0)
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      deposit = atof(tokbuf);
-    }
-  }
-  Trans_Authen(deposit, delay);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "trans/authen",
-    Config.Private.DeviceIdStr, 0);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int transStop(TSPort *port, const char *json, int tokenCount)
-{
-  Trans_SetState(trParking, 0);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "trans/stop",
-    Config.Private.DeviceIdStr, 0);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int billRead(TSPort *port, const char *json, int tokenCount)
-{
-  const char fmtStr[] = "{\"action\":\"bill/read\",\"devId\":\"%s\","
-    "\"tState\":\"%s\",\"chargeMin\":%0.4f,\"kWh\":%0.4f,\"energyFee\":%0.4f,\"parkMin\":%d,"
-  "\"parkFee\":%0.4f,\"parkPen\":%0.4f,\"payable\":%0.4f,\"paidAmt\":%0.4f,\"isPaid\":%s,\"temp\":%0.4f}";
-
-  TBill bill;
-  Trans_GetBill(&bill);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr,
-    Config.Private.DeviceIdStr,
-    Trans_GetStateName(),
-    (float)(bill.ChargingSec)/60,
-    bill.Energy_kWh,
-    bill.EnergyFee,
-    bill.ParkingMin,
-    bill.ParkingFee,
-    bill.ParkPenalty,
-    bill.PayableAmount,
-    bill.PaidAmount,
-    bill.IsPaid?"true":"false",
-    CurTemperature
-  );
-  return Send(port, strlen((char*)port->TxBuffer));      
-}
-
-//{"amount":%f}
-int billPay(TSPort *port, const char *json, int tokenCount)
-{
-  float amount;
-  for (int i=3; i<tokenCount; i++) {
-    tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-    i++;
-    if (strcmp(tokbuf, "amount") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      amount = atof(tokbuf);
-    }
-  }
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "bill/pay",
-    Config.Private.DeviceIdStr, 
-    Trans_SetState(trPaid, amount)? 0: -1);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int meterRead(TSPort *port, const char *json, int tokenCount)
-{
-  float current;
-  TBill bill;
-  const char fmtStr[] = "{\"action\":\"meter/read\",\"devId\":\"%s\","
-    "\"tState\":\"%s\",\"chargeMin\":%0.4f,\"current\":%0.4f,\"kWh\":%0.4f,"
-  "\"energyFee\":%0.4f,\"parkFee\":%0.4f,\"temp\":%0.4f}";
-
-  GetPowerVar(&current, NULL);
-  Trans_GetBill(&bill);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, fmtStr,
-    Config.Private.DeviceIdStr,
-    Trans_GetStateName(),
-    (float)(bill.ChargingSec)/60,
-    current,
-    bill.Energy_kWh,
-    bill.EnergyFee,
-    bill.ParkingFee,
-    CurTemperature
-  );
-  return Send(port, strlen((char*)port->TxBuffer));      
-}
-
-int statePoll(TSPort *port, const char *json, int tokenCount)
-{
-  switch(Trans_GetState()) 
-  {
-    case trIdle:
-    case trHandshake:
-      return stateRead(port, json, tokenCount);
-    case trAuthen:
-      return ratesRead(port, json, tokenCount);
-    case trCharging:
-      return meterRead(port, json, tokenCount);
-    case trParking:
-    case trBilling:
-      return billRead(port, json, tokenCount);
-    case trPaid:
-      return billRead(port, json, tokenCount);
-  }
-  return 1;
-}
-
-int resetError(TSPort *port, const char *json, int tokenCount)
-{
-  osThreadFlagsSet(PilotThread_id, PILOT_RESET_ERROR);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "error/reset",
-    Config.Private.DeviceIdStr, 0);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-#ifdef EMULATION_ENABLED
-//{"stateId":%d}
-int pilotStateWrite(TSPort *port, const char *json, int tokenCount)
-{
-  int state = -1;
-  for (int i=3; i<tokenCount; i++) 
-  {
-    tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-    i++;
-    if (strcmp(tokbuf, "stateId") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      state = atoi(tokbuf);
-      break;
-    }
-  }
-  if (state!=-1) 
-    SetVoltage((TVoltageLevel)state);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "pilotState/write",
-    Config.Private.DeviceIdStr, 
-    state!=-1? 0: -1);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-
-int tempTestSet(TSPort *port, const char *json, int tokenCount)
-{
-  int state = -1;
-  for (int i=3; i<tokenCount; i++) 
-  {
-    tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-    i++;
-    if (strcmp(tokbuf, "value") == 0) 
-    {
-      tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[i]);
-      state = atoi(tokbuf);
-      break;
-    }
-  }
-  if (state!=-1) 
-    SetTempTestPin(state);
-  snprintf((char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, resultJsonStr, 
-    "tempTest/set",
-    Config.Private.DeviceIdStr, 
-    state!=-1? 0: -1);
-  return Send(port, strlen((char*)port->TxBuffer));
-}
-#endif
-
-const TCommand Commands[] = 
-{
-  {"wifi/read", wifiRead},
-  {"config/read", configRead},
-  {"serUrl/read", serUrlRead},
-  {"dT/read", devTokenRead},
-  {"cT/read", cliTokenRead},
-  {"rates/read", ratesRead},
-  {"rates/write", ratesWrite},
-  {"state/read", stateRead},
-  {"trans/authen", transAuthen},
-  {"trans/stop", transStop},
-  {"bill/read", billRead},
-  {"bill/pay", billPay},
-  {"power/read", powerRead},
-  {"state/poll", statePoll},
-  {"meter/read", meterRead},
-  {"error/reset", resetError},
-#ifdef EMULATION_ENABLED
-  {"pilotState/write", pilotStateWrite},
-  {"tempTest/set", tempTestSet},
-#endif  
-};
-
-void dhThread(void *arg)
-{ 
-  TSPort *port;
-  osStatus_t osStatus;
-//  static uint32_t flags;
-
-  SPortMsgQ = osMessageQueueNew(2, sizeof(TSPort*), NULL);
-  while(!SPortMsgQ);
-	USART_Cmd(WIFI_UART, ENABLE);
-  WiFi_Reset(); 	
-  while(1)
-  {		        
-    osStatus = osMessageQueueGet(SPortMsgQ, &port, NULL, osWaitForever/*MsToOSTicks(10)*/);
-    if (osStatus==osOK)
-    {
-      if (!ValidateCrc32Blk(port->RxBuffer, port->RxPos))
-        continue;
-      char *js = (char*)port->RxBuffer;
-      js[port->RxPos-4] = 0; //remove crc bytes
-      jsmn_init(&jsparser);
-      int r = jsmn_parse(&jsparser, js, port->RxPos-4, tokens, sizeof(tokens)/sizeof(tokens[0]));
-      if (r<0) //invalid json string
-        continue;
-      	/* Assume the top-level element is an object */
-      if (r < 1 || tokens[0].type != JSMN_OBJECT)
-        continue;      
-      if (jsoneq(js, &tokens[1], "cmd") != 0) //first key must be "cmd"
-        break;
-      for (int i=0; i<sizeof(Commands)/sizeof(Commands[0]); i++)
-        if (jsoneq(js, &tokens[2], Commands[i].command)==0)
-        {
-          Commands[i].action(port, js, r);
-          break;
-        }
-    }
-  }
-}
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <math.h>
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "rtx_os.h"
+#include "hal.h"
+#include "stm32f10x_it.h"
+#include "dhThread.h"
+#include "app_main.h"
+#include "mem.h"
+#include "PilotThread.h"
+#include "crc32.h"
+#include  "RFID_Card.h"
+#include "jsmn.h"
+#include "trans.h"
+#include "CT_Thread.h"
+#include "app_main.h"
+#include "capacity.h"
+#include "setpoint.h"
+#include "trace.h"
+#include "taper.h"
+#include "tariff.h"
+#include "schedule.h"
+#include "ledger.h"
+#include "totals.h"
+#include "jsonw.h"
+#include "telemetry.h"
+#include "cbor.h"
+
+osRtxThread_t dhThread_tcb;
+uint64_t dhThreadStk[192]; //deepest: batch/run of trace/read, about 1.1 KB
+const osThreadAttr_t dhThread_attr = { 
+  .cb_mem = &dhThread_tcb,
+  .cb_size = sizeof(dhThread_tcb),
+  .stack_mem = dhThreadStk,  
+  .stack_size = sizeof(dhThreadStk), 
+  .priority = osPriorityHigh,
+};
+
+TSPort WiFiPort = {.Uart=WIFI_UART, .RxDma=WIFI_RX_DMA, .TxDma=WIFI_TX_DMA, .GapTim=WIFI_UART_RX_TIM};
+TSPort GprsPort = {.Uart=GPRS_UART, .RxDma=GPRS_RX_DMA, .TxDma=GPRS_TX_DMA, .GapTim=GPRS_UART_TIMER};
+osMessageQueueId_t SPortMsgQ;
+
+#define DH_IDLE_DLY         MsToOSTicks(50)
+
+static jsmntok_t *tokens; //of the frame being dispatched
+jsmn_parser jsparser;
+char tokbuf[61];
+static char CborText[2*PKT_PLAYLOAD_SIZE]; //a CBOR request as JSON text
+static uint32_t CmdSeed; //of the command hash, 0 none found
+#ifdef IRQ_OFF_STATS
+static uint32_t DispatchMaxCyc; //worst command lookup
+#endif
+
+typedef int(*TAction)(TSPort *port, const char *json, int tokenCount);
+typedef struct
+{
+  const char *command;
+  TAction action;
+} TCommand;
+  
+/* Serial ports
+ *
+ * Both directions run on DMA. Receive is a circular DMA into Ring, moved
+ * into the port's Rx buffer at half and full ring and on an idle line. An
+ * idle line ending a frame with a good CRC posts it at once. Otherwise the
+ * frame was paused mid-way, or what came before an idle line was noise and
+ * the bytes after it are a frame of their own, the next idle line tries
+ * all of it and then from each of the last RX_SPLITS idle lines on. GapTim
+ * drops what is left once the line stays quiet for UART_GAP_US.
+ * Rx buffers come from RxPool, one is taken at the first byte of a frame
+ * and handed to dhThread by pointer when the frame is posted, so a frame
+ * arriving while another is parsed has a buffer of its own. With none
+ * free the frame is discarded and counted in RxDrops, a frame longer than
+ * a buffer in RxOverruns.
+ * Each drain also runs the frame's CRC and, for JSON, its tokens over the
+ * new bytes, both held back from the last 4 which may be the CRC itself
+ * and jsmn from a number that may not be complete yet. At the idle line
+ * only the tail is left, the CRC check is a compare and dhThread gets the
+ * frame tokenised. Tokens are per port and handed to dhThread with the
+ * frame, a frame that starts while another of its port is queued is not
+ * tokenised on receive. Those, a frame taken from a later idle line and
+ * CBOR are left to dhThread to parse, into the same port tokens.
+ * Transmit is one DMA transfer of TxBuffer, TxSize is cleared when it is
+ * done. The ISRs in stm32f10x_it.c call the SPort_xxx functions, all at
+ * the same priority so they never preempt each other.
+ */
+
+static uint32_t RxPoolMem[osRtxMemoryPoolMemSize(RX_FRAMES, sizeof(TPacket))/4];
+static osRtxMemoryPool_t RxPoolCb;
+static const osMemoryPoolAttr_t RxPoolAttr = {
+  .cb_mem = &RxPoolCb,
+  .cb_size = sizeof(RxPoolCb),
+  .mp_mem = RxPoolMem,
+  .mp_size = sizeof(RxPoolMem),
+};
+static osMemoryPoolId_t RxPool;
+
+static void sportInit(TSPort *port)
+{
+  DMA_InitTypeDef dma;
+
+  DMA_DeInit(port->RxDma);
+  dma.DMA_PeripheralBaseAddr = (uint32_t)&port->Uart->DR;
+  dma.DMA_MemoryBaseAddr = (uint32_t)port->Ring;
+  dma.DMA_DIR = DMA_DIR_PeripheralSRC;
+  dma.DMA_BufferSize = sizeof(port->Ring);
+  dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  dma.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  dma.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  dma.DMA_Mode = DMA_Mode_Circular;
+  dma.DMA_Priority = DMA_Priority_Medium;
+  dma.DMA_M2M = DMA_M2M_Disable;
+  DMA_Init(port->RxDma, &dma);
+  DMA_ITConfig(port->RxDma, DMA_IT_HT|DMA_IT_TC, ENABLE);
+  DMA_Cmd(port->RxDma, ENABLE);
+
+  DMA_DeInit(port->TxDma);
+  dma.DMA_MemoryBaseAddr = (uint32_t)port->TxBuffer;
+  dma.DMA_DIR = DMA_DIR_PeripheralDST;
+  dma.DMA_BufferSize = 1; //set per frame
+  dma.DMA_Mode = DMA_Mode_Normal;
+  DMA_Init(port->TxDma, &dma);
+  DMA_ITConfig(port->TxDma, DMA_IT_TC, ENABLE);
+
+  USART_DMACmd(port->Uart, USART_DMAReq_Rx|USART_DMAReq_Tx, ENABLE);
+  USART_ITConfig(port->Uart, USART_IT_IDLE, ENABLE);
+}
+
+//where a JSON chunk may end, jsmn takes a number cut by the end as complete
+static int jsonCut(const uint8_t *s, int from, int to)
+{
+  while ((to > from) && !strchr(",:{}[]\" \t\r\n", s[to-1]))
+    to--;
+  return to;
+}
+
+//CRC and tokens of Rx up to where the CRC trailer may start. Tokens are
+//taken only with no frame of the port queued, or dhThread may be reading
+//them. A frame that waited is tokenised by dhThread.
+static void rxScan(TSPort *port)
+{
+  TPacket *rx = port->Rx;
+  int end = port->RxPos-4;
+
+  if (!rx || (port->RxPos > sizeof(rx->payload)) || (end <= port->RxCrcPos))
+    return;
+  port->RxCrc = crc32_add(port->RxCrc, &rx->payload[port->RxCrcPos], end-port->RxCrcPos);
+  port->RxCrcPos = end;
+  if ((rx->payload[0]=='{') && !port->RxQueued && ((rx->TokenCount==0) || (rx->TokenCount==JSMN_ERROR_PART)))
+    rx->TokenCount = jsmn_parse(&port->RxParser, (char*)rx->payload, 
+      jsonCut(rx->payload, port->RxParser.pos, end), port->Tokens, RX_TOKENS);
+}
+
+//the whole of Rx is a frame, by the running CRC. Its tokens are completed.
+static int rxComplete(TSPort *port)
+{
+  TPacket *rx = port->Rx;
+  const uint8_t *crc = &rx->payload[port->RxPos-4];
+
+  if ((port->RxPos <= 4) || (port->RxCrcPos != port->RxPos-4) ||
+    (~port->RxCrc != (crc[0]|crc[1]<<8|crc[2]<<16|(uint32_t)crc[3]<<24)))
+    return 0;
+  if (rx->TokenCount==JSMN_ERROR_PART) //the last number or what trails the object
+    rx->TokenCount = jsmn_parse(&port->RxParser, (char*)rx->payload, port->RxCrcPos, port->Tokens, RX_TOKENS);
+  return 1;
+}
+
+//moves what the DMA wrote since the last call into Rx, the byte count.
+//RxPos counts on past the buffer or without one, the frame is then
+//dropped when it ends.
+static int rxDrain(TSPort *port)
+{
+  uint16_t head = (UART_RX_RING-port->RxDma->CNDTR)%UART_RX_RING;
+  int n, fit, total = 0;
+
+  if ((head != port->RingPos) && !port->RxPos) //a new frame
+  {
+    if (!port->Rx)
+      port->Rx = osMemoryPoolAlloc(RxPool, 0);
+    if (port->Rx)
+      port->Rx->TokenCount = 0;
+    port->RxCrc = CRC32_INIT;
+    port->RxCrcPos = 0;
+    jsmn_init(&port->RxParser);
+  }
+  while (head != port->RingPos)
+  {
+    n = ((head > port->RingPos)? head: UART_RX_RING) - port->RingPos;
+    fit = port->Rx? (int)sizeof(port->Rx->payload)-port->RxPos: 0;
+    if (fit > n)
+      fit = n;
+    if (fit > 0)
+      memcpy(&port->Rx->payload[port->RxPos], &port->Ring[port->RingPos], fit);
+    if (port->RxPos+n <= 0xFFFF)
+      port->RxPos += n;
+    port->RingPos = (port->RingPos+n)%UART_RX_RING;
+    total += n;
+  }
+  if (total)
+    rxScan(port);
+  return total;
+}
+
+static void rxReset(TSPort *port)
+{
+  DISABLE_TIMER(port->GapTim);
+  port->RxPos = 0;
+  port->RxSplits = 0;
+}
+
+static void rxPost(TSPort *port)
+{
+  port->Rx->Port = port;
+  port->Rx->len = port->RxPos;
+  rxReset(port);
+  if (osMessageQueuePut(SPortMsgQ, &port->Rx, NULL, 0)!=osOK)
+  {
+    port->RxDrops++; //the buffer is kept for the next frame
+    return;
+  }
+  port->RxQueued++;
+  port->Rx = NULL;
+}
+
+//the ring is half or completely full
+void SPort_RxDrain(TSPort *port)
+{
+  rxDrain(port);
+}
+
+void SPort_RxIdle(TSPort *port)
+{
+  uint8_t *frame;
+  int i, start;
+  rxDrain(port);
+  if (!port->RxPos)
+    return;
+  if (!port->Rx || (port->RxPos > sizeof(port->Rx->payload)))
+  {
+    if (!port->Rx)
+      port->RxDrops++;
+    else
+      port->RxOverruns++;
+    rxReset(port);
+    return;
+  }
+  if (rxComplete(port))
+  {
+    rxPost(port);
+    return;
+  }
+  frame = port->Rx->payload;
+  for (i=0; i<port->RxSplits; i++)
+  {
+    start = port->RxSplit[i];
+    if (ValidateCrc32Blk(&frame[start], port->RxPos-start))
+    {
+      port->RxPos -= start;
+      memmove(frame, &frame[start], port->RxPos);
+      port->Rx->TokenCount = 0; //parsed by dhThread
+      rxPost(port);
+      return;
+    }
+  }
+  if (port->RxSplits == RX_SPLITS) //the oldest goes
+  {
+    memmove(port->RxSplit, &port->RxSplit[1], sizeof(port->RxSplit)-sizeof(port->RxSplit[0]));
+    port->RxSplits--;
+  }
+  port->RxSplit[port->RxSplits++] = port->RxPos;
+  SetTimeout_us(port->GapTim, UART_GAP_US);
+}
+
+//the line stayed quiet after bytes that made no frame
+void SPort_RxGap(TSPort *port)
+{
+  DISABLE_TIMER(port->GapTim);
+  if (rxDrain(port)) //still coming, the idle line decides
+    return;
+  rxReset(port); //the buffer, if any, is kept for the next frame
+}
+
+void SPort_TxDone(TSPort *port)
+{
+  DMA_Cmd(port->TxDma, DISABLE);
+  port->TxSize = 0;
+}
+
+static void txStart(TSPort *port)
+{
+  CalcCrc32Blk(port->TxBuffer, port->TxSize);
+  port->TxDma->CNDTR = port->TxSize;
+  DMA_Cmd(port->TxDma, ENABLE);
+}
+
+int SendStr(TSPort *port, const char *s)
+{
+  if (port->TxSize==0) //is idle?
+  {
+    int len = strlen(s);
+    if (len > PKT_PLAYLOAD_SIZE)
+      return 0;    
+    port->TxSize= len+4;
+    memcpy(port->TxBuffer, s, len);
+    txStart(port);
+    return 1;
+  }
+  return 0;
+}
+
+static int transmit(TSPort *port, int size)
+{
+  if (size > PKT_PLAYLOAD_SIZE)
+    return 0;
+  while (port->TxSize!=0) //wait until idle
+  {
+    osDelay(2); 
+  }
+  port->TxSize= size+4;
+  txStart(port);
+  port->TxFrames++;
+  return 1;
+}
+
+static void waitTxIdle(TSPort *port)
+{
+  while (port->TxSize!=0)
+    osDelay(2);
+}
+
+/* Batches
+ *
+ * {"cmd":"batch","cmds":[{"cmd":"state/poll"},{"cmd":"bill/read","conn":0}]}
+ * runs up to BATCH_CMDS commands in order from one frame. Their replies are
+ * packed into {"action":"batch","devId":"..","replies":[..]} frames sent back
+ * to back. A reply that does not fit the open frame starts the next one, a
+ * reply too big to share a frame goes out on its own as usual.
+ */
+
+static struct
+{
+  uint8_t Active;
+  uint8_t Count; //replies in the open frame
+  uint16_t Len;
+  char Buf[PKT_PLAYLOAD_SIZE]; //the open frame, without its closing
+} Batch;
+
+static void batchBegin(TSPort *port)
+{
+  TJsonW w;
+  JsonW_Begin(&w, Batch.Buf, sizeof(Batch.Buf), port->Cbor);
+  JsonW_Str(&w, "action", "batch");
+  JsonW_Str(&w, "devId", Config.Private.DeviceIdStr);
+  JsonW_Open(&w, "replies", '[');
+  Batch.Len = w.Len;
+  Batch.Count = 0;
+}
+
+//closes the replies and the frame, two bytes either way
+static void batchClose(TSPort *port, uint8_t *end)
+{
+  if (port->Cbor)
+    end[0] = end[1] = 0xFF;
+  else
+    memcpy(end, "]}", 2);
+}
+
+//the open frame is sent from TxBuffer, a reply there is swapped into Buf meanwhile
+static void batchSend(TSPort *port, int replySize)
+{
+  char *tx = (char*)port->TxBuffer, c;
+  int i, n = Batch.Len;
+  for (i=0; i<n || i<replySize; i++)
+  {
+    c = tx[i];
+    tx[i] = Batch.Buf[i];
+    Batch.Buf[i] = c;
+  }
+  batchClose(port, (uint8_t*)&tx[n]);
+  transmit(port, n+2);
+  waitTxIdle(port);
+  memcpy(tx, Batch.Buf, replySize);
+  batchBegin(port);
+}
+
+//the reply in TxBuffer goes into the open frame
+static int batchAdd(TSPort *port, int size)
+{
+  if (size > PKT_PLAYLOAD_SIZE)
+    return 0;
+  if (Batch.Len+1+size+2 < PKT_PLAYLOAD_SIZE)
+  {
+    if (Batch.Count++ && !port->Cbor)
+      Batch.Buf[Batch.Len++] = ',';
+    memcpy(&Batch.Buf[Batch.Len], port->TxBuffer, size);
+    Batch.Len += size;
+    return 1;
+  }
+  if (Batch.Count == 0) //too big to share a frame
+  {
+    transmit(port, size);
+    waitTxIdle(port);
+    return 1;
+  }
+  batchSend(port, size);
+  return batchAdd(port, size);
+}
+
+static int Send(TSPort *port, int size)
+{
+  if (Batch.Active)
+    return batchAdd(port, size);
+  return transmit(port, size);
+}
+
+static int jsoneq(const char *json, jsmntok_t *tok, const char *s) {
+	if (tok->type == JSMN_STRING && (int) strlen(s) == tok->end - tok->start &&
+			memcmp(json + tok->start, s, tok->end - tok->start) == 0) {
+		return 0;
+	}
+	return -1;
+}
+
+static void tokencpy(char *buf, int bufSize, const char *jsStr, jsmntok_t *tok)
+{
+  int len = tok->end-tok->start;
+  if (len>=bufSize)
+    len = bufSize-1;
+  memcpy(buf, &jsStr[tok->start], len);
+  buf[len] = 0;
+}
+
+/* Command arguments
+ *
+ * Numbers are read straight from the token span, nothing is copied. A
+ * handler declares its arguments as a TArgDesc table over its own struct
+ * and parseArgs fills the struct in one pass over the keys. A value that is
+ * not a number is ignored, the field keeps its default.
+ */
+
+typedef enum {argInt, argUint, argMilli} TArgType;
+
+typedef struct
+{
+  const char *Key;
+  uint8_t KeyLen;
+  uint8_t Type; //TArgType
+  uint16_t Offset; //of the 32 bit field in the argument struct
+} TArgDesc;
+
+#define ARG(st, field, key, type)   {key, sizeof(key)-1, type, offsetof(st, field)}
+#define ARG_BAD                     0x80000000 //a key of desc with a value out of its type
+
+//"12.3456" -> 12346; decimal text to milli-units, rounded on the 4th decimal
+//0 when it is not a number or does not fit TMilli
+static int tokToMilli(const char *json, jsmntok_t *tok, TMilli *val)
+{
+  const char *p = json+tok->start, *end = json+tok->end;
+  TMilli v = 0, frac = 0, scale = 1000;
+  int neg = 0, digits = 0;
+
+  if ((p<end) && ((*p=='-')||(*p=='+')))
+    neg = *p++ == '-';
+  for (; (p<end) && isdigit(*p); p++, digits++)
+  {
+    v = v*10 + *p-'0';
+    if (v > INT32_MAX/1000)
+      return 0;
+  }
+  if ((p<end) && (*p == '.'))
+  {
+    for (p++; (p<end) && isdigit(*p) && (scale>1); p++, digits++)
+    {
+      scale /= 10;
+      frac += (*p-'0')*scale;
+    }
+    if ((p<end) && isdigit(*p) && (*p>='5'))
+      frac++;
+    while ((p<end) && isdigit(*p))
+      p++;
+  }
+  if (!digits || (p!=end) || (v*1000 > INT32_MAX-frac))
+    return 0;
+  v = v*1000 + frac;
+  *val = neg? -v: v;
+  return 1;
+}
+
+//whole numbers, a fraction is cut off like atoi did, 0 above UINT32_MAX
+static int tokToUint(const char *json, jsmntok_t *tok, uint32_t *val, int *neg)
+{
+  const char *p = json+tok->start, *end = json+tok->end;
+  uint32_t v = 0;
+  int digits = 0;
+
+  *neg = 0;
+  if ((p<end) && ((*p=='-')||(*p=='+')))
+    *neg = *p++ == '-';
+  for (; (p<end) && isdigit(*p); p++, digits++)
+  {
+    if (v > (UINT32_MAX-(*p-'0'))/10)
+      return 0;
+    v = v*10 + *p-'0';
+  }
+  if ((p<end) && (*p == '.'))
+    for (p++; (p<end) && isdigit(*p); p++)
+      ;
+  if (!digits || (p!=end))
+    return 0;
+  *val = v;
+  return 1;
+}
+
+static int tokToInt(const char *json, jsmntok_t *tok, int32_t *val)
+{
+  uint32_t v;
+  int neg;
+  if (!tokToUint(json, tok, &v, &neg) || (v > (neg? 0x80000000u: INT32_MAX)))
+    return 0;
+  *val = neg? (int32_t)(0u-v): (int32_t)v;
+  return 1;
+}
+
+//first token after tok and everything nested in it
+static int tokNext(int i, int tokenCount)
+{
+  int end = tokens[i].end;
+  for (i++; (i<tokenCount) && (tokens[i].start<end); i++)
+    ;
+  return i;
+}
+
+//fills args from the keys of the command object, returns a bit per argument found
+//and ARG_BAD when a value did not parse, its field is left as it was
+static uint32_t parseArgs(const char *json, int tokenCount, const TArgDesc *desc, int n, void *args)
+{
+  uint32_t found = 0;
+  int i, k, ok, neg;
+
+  for (i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+  {
+    jsmntok_t *key = &tokens[i], *val = &tokens[i+1];
+    if ((key->type!=JSMN_STRING) || (val->type==JSMN_ARRAY) || (val->type==JSMN_OBJECT))
+      continue;
+    for (k=0; k<n; k++)
+    {
+      if ((desc[k].KeyLen!=key->end-key->start) || memcmp(json+key->start, desc[k].Key, desc[k].KeyLen))
+        continue;
+      void *field = (uint8_t*)args+desc[k].Offset;
+      if (desc[k].Type==argMilli)
+        ok = tokToMilli(json, val, (TMilli*)field);
+      else if (desc[k].Type==argInt)
+        ok = tokToInt(json, val, (int32_t*)field);
+      else
+        ok = tokToUint(json, val, (uint32_t*)field, &neg) && !neg;
+      found |= ok? 1<<k: ARG_BAD;
+      break;
+    }
+  }
+  return found;
+}
+
+//{"conn":%d} selects the connector, 0 when absent, -1 when there is no such connector
+static int connArg(const char *json, int tokenCount)
+{
+  static const TArgDesc desc[] = {{"conn", 4, argInt, 0}};
+  int32_t conn = 0;
+  if (parseArgs(json, tokenCount, desc, CountOf(desc), &conn) & ARG_BAD)
+    return -1;
+  return (conn>=0) && (conn<CONNECTORS)? conn: -1;
+}
+
+//seconds as minutes with 4 decimals, rounded like %0.4f
+static int32_t secToMin4(uint32_t sec)
+{
+  return (sec/60)*10000 + ((sec%60)*10000+30)/60;
+}
+
+//starts a reply in the TX buffer with the action and device id, in the
+//encoding of the request
+static void beginJson(TSPort *port, TJsonW *w, const char *action)
+{
+  while (port->TxSize!=0) //the buffer is still being sent
+    osDelay(2);
+  JsonW_Begin(w, (char*)port->TxBuffer, PKT_PLAYLOAD_SIZE, port->Cbor);
+  JsonW_Str(w, "action", action);
+  JsonW_Str(w, "devId", Config.Private.DeviceIdStr);
+}
+
+static int sendResult(TSPort *port, const char *action, int result)
+{
+  TJsonW w;
+  int len;
+  beginJson(port, &w, action);
+  JsonW_Int(&w, "result", result);
+  len = JsonW_End(&w);
+  return len<0? 0: Send(port, len);
+}
+
+//a reply that did not fit is answered with an error result
+static int sendJson(TSPort *port, TJsonW *w, const char *action)
+{
+  int len = JsonW_End(w);
+  if (len < 0)
+    return sendResult(port, action, -1);
+  return Send(port, len);
+}
+
+int wifiRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  beginJson(port, &w, "wifi/read");
+  JsonW_Int(&w, "wifiMode", Config.Public.WifiConfig.Mode);
+  JsonW_Str(&w, "ssid", Config.Public.WifiConfig.SsidStr);
+  JsonW_Str(&w, "wpa2", Config.Public.WifiConfig.Wpa2KeyStr);
+  return sendJson(port, &w, "wifi/read");
+}
+
+int configRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  beginJson(port, &w, "config/read");
+  JsonW_Str(&w, "label", Config.Private.LabelStr);
+  JsonW_Int(&w, "typeId", Config.Public.DhDevice.DeviceType);
+  JsonW_Int(&w, "netId", Config.Public.DhDevice.NetworkId);
+  JsonW_Open(&w, "data", '{');
+  JsonW_Int(&w, "vac", Config.Private.Power.ChargeVoltage);
+  JsonW_Int(&w, "iac", Config.Private.Power.ChargeCurrentMax);
+  JsonW_Bool(&w, "3Ph", IS_3PHASE_POWER);
+  JsonW_Bool(&w, "pMan", Config.Private.Power.IsManaged);
+  JsonW_Close(&w, '}');
+  return sendJson(port, &w, "config/read");
+}
+
+int serUrlRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  beginJson(port, &w, "serUrl/read");
+  JsonW_Str(&w, "serUrl", Config.Public.ServerUrlStr);
+  return sendJson(port, &w, "serUrl/read");
+}
+
+int devTokenRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  beginJson(port, &w, "dT/read");
+  JsonW_Str(&w, "dt", Config.Public.DevRefreshJwtStr);
+  return sendJson(port, &w, "dT/read");
+}
+
+int cliTokenRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  beginJson(port, &w, "cT/read");
+  JsonW_Str(&w, "t", Config.Public.ClientRefreshJwtStr);
+  return sendJson(port, &w, "cT/read");
+}
+
+int ratesRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "rates/read", -1);
+  beginJson(port, &w, "rates/read");
+  JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+  JsonW_Milli(&w, "kWh", Config.Public.Rates.Energy_kWh);
+  JsonW_Milli(&w, "park_hr", Config.Public.Rates.Parking_hr);
+  JsonW_Milli(&w, "parkPen_min", Config.Public.Rates.ParkPenalty_min);
+  JsonW_Int(&w, "freePark_min", Config.Public.Rates.FreeParking_min);
+  JsonW_Float(&w, "temp", CurTemperature, 4);
+  return sendJson(port, &w, "rates/read");
+}
+
+//{"kWh":%f, "park_hr":%f, "parkPen_min":%f, "freePark_min":%f}
+int ratesWrite(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {TMilli Energy, Parking, Penalty; int32_t FreeMin;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Energy, "kWh", argMilli),
+    ARG(TArgs, Parking, "park_hr", argMilli),
+    ARG(TArgs, Penalty, "parkPen_min", argMilli),
+    ARG(TArgs, FreeMin, "freePark_min", argInt),
+  };
+  TRates *rates = &Config.Public.Rates;
+  TArgs args = {rates->Energy_kWh, rates->Parking_hr, rates->ParkPenalty_min, rates->FreeParking_min};
+  if (parseArgs(json, tokenCount, desc, CountOf(desc), &args) & ARG_BAD)
+    return sendResult(port, "rates/write", -1);
+  rates->Energy_kWh = args.Energy;
+  rates->Parking_hr = args.Parking;
+  rates->ParkPenalty_min = args.Penalty;
+  rates->FreeParking_min = args.FreeMin;
+  return sendResult(port, "rates/write", 0);
+}
+
+//"HH:MM/c" start of a band and its rate class
+static int parseBand(const char *str, uint16_t *band)
+{
+  const char *m = strchr(str, ':'), *c = strchr(str, '/');
+  if (!m || !c)
+    return 0;
+  int hour = atoi(str), min = atoi(m+1), cls = atoi(c+1);
+  if ((hour<0) || (hour>23) || (min<0) || (min>59) || (cls<0) || (cls>=TARIFF_CLASSES))
+    return 0;
+  *band = TARIFF_BAND(hour*60+min, cls);
+  return 1;
+}
+
+int tariffRead(TSPort *port, const char *json, int tokenCount)
+{
+  const char *profile[TARIFF_PROFILES] = {"weekday", "weekend"};
+  TTariff *tariff = &Config.Public.Tariff;
+  TJsonW w;
+  char band[12];
+  beginJson(port, &w, "tariff/read");
+  JsonW_Uint(&w, "time", LocalTime_Get());
+  JsonW_Open(&w, "rates", '[');
+  for (int k=0; k<TARIFF_CLASSES; k++)
+    JsonW_Milli(&w, NULL, tariff->Energy_kWh[k]);
+  JsonW_Close(&w, ']');
+  for (int p=0; p<TARIFF_PROFILES; p++)
+  {
+    JsonW_Open(&w, profile[p], '[');
+    for (int n=0; n<tariff->Count[p]; n++)
+    {
+      uint16_t min = TARIFF_BAND_MIN(tariff->Band[p][n]);
+      snprintf(band, sizeof(band), "%02d:%02d/%d", min/60, min%60, TARIFF_BAND_CLASS(tariff->Band[p][n]));
+      JsonW_Str(&w, NULL, band);
+    }
+    JsonW_Close(&w, ']');
+  }
+  return sendJson(port, &w, "tariff/read");
+}
+
+//{"rates":[r0,r1,r2,r3], "weekday":["00:00/0","07:00/2","22:00/0"], "weekend":["00:00/0"]}
+int tariffWrite(TSPort *port, const char *json, int tokenCount)
+{
+  TTariff tariff = Config.Public.Tariff;
+  int result = 0;
+  for (int i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+  {
+    jsmntok_t *key = &tokens[i], *arr = &tokens[i+1];
+    int e, k;
+    if (jsoneq(json, key, "rates") == 0) 
+    {
+      if (arr->type != JSMN_ARRAY)
+        result = -1;
+      for (e=i+2, k=0; (result==0) && (e<tokenCount) && (tokens[e].start<arr->end); e=tokNext(e, tokenCount), k++)
+        if ((tokens[e].type!=JSMN_PRIMITIVE) || ((k<TARIFF_CLASSES) && !tokToMilli(json, &tokens[e], &tariff.Energy_kWh[k])))
+          result = -1;
+    }
+    else if ((jsoneq(json, key, "weekday") == 0)||(jsoneq(json, key, "weekend") == 0)) 
+    {
+      int p = jsoneq(json, key, "weekday")==0? TARIFF_WEEKDAY: TARIFF_WEEKEND;
+      if (arr->type != JSMN_ARRAY)
+        result = -1;
+      tariff.Count[p] = 0;
+      for (e=i+2, k=0; (result==0) && (e<tokenCount) && (tokens[e].start<arr->end); e=tokNext(e, tokenCount), k++)
+      {
+        tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[e]);
+        if ((k>=TARIFF_BANDS) || (tokens[e].type!=JSMN_STRING) || !parseBand(tokbuf, &tariff.Band[p][k]))
+          result = -1;
+        else
+          tariff.Count[p] = k+1;
+      }
+    }
+  }
+  if ((result==0) && EEP_WriteBlk(EEP_TARIFF_ADDR, &tariff, sizeof(tariff), &Config.Public.Tariff, RangeCheck_Tariff))
+    Tariff_Changed();
+  else
+    result = -1;
+  return sendResult(port, "tariff/write", result);
+}
+
+//"HH:MM-HH:MM" charging window, an end not after the start runs past midnight
+static int parseWindow(const char *str, uint16_t *window)
+{
+  const char *m1 = strchr(str, ':'), *d = strchr(str, '-');
+  const char *m2 = d? strchr(d, ':'): NULL;
+  if (!m1 || !d || !m2)
+    return 0;
+  int h1 = atoi(str), n1 = atoi(m1+1), h2 = atoi(d+1), n2 = atoi(m2+1);
+  if ((h1<0) || (h1>23) || (n1<0) || (n1>59) || (h2<0) || (h2>24) || (n2<0) || (n2>59) || (h2*60+n2>24*60))
+    return 0;
+  window[0] = h1*60+n1;
+  window[1] = h2*60+n2;
+  return window[0]!=window[1];
+}
+
+int scheduleRead(TSPort *port, const char *json, int tokenCount)
+{
+  const char *profile[TARIFF_PROFILES] = {"weekday", "weekend"};
+  TSchedule *schedule = &Config.Public.Schedule;
+  TJsonW w;
+  char window[12];
+  beginJson(port, &w, "schedule/read");
+  JsonW_Uint(&w, "time", LocalTime_Get());
+  for (int p=0; p<TARIFF_PROFILES; p++)
+  {
+    JsonW_Open(&w, profile[p], '[');
+    for (int n=0; n<schedule->Count[p]; n++)
+    {
+      uint16_t *win = schedule->Window[p][n];
+      snprintf(window, sizeof(window), "%02d:%02d-%02d:%02d", win[0]/60, win[0]%60, win[1]/60, win[1]%60);
+      JsonW_Str(&w, NULL, window);
+    }
+    JsonW_Close(&w, ']');
+  }
+  return sendJson(port, &w, "schedule/read");
+}
+
+//{"weekday":["23:00-06:00"], "weekend":["00:00-24:00"]} charging windows by the day
+//they start on, a profile left out is kept. Empty in both profiles charges any time,
+//empty in one of them does not charge on those days.
+int scheduleWrite(TSPort *port, const char *json, int tokenCount)
+{
+  TSchedule schedule = Config.Public.Schedule;
+  int result = 0;
+  for (int i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+  {
+    jsmntok_t *key = &tokens[i], *arr = &tokens[i+1];
+    int e, k;
+    if ((jsoneq(json, key, "weekday") == 0)||(jsoneq(json, key, "weekend") == 0)) 
+    {
+      int p = jsoneq(json, key, "weekday")==0? TARIFF_WEEKDAY: TARIFF_WEEKEND;
+      if (arr->type != JSMN_ARRAY)
+        result = -1;
+      schedule.Count[p] = 0;
+      for (e=i+2, k=0; (result==0) && (e<tokenCount) && (tokens[e].start<arr->end); e=tokNext(e, tokenCount), k++)
+      {
+        tokencpy(tokbuf, sizeof(tokbuf), json, &tokens[e]);
+        if ((k>=SCHEDULE_WINDOWS) || (tokens[e].type!=JSMN_STRING) || !parseWindow(tokbuf, schedule.Window[p][k]))
+          result = -1;
+        else
+          schedule.Count[p] = k+1;
+      }
+    }
+  }
+  if ((result==0) && EEP_WriteBlk(EEP_SCHEDULE_ADDR, &schedule, sizeof(schedule), &Config.Public.Schedule, RangeCheck_Schedule))
+    Schedule_Changed();
+  else
+    result = -1;
+  return sendResult(port, "schedule/write", result);
+}
+
+//"groups": energy %, parking % and POLICY_xxx flags of each card group in turn
+int policyRead(TSPort *port, const char *json, int tokenCount)
+{
+  TPricePolicy *policy = &Config.Public.Policy;
+  TJsonW w;
+  beginJson(port, &w, "policy/read");
+  JsonW_Open(&w, "groups", '[');
+  for (int g=0; g<POLICY_GROUPS; g++)
+  {
+    JsonW_Uint(&w, NULL, policy->Group[g].EnergyPct);
+    JsonW_Uint(&w, NULL, policy->Group[g].ParkingPct);
+    JsonW_Uint(&w, NULL, policy->Group[g].Flags);
+  }
+  JsonW_Close(&w, ']');
+  return sendJson(port, &w, "policy/read");
+}
+
+//{"groups":[100,100,0, 80,50,1]} from group 0 on, groups left out are kept.
+//Sessions already authorised keep the policy they started with.
+int policyWrite(TSPort *port, const char *json, int tokenCount)
+{
+  TPricePolicy policy = Config.Public.Policy;
+  int result = 0;
+  for (int i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+  {
+    jsmntok_t *key = &tokens[i], *arr = &tokens[i+1];
+    int e, k, n = arr->size;
+    if (jsoneq(json, key, "groups") == 0) 
+    {
+      if ((arr->type!=JSMN_ARRAY) || (n%3) || (n/3>POLICY_GROUPS))
+        result = -1;
+      for (e=i+2, k=0; (result==0) && (k<n) && (e<tokenCount) && (tokens[e].start<arr->end); e=tokNext(e, tokenCount), k++)
+      {
+        int32_t v;
+        if ((tokens[e].type!=JSMN_PRIMITIVE) || !tokToInt(json, &tokens[e], &v) || (v<0) || (v>255))
+          result = -1;
+        else if (k%3==0)
+          policy.Group[k/3].EnergyPct = v;
+        else if (k%3==1)
+          policy.Group[k/3].ParkingPct = v;
+        else
+          policy.Group[k/3].Flags = v;
+      }
+    }
+  }
+  if ((result!=0) || !EEP_WriteBlk(EEP_POLICY_ADDR, &policy, sizeof(policy), &Config.Public.Policy, NULL))
+    result = -1;
+  return sendResult(port, "policy/write", result);
+}
+
+//{"unix":%u, "tzMin":%d} wall time for the tariff, the RTC only counts from power-up
+int timeWrite(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {uint32_t Unix; int32_t TzMin;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Unix, "unix", argUint),
+    ARG(TArgs, TzMin, "tzMin", argInt),
+  };
+  TArgs args = {0, 0};
+  parseArgs(json, tokenCount, desc, CountOf(desc), &args);
+  int ok = args.Unix > LOCAL_EPOCH_UNIX;
+  if (ok)
+  {
+    LocalTime_Set(args.Unix + args.TzMin*60 - LOCAL_EPOCH_UNIX);
+    Tariff_Changed();
+    Schedule_Changed();
+  }
+  return sendResult(port, "time/write", ok? 0: -1);
+}
+
+int powerRead(TSPort *port, const char *json, int tokenCount)
+{
+  float current;
+  uint32_t wh;
+  TJsonW w;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "power/read", -1);
+  GetPowerVar(&current, &wh);
+  beginJson(port, &w, "power/read");
+  JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+  JsonW_Int(&w, "v(V)", Config.Private.Power.ChargeVoltage);
+  JsonW_Float(&w, "i(A)", current, 4);
+  JsonW_Milli(&w, "kWh", wh);
+  JsonW_Float(&w, "temp", CurTemperature, 4);
+  return sendJson(port, &w, "power/read");
+}
+
+int stateRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "state/read", -1);
+  beginJson(port, &w, "state/read");
+  JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+  JsonW_Bool(&w, "panic", IsPanic());
+  JsonW_Bool(&w, "hwError", IsFatalError());
+  JsonW_Bool(&w, "lidOpen", IsCoverOpended());
+  JsonW_Float(&w, "temp", CurTemperature, 4);
+  return sendJson(port, &w, "state/read");
+}
+
+//{"delay_s":%d, "deposit":%f, "cap_kWh":%f, "cap":%f}, caps are optional,
+//the session stops on the first one reached or on the deposit
+int transAuthen(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {TMilli Delay, Deposit, CapWh, CapAmount;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Delay, "delay_s", argMilli),
+    ARG(TArgs, Deposit, "deposit", argMilli),
+    ARG(TArgs, CapWh, "cap_kWh", argMilli), //milli-kWh is Wh
+    ARG(TArgs, CapAmount, "cap", argMilli),
+  };
+  TArgs args = {0, 0, 0, 0};
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "trans/authen", -1);
+  if ((parseArgs(json, tokenCount, desc, CountOf(desc), &args) & ARG_BAD)||
+    (args.Delay < 0)||(args.Deposit < 0)||(args.CapWh < 0)||(args.CapAmount < 0))
+    return sendResult(port, "trans/authen", -1);
+  Trans_Authen(conn, args.Deposit, (args.Delay+500)/1000, args.CapWh, args.CapAmount);
+  return sendResult(port, "trans/authen", 0);
+}
+
+int transStop(TSPort *port, const char *json, int tokenCount)
+{
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "trans/stop", -1);
+  Trans_SetState(conn, trParking, 0);
+  return sendResult(port, "trans/stop", 0);
+}
+
+int billRead(TSPort *port, const char *json, int tokenCount)
+{
+  TJsonW w;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "bill/read", -1);
+
+  TBill bill;
+  Trans_GetBill(conn, &bill);
+  beginJson(port, &w, "bill/read");
+  JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+  JsonW_Fixed(&w, "chargeMin", secToMin4(bill.ChargingSec), 4);
+  JsonW_Milli(&w, "kWh", bill.Energy_Wh);
+  JsonW_Milli(&w, "energyFee", bill.EnergyFee);
+  JsonW_Int(&w, "parkMin", bill.ParkingMin);
+  JsonW_Milli(&w, "parkFee", bill.ParkingFee);
+  JsonW_Milli(&w, "parkPen", bill.ParkPenalty);
+  JsonW_Milli(&w, "payable", bill.PayableAmount);
+  JsonW_Milli(&w, "paidAmt", bill.PaidAmount);
+  JsonW_Bool(&w, "isPaid", bill.IsPaid);
+  JsonW_Float(&w, "temp", CurTemperature, 4);
+  JsonW_Open(&w, "classWh", '[');
+  for (int i=0; i<sizeof(bill.ClassWh)/sizeof(bill.ClassWh[0]); i++)
+    JsonW_Uint(&w, NULL, bill.ClassWh[i]);
+  JsonW_Close(&w, ']');
+  return sendJson(port, &w, "bill/read");
+}
+
+//{"amount":%f}
+int billPay(TSPort *port, const char *json, int tokenCount)
+{
+  static const TArgDesc desc[] = {{"amount", 6, argMilli, 0}};
+  TMilli amount = 0;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "bill/pay", -1);
+  if (parseArgs(json, tokenCount, desc, CountOf(desc), &amount) & ARG_BAD)
+    return sendResult(port, "bill/pay", -1);
+  return sendResult(port, "bill/pay", Trans_SetState(conn, trPaid, amount)? 0: -1);
+}
+
+//{"ack":%u} confirms bills up to that serial, the reply carries the next ones that fit.
+//Bill: [serial,start,end,"card",chargeSec,parkMin,Wh,[classWh],energyFee,parkFee,parkPen,paid,flags,conn],
+//times in local seconds, money in milli-currency, card group in the high nibble of flags.
+//Worst case one bill still fits. "dropped" counts sessions lost to a full ledger.
+int billsSync(TSPort *port, const char *json, int tokenCount)
+{
+  TLedgerRec rec;
+  TJsonW w;
+  static const TArgDesc desc[] = {{"ack", 3, argUint, 0}};
+  uint32_t after, ack;
+
+  if (parseArgs(json, tokenCount, desc, CountOf(desc), &ack) & 1)
+    Ledger_Ack(ack);
+  beginJson(port, &w, "bills/sync");
+  JsonW_Int(&w, "pending", Ledger_GetPending());
+  JsonW_Uint(&w, "dropped", Ledger_GetDropped());
+  JsonW_Open(&w, "bills", '[');
+  for (after=Ledger_GetAcked(); Ledger_Next(after, &rec); after=rec.Serial)
+  {
+    TJsonW mark = w;
+    JsonW_Open(&w, NULL, '[');
+    JsonW_Uint(&w, NULL, rec.Serial);
+    JsonW_Uint(&w, NULL, rec.StartTime);
+    JsonW_Uint(&w, NULL, rec.EndTime);
+    JsonW_Bytes(&w, NULL, rec.CardSn, sizeof(rec.CardSn));
+    JsonW_Uint(&w, NULL, rec.ChargingSec);
+    JsonW_Uint(&w, NULL, rec.ParkingMin);
+    JsonW_Uint(&w, NULL, rec.Energy_Wh);
+    JsonW_Open(&w, NULL, '[');
+    for (int k=0; k<TARIFF_CLASSES; k++)
+      JsonW_Uint(&w, NULL, rec.ClassWh[k]);
+    JsonW_Close(&w, ']');
+    JsonW_Int(&w, NULL, rec.EnergyFee);
+    JsonW_Int(&w, NULL, rec.ParkingFee);
+    JsonW_Int(&w, NULL, rec.ParkPenalty);
+    JsonW_Int(&w, NULL, rec.PaidAmount);
+    JsonW_Uint(&w, NULL, rec.Flags);
+    JsonW_Uint(&w, NULL, rec.Connector);
+    JsonW_Close(&w, ']');
+    if (w.Overflow || (w.Len+2 >= w.Size)) //room for the tail and its terminator
+    {
+      w = mark;
+      break;
+    }
+  }
+  JsonW_Close(&w, ']');
+  return sendJson(port, &w, "bills/sync");
+}
+
+int meterRead(TSPort *port, const char *json, int tokenCount)
+{
+  float current;
+  TBill bill;
+  TTaperInfo taper;
+  TJsonW w;
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "meter/read", -1);
+
+  GetPowerVar(&current, NULL);
+  Trans_GetBill(conn, &bill);
+  Taper_GetInfo(&taper);
+  beginJson(port, &w, "meter/read");
+  JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+  JsonW_Fixed(&w, "chargeMin", secToMin4(bill.ChargingSec), 4);
+  JsonW_Float(&w, "current", current, 4);
+  JsonW_Milli(&w, "kWh", bill.Energy_Wh);
+  JsonW_Milli(&w, "energyFee", bill.EnergyFee);
+  JsonW_Milli(&w, "parkFee", bill.ParkingFee);
+  JsonW_Float(&w, "temp", CurTemperature, 4);
+  JsonW_Bool(&w, "taper", taper.Tapering);
+  JsonW_Uint(&w, "remSec", taper.RemainSec);
+  JsonW_Uint(&w, "remWh", taper.RemainWh);
+  return sendJson(port, &w, "meter/read");
+}
+
+//non-resettable registers, day is the local midnight of the current day, 0 unknown
+int meterTotals(TSPort *port, const char *json, int tokenCount)
+{
+  TTotalsRec totals;
+  TJsonW w;
+  char month[8];
+
+  Totals_Get(&totals);
+  snprintf(month, sizeof(month), "%04d-%02d", 2000+totals.Month/12, totals.Month%12+1);
+  beginJson(port, &w, "meter/totals");
+  JsonW_Uint(&w, "time", LocalTime_Get());
+  JsonW_Milli(&w, "lifetime_kWh", totals.LifetimeWh);
+  JsonW_Uint(&w, "day", totals.Day? (totals.Day-1)*SECS_PER_DAY: 0);
+  JsonW_Milli(&w, "day_kWh", totals.DayWh);
+  JsonW_Milli(&w, "prevDay_kWh", totals.PrevDayWh);
+  JsonW_Str(&w, "month", month);
+  JsonW_Milli(&w, "month_kWh", totals.MonthWh);
+  JsonW_Milli(&w, "prevMonth_kWh", totals.PrevMonthWh);
+  return sendJson(port, &w, "meter/totals");
+}
+
+int statePoll(TSPort *port, const char *json, int tokenCount)
+{
+  int conn = connArg(json, tokenCount);
+  if (conn < 0)
+    return sendResult(port, "state/poll", -1);
+  switch(Trans_GetState(conn)) 
+  {
+    case trIdle:
+    case trHandshake:
+      return stateRead(port, json, tokenCount);
+    case trAuthen:
+      return ratesRead(port, json, tokenCount);
+    case trCharging:
+      return meterRead(port, json, tokenCount);
+    case trParking:
+    case trBilling:
+      return billRead(port, json, tokenCount);
+    case trPaid:
+      return billRead(port, json, tokenCount);
+  }
+  return 1;
+}
+
+int resetError(TSPort *port, const char *json, int tokenCount)
+{
+  osThreadFlagsSet(PilotThread_id, PILOT_RESET_ERROR);
+  return sendResult(port, "error/reset", 0);
+}
+
+//{"seq":%d, "amps":%d, "lease_s":%d}
+int capacityGrant(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {int32_t Seq, Amps, Lease;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Seq, "seq", argInt),
+    ARG(TArgs, Amps, "amps", argInt),
+    ARG(TArgs, Lease, "lease_s", argInt),
+  };
+  TArgs args = {-1, 0, 0};
+  parseArgs(json, tokenCount, desc, CountOf(desc), &args);
+  int ok = (args.Seq>=0) && (args.Amps>=0) && (args.Lease>=0) && 
+    Capacity_Grant(args.Seq, args.Amps>CHARGE_CURRENT_MAX? CHARGE_CURRENT_MAX: args.Amps, args.Lease);
+  return sendResult(port, "capacity/grant", ok? 0: -1);
+}
+
+int capacityRead(TSPort *port, const char *json, int tokenCount)
+{
+  const char *stateNames[] = {"idle", "reserving", "granted", "releasing"};
+  TCapBooking booking;
+  TJsonW w;
+  Capacity_GetBooking(&booking);
+  beginJson(port, &w, "capacity/read");
+  JsonW_Str(&w, "state", stateNames[booking.State]);
+  JsonW_Int(&w, "seq", booking.Seq);
+  JsonW_Int(&w, "req", booking.Requested);
+  JsonW_Int(&w, "granted", booking.Granted);
+  JsonW_Int(&w, "lease_s", booking.LeaseLeft);
+  JsonW_Int(&w, "reserved", CapacityReserved);
+  return sendJson(port, &w, "capacity/read");
+}
+
+//{"amps":%d, "ramp_Aps":%d}, amps -1 removes the limit, ramp_Aps 0 is the default.
+//Nothing is set if either is out of range.
+int setpointWrite(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {int32_t Amps, Ramp;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Amps, "amps", argInt),
+    ARG(TArgs, Ramp, "ramp_Aps", argInt),
+  };
+  TArgs args = {-1, 0};
+  uint32_t found = parseArgs(json, tokenCount, desc, CountOf(desc), &args);
+  if (!found || (found & ARG_BAD) || ((args.Amps != -1) && ((args.Amps < CHARGE_CURRENT_MIN) || (args.Amps > CHARGE_CURRENT_MAX))) ||
+    (args.Ramp < 0) || (args.Ramp > CHARGE_CURRENT_MAX))
+    return sendResult(port, "setpoint/write", -1);
+  if (found & 1)
+    Setpoint_Set(spRemote, args.Amps<0? SETPOINT_NONE: args.Amps);
+  if (found & 2)
+    Setpoint_SetRampRate(args.Ramp);
+  return sendResult(port, "setpoint/write", 0);
+}
+
+//{"from":%d}, entries are dumps of TTraceEntry, hex text in JSON
+int traceRead(TSPort *port, const char *json, int tokenCount)
+{
+  TTraceEntry entries[8];
+  static const TArgDesc desc[] = {{"from", 4, argUint, 0}};
+  uint32_t from = 0, next;
+  TJsonW w;
+  int n, fit;
+  
+  parseArgs(json, tokenCount, desc, CountOf(desc), &from);
+  next = Trace_Read(from, entries, CountOf(entries), &n);
+  from = next-n;
+  beginJson(port, &w, "trace/read");
+  JsonW_Uint(&w, "from", from);
+  JsonW_Uint(&w, "recCyc", Trace_GetMaxCycles());
+  fit = (w.Size-w.Len-(sizeof("\"data\":\"\",\"next\":4294967295}")+1))/(2*sizeof(TTraceEntry));
+  if (n > fit)
+    n = fit;
+  JsonW_Bytes(&w, "data", entries, n*sizeof(TTraceEntry));
+  JsonW_Uint(&w, "next", from+n);
+  return sendJson(port, &w, "trace/read");
+}
+
+int diagRead(TSPort *port, const char *json, int tokenCount)
+{
+  TLatencyStat edgeOff;
+  TJsonW w;
+  char pc[12];
+  uint32_t irqOffPc, irqOff = Trace_GetIrqOff(&irqOffPc);
+  Pilot_GetEdgeOffLatency(&edgeOff);
+  snprintf(pc, sizeof(pc), "%08x", irqOffPc);
+  beginJson(port, &w, "diag/read");
+  JsonW_Uint(&w, "edgeOffN", edgeOff.Count);
+  JsonW_Uint(&w, "edgeOffMinUs", edgeOff.MinUs);
+  JsonW_Uint(&w, "edgeOffAvgUs", edgeOff.Count? edgeOff.TotalUs/edgeOff.Count: 0);
+  JsonW_Uint(&w, "edgeOffMaxUs", edgeOff.MaxUs);
+  JsonW_Uint(&w, "traceCyc", Trace_GetMaxCycles());
+  JsonW_Uint(&w, "irqOffCyc", irqOff);
+  JsonW_Str(&w, "irqOffPc", pc);
+#ifdef IRQ_OFF_STATS
+  JsonW_Uint(&w, "dispatchCyc", DispatchMaxCyc);
+#endif
+  JsonW_Uint(&w, "cmdSeed", CmdSeed);
+  return sendJson(port, &w, "diag/read");
+}
+
+/* Links
+ *
+ * Replies go back on the port the request came in on. Pushes (capacity,
+ * telemetry) go on Link, the port the server last spoke on. When Link has
+ * heard nothing for LINK_SILENT_DLY the other port takes over, the GPRS
+ * modem is powered up the first time, a step per pass of the loop so the
+ * thread never waits on it, and a link/up push tells the server
+ * where to find the charger. A modem just powered up drops what it is given
+ * until it has attached, so link/up goes again every LINK_ANNOUNCE_DLY until
+ * a frame comes in on the new link. With both silent they take turns.
+ */
+
+static TSPort *Link = &WiFiPort;
+static struct {
+  uint8_t Step; //TGprsStep done last, gprsResetOff once up
+  uint32_t Tick; //it was done
+} Gprs;
+static uint32_t Failovers;
+static struct {
+  uint8_t Pending; //link/up not answered yet
+  TSPort *Port; //it went to
+  uint32_t RxFrames; //of Port when it took over
+  uint32_t Tick; //of the last link/up sent
+} Announce;
+
+static const char* linkName(const TSPort *link)
+{
+  return (link==&GprsPort)? "gprs": "wifi";
+}
+
+static void linkAnnounce(void)
+{
+  TJsonW w;
+  int len;
+
+  if ((Link != Announce.Port) || (Link->RxFrames != Announce.RxFrames))
+    Announce.Pending = 0; //the server has spoken since
+  if (!Announce.Pending || (Link->TxSize!=0) || (osKernelGetTickCount()-Announce.Tick < LINK_ANNOUNCE_DLY))
+    return;
+  Announce.Tick = osKernelGetTickCount();
+  beginJson(Link, &w, "link/up");
+  JsonW_Str(&w, "link", linkName(Link));
+  len = JsonW_End(&w);
+  if (len > 0)
+    Send(Link, len);
+}
+
+//the next power-up step once the last one has settled
+static void gprsPowerTick(void)
+{
+  if ((Gprs.Step==gprsOff) || (Gprs.Step==gprsResetOff) ||
+    (osKernelGetTickCount()-Gprs.Tick < ((Gprs.Step==gprsPowerOn)? GPRS_POWER_DLY: GPRS_RESET_DLY)))
+    return;
+  Gprs.Step++;
+  Gprs.Tick = osKernelGetTickCount();
+  GPRS_PowerStep((TGprsStep)Gprs.Step);
+}
+
+static void linkTick(void)
+{
+  TSPort *next = (Link==&WiFiPort)? &GprsPort: &WiFiPort;
+
+  gprsPowerTick();
+  if (osKernelGetTickCount()-Link->LastRxTick >= LINK_SILENT_DLY)
+  {
+    if ((next==&GprsPort) && (Gprs.Step==gprsOff))
+    {
+      Gprs.Step = gprsPowerOn;
+      Gprs.Tick = osKernelGetTickCount();
+      GPRS_PowerStep(gprsPowerOn);
+      USART_Cmd(GPRS_UART, ENABLE); //what goes out before the modem attached is lost, link/up is repeated
+    }
+    Link = next;
+    Link->LastRxTick = osKernelGetTickCount(); //its silence counts from now
+    Failovers++;
+    Announce.Pending = 1;
+    Announce.Port = Link;
+    Announce.RxFrames = Link->RxFrames;
+    Announce.Tick = Link->LastRxTick-LINK_ANNOUNCE_DLY; //first one now
+  }
+  linkAnnounce();
+}
+
+//{"link":"wifi"|"gprs"}, the port asking when there is none
+//{"link":"%s","active":"%s","failovers":%u,"rxFrames":%u,"txFrames":%u,
+// "rxDrops":%u,"rxOverruns":%u,"silent_s":%u}
+int linkRead(TSPort *port, const char *json, int tokenCount)
+{
+  const TSPort *link = port;
+  TJsonW w;
+  int i;
+
+  for (i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+    if (jsoneq(json, &tokens[i], "link")==0)
+      link = (jsoneq(json, &tokens[i+1], "gprs")==0)? &GprsPort: &WiFiPort;
+  beginJson(port, &w, "link/read");
+  JsonW_Str(&w, "link", linkName(link));
+  JsonW_Str(&w, "active", linkName(Link));
+  JsonW_Uint(&w, "failovers", Failovers);
+  JsonW_Uint(&w, "rxFrames", link->RxFrames);
+  JsonW_Uint(&w, "txFrames", link->TxFrames);
+  JsonW_Uint(&w, "rxDrops", link->RxDrops);
+  JsonW_Uint(&w, "rxOverruns", link->RxOverruns);
+  JsonW_Uint(&w, "silent_s", (osKernelGetTickCount()-link->LastRxTick)/MsToOSTicks(1000));
+  return sendJson(port, &w, "link/read");
+}
+
+//reserve, renew or release sent asynchronously when the link is idle
+static void capacitySendPending(TSPort *port)
+{
+  TCapMsg msg;
+  if ((port->TxSize!=0) || !Capacity_PeekPending(&msg))
+    return;
+  TJsonW w;
+  int len;
+  beginJson(port, &w, msg.Amps? "capacity/reserve": "capacity/release");
+  JsonW_Int(&w, "seq", msg.Seq);
+  if (msg.Amps)
+    JsonW_Int(&w, "amps", msg.Amps);
+  len = JsonW_End(&w);
+  if ((len > 0) && Send(port, len))
+    Capacity_Sent(msg.Seq);
+}
+
+//changed fields pushed when the link is idle
+static void telemetrySendPending(TSPort *port)
+{
+  TTeleSample s;
+  TJsonW w;
+  uint8_t conn, fields;
+  int len;
+
+  if (port->TxSize!=0)
+    return;
+  fields = Telemetry_Peek(&conn, &s);
+  if (!fields)
+    return;
+  beginJson(port, &w, "telemetry");
+  JsonW_Int(&w, "conn", conn);
+  if (fields & TELE_STATE)
+  {
+    JsonW_Str(&w, "tState", Trans_GetStateName(conn));
+    if (conn == PILOT_CONN)
+      JsonW_Int(&w, "pilot", s.Pilot);
+  }
+  if ((fields & TELE_ERROR) && (conn == PILOT_CONN))
+  {
+    JsonW_Bool(&w, "panic", s.Errors & TELE_ERR_PANIC);
+    JsonW_Bool(&w, "hwError", s.Errors & TELE_ERR_HARDWARE);
+    JsonW_Bool(&w, "lidOpen", s.Errors & TELE_ERR_LID);
+  }
+  if ((fields & TELE_CURRENT) && (conn == PILOT_CONN))
+    JsonW_Milli(&w, "i(A)", s.Current_mA);
+  if (fields & TELE_ENERGY)
+    JsonW_Milli(&w, "kWh", s.Energy_Wh);
+  if ((fields & TELE_TEMP) && (conn == PILOT_CONN))
+    JsonW_Milli(&w, "temp", s.Temp_mC);
+  len = JsonW_End(&w);
+  if ((len > 0) && Send(port, len))
+    Telemetry_Sent(conn, fields, &s);
+}
+
+int telemetryRead(TSPort *port, const char *json, int tokenCount)
+{
+  const TTelemetry *tele = &Config.Public.Telemetry;
+  TJsonW w;
+  beginJson(port, &w, "telemetry/read");
+  JsonW_Uint(&w, "fields", tele->Fields);
+  JsonW_Uint(&w, "period_s", tele->PeriodSec);
+  JsonW_Uint(&w, "db_mA", tele->CurrentDb_mA);
+  JsonW_Uint(&w, "db_Wh", tele->EnergyDb_Wh);
+  JsonW_Uint(&w, "db_mC", tele->TempDb_mC);
+  return sendJson(port, &w, "telemetry/read");
+}
+
+//{"fields":%u, "period_s":%u, "db_mA":%u, "db_Wh":%u, "db_mC":%u}, fields is a
+//mask of 1 state, 2 errors, 4 current, 8 energy, 16 temp, 0 stops the pushes.
+//Keys left out are kept.
+int telemetryWrite(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {uint32_t Fields, PeriodSec, CurrentDb, EnergyDb, TempDb;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, Fields, "fields", argUint),
+    ARG(TArgs, PeriodSec, "period_s", argUint),
+    ARG(TArgs, CurrentDb, "db_mA", argUint),
+    ARG(TArgs, EnergyDb, "db_Wh", argUint),
+    ARG(TArgs, TempDb, "db_mC", argUint),
+  };
+  TTelemetry tele = Config.Public.Telemetry;
+  TArgs args = {tele.Fields, tele.PeriodSec, tele.CurrentDb_mA, tele.EnergyDb_Wh, tele.TempDb_mC};
+  int result = 0;
+
+  parseArgs(json, tokenCount, desc, CountOf(desc), &args);
+  if ((args.Fields > 0xFF) || (args.PeriodSec > 0xFF) || 
+    (args.CurrentDb > 0xFFFF) || (args.EnergyDb > 0xFFFF) || (args.TempDb > 0xFFFF))
+    result = -1;
+  else
+  {
+    tele.Fields = args.Fields;
+    tele.PeriodSec = args.PeriodSec;
+    tele.CurrentDb_mA = args.CurrentDb;
+    tele.EnergyDb_Wh = args.EnergyDb;
+    tele.TempDb_mC = args.TempDb;
+    if (!EEP_WriteBlk(EEP_TELEMETRY_ADDR, &tele, sizeof(tele), &Config.Public.Telemetry, RangeCheck_Telemetry))
+      result = -1;
+  }
+  return sendResult(port, "telemetry/write", result);
+}
+
+#ifdef COORDINATOR_EMULATION
+//{"siteA":%d} or {"id":%d, "amps":%d}
+int coordinatorWrite(TSPort *port, const char *json, int tokenCount)
+{
+  typedef struct {int32_t SiteA, Id, Amps;} TArgs;
+  static const TArgDesc desc[] = {
+    ARG(TArgs, SiteA, "siteA", argInt),
+    ARG(TArgs, Id, "id", argInt),
+    ARG(TArgs, Amps, "amps", argInt),
+  };
+  TArgs args = {0, -1, -1};
+  int ok = 0;
+  if (parseArgs(json, tokenCount, desc, CountOf(desc), &args) & 1)
+  {
+    Coordinator_SetSiteLimit(args.SiteA);
+    ok = 1;
+  }
+  if (args.Amps>=0)
+    ok = Coordinator_SetDemand(args.Id, args.Amps);
+  return sendResult(port, "coordinator/write", ok? 0: -1);
+}
+#endif
+
+#ifdef EMULATION_ENABLED
+//{"stateId":%d}
+int pilotStateWrite(TSPort *port, const char *json, int tokenCount)
+{
+  static const TArgDesc desc[] = {{"stateId", 7, argInt, 0}};
+  int32_t state = -1;
+  parseArgs(json, tokenCount, desc, CountOf(desc), &state);
+  if (state!=-1) 
+    SetVoltage((TVoltageLevel)state);
+  return sendResult(port, "pilotState/write", state!=-1? 0: -1);
+}
+
+int tempTestSet(TSPort *port, const char *json, int tokenCount)
+{
+  static const TArgDesc desc[] = {{"value", 5, argInt, 0}};
+  int32_t state = -1;
+  parseArgs(json, tokenCount, desc, CountOf(desc), &state);
+  if (state!=-1) 
+    SetTempTestPin(state);
+  return sendResult(port, "tempTest/set", state!=-1? 0: -1);
+}
+#endif
+
+static int dispatch(TSPort *port, const char *js, int tokenCount);
+
+//replies are packed as described at Batch
+int batchRun(TSPort *port, const char *json, int tokenCount)
+{
+  struct {uint16_t Start, End;} items[BATCH_CMDS];
+  int i, k, n = 0;
+
+  for (i=3; i+1<tokenCount; i=tokNext(i+1, tokenCount))
+  {
+    if ((jsoneq(json, &tokens[i], "cmds")!=0) || (tokens[i+1].type!=JSMN_ARRAY))
+      continue;
+    for (k=i+2; (k<tokenCount) && (tokens[k].start<tokens[i+1].end); k=tokNext(k, tokenCount))
+    {
+      if ((tokens[k].type!=JSMN_OBJECT) || (n>=BATCH_CMDS))
+        return sendResult(port, "batch", -1);
+      items[n].Start = tokens[k].start;
+      items[n++].End = tokens[k].end;
+    }
+  }
+  if (n == 0)
+    return sendResult(port, "batch", -1);
+  waitTxIdle(port);
+  Batch.Active = 1;
+  batchBegin(port);
+  for (k=0; k<n; k++) //each one parsed again into tokens on its own
+  {
+    jsmn_init(&jsparser);
+    dispatch(port, json+items[k].Start, 
+      jsmn_parse(&jsparser, json+items[k].Start, items[k].End-items[k].Start, tokens, RX_TOKENS));
+  }
+  Batch.Active = 0;
+  if (Batch.Count)
+  {
+    waitTxIdle(port);
+    memcpy(port->TxBuffer, Batch.Buf, Batch.Len);
+    batchClose(port, &port->TxBuffer[Batch.Len]);
+    transmit(port, Batch.Len+2);
+  }
+  return 1;
+}
+
+const TCommand Commands[] = 
+{
+  {"wifi/read", wifiRead},
+  {"config/read", configRead},
+  {"serUrl/read", serUrlRead},
+  {"dT/read", devTokenRead},
+  {"cT/read", cliTokenRead},
+  {"rates/read", ratesRead},
+  {"rates/write", ratesWrite},
+  {"tariff/read", tariffRead},
+  {"tariff/write", tariffWrite},
+  {"time/write", timeWrite},
+  {"schedule/read", scheduleRead},
+  {"schedule/write", scheduleWrite},
+  {"policy/read", policyRead},
+  {"policy/write", policyWrite},
+  {"state/read", stateRead},
+  {"trans/authen", transAuthen},
+  {"trans/stop", transStop},
+  {"bill/read", billRead},
+  {"bill/pay", billPay},
+  {"bills/sync", billsSync},
+  {"power/read", powerRead},
+  {"state/poll", statePoll},
+  {"meter/read", meterRead},
+  {"meter/totals", meterTotals},
+  {"error/reset", resetError},
+  {"capacity/grant", capacityGrant},
+  {"capacity/read", capacityRead},
+  {"setpoint/write", setpointWrite},
+  {"trace/read", traceRead},
+  {"diag/read", diagRead},
+  {"link/read", linkRead},
+  {"batch", batchRun},
+  {"telemetry/read", telemetryRead},
+  {"telemetry/write", telemetryWrite},
+#ifdef COORDINATOR_EMULATION
+  {"coordinator/write", coordinatorWrite},
+#endif
+#ifdef EMULATION_ENABLED
+  {"pilotState/write", pilotStateWrite},
+  {"tempTest/set", tempTestSet},
+#endif  
+};
+
+/* Command lookup
+ *
+ * Commands[] is hashed into CmdHash at start-up, with a seed searched so
+ * that no two names share a slot. A lookup is then one hash over the token
+ * and one compare, whatever the number of commands. Should no seed be
+ * found the table stays empty and the lookup scans Commands[] as before.
+ */
+#define CMD_HASH_SIZE       128   /* power of 2, twice the commands or more */
+#define CMD_SEED_TRIES      4096
+
+typedef char TCmdHashFits[(sizeof(Commands)/sizeof(Commands[0])*2 <= CMD_HASH_SIZE)? 1: -1];
+
+static uint8_t CmdHash[CMD_HASH_SIZE]; //index+1 into Commands[], 0 empty
+
+//FNV-1a from the seed, folded so the low bits see the whole name
+static uint32_t cmdHash(uint32_t seed, const char *s, int len)
+{
+  while (len--)
+    seed = (seed^(uint8_t)*s++)*16777619u;
+  return seed^(seed>>15);
+}
+
+static void buildCmdHash(void)
+{
+  int i, n = sizeof(Commands)/sizeof(Commands[0]);
+  uint32_t seed;
+
+  for (seed=1; seed<=CMD_SEED_TRIES; seed++)
+  {
+    memset(CmdHash, 0, sizeof(CmdHash));
+    for (i=0; i<n; i++)
+    {
+      uint8_t *slot = &CmdHash[cmdHash(seed, Commands[i].command, strlen(Commands[i].command)) & (CMD_HASH_SIZE-1)];
+      if (*slot)
+        break;
+      *slot = i+1;
+    }
+    if (i==n)
+    {
+      CmdSeed = seed;
+      return;
+    }
+  }
+  memset(CmdHash, 0, sizeof(CmdHash));
+}
+
+static const TCommand* findCommand(const char *json, jsmntok_t *tok)
+{
+  int i, len = tok->end - tok->start;
+  if (tok->type != JSMN_STRING)
+    return NULL;
+  if (CmdSeed)
+  {
+    i = CmdHash[cmdHash(CmdSeed, json+tok->start, len) & (CMD_HASH_SIZE-1)];
+    if (i && (strlen(Commands[i-1].command)==len) && (memcmp(json+tok->start, Commands[i-1].command, len)==0))
+      return &Commands[i-1];
+    return NULL;
+  }
+  for (i=0; i<sizeof(Commands)/sizeof(Commands[0]); i++)
+    if (jsoneq(json, tok, Commands[i].command)==0)
+      return &Commands[i];
+  return NULL;
+}
+
+//runs the command object in tokens, a batch does not nest
+static int dispatch(TSPort *port, const char *js, int tokenCount)
+{
+    /* Assume the top-level element is an object */
+  if (tokenCount < 3 || tokens[0].type != JSMN_OBJECT)
+    return 0;      
+  if (jsoneq(js, &tokens[1], "cmd") != 0) //first key must be "cmd"
+    return 0;
+#ifdef IRQ_OFF_STATS
+  uint32_t cyc = DWT->CYCCNT;
+#endif
+  const TCommand *cmd = findCommand(js, &tokens[2]);
+#ifdef IRQ_OFF_STATS
+  cyc = DWT->CYCCNT-cyc;
+  if (cyc > DispatchMaxCyc)
+    DispatchMaxCyc = cyc;
+#endif
+  if (!cmd || (Batch.Active && (cmd->action==batchRun)))
+    return 0;
+  cmd->action(port, js, tokenCount);
+  return 1;
+}
+
+//posted frames passed their CRC in SPort_RxIdle, a JSON one is usually
+//tokenised there too, into the port's tokens
+static void processFrame(TPacket *pkt)
+{
+  TSPort *port = pkt->Port;
+  char *js = (char*)pkt->payload;
+  int r = pkt->TokenCount;
+  port->RxFrames++;
+  port->LastRxTick = osKernelGetTickCount();
+  Link = port; //pushes follow the server
+  tokens = port->Tokens;
+  port->Cbor = CBOR_IS_MAP(pkt->payload[0]); //replies follow the request
+  if (port->Cbor)
+  {
+    js = CborText;
+    r = Cbor_ToJson(pkt->payload, pkt->len-4, js, sizeof(CborText), tokens, RX_TOKENS);
+  }
+  else
+  {
+    js[pkt->len-4] = 0; //remove crc bytes
+    if (r == 0)
+    {
+      jsmn_init(&jsparser);
+      r = jsmn_parse(&jsparser, js, pkt->len-4, tokens, RX_TOKENS);
+    }
+  }
+  if (r<0) //invalid request
+    return;
+  dispatch(port, js, r);
+}
+
+void dhThread(void *arg)
+{ 
+  TPacket *pkt;
+  osStatus_t osStatus;
+//  static uint32_t flags;
+
+  buildCmdHash();
+  SPortMsgQ = osMessageQueueNew(RX_FRAMES, sizeof(TPacket*), NULL);
+  RxPool = osMemoryPoolNew(RX_FRAMES, sizeof(TPacket), &RxPoolAttr);
+  while(!SPortMsgQ || !RxPool);
+  sportInit(&WiFiPort);
+  sportInit(&GprsPort);
+	USART_Cmd(WIFI_UART, ENABLE);
+  WiFi_Reset(); 	
+  while(1)
+  {		        
+    osStatus = osMessageQueueGet(SPortMsgQ, &pkt, NULL, DH_IDLE_DLY);
+    if (osStatus==osOK)
+    {
+      TSPort *port = pkt->Port;
+      processFrame(pkt);
+      osMemoryPoolFree(RxPool, pkt);
+      MASK_IRQ
+        port->RxQueued--; //its tokens free for the next frame
+      UNMASK_IRQ
+    }
+    linkTick();
+    capacitySendPending(Link);
+    Telemetry_Tick();
+    telemetrySendPending(Link);
+  }
+}
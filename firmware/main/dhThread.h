@@ -1,57 +1,88 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#ifndef __WIFI_THREAD_H__
-#define __WIFI_THREAD_H__
-
-#include <stdint.h>
-#include "cmsis_os2.h"
-#include "stm32f10x.h"
-
-#define PKT_PLAYLOAD_SIZE           264
-#define UART_BUF_SIZE						    (PKT_PLAYLOAD_SIZE+4)
-
-typedef struct 
-{
-  USART_TypeDef* Uart;
-  uint16_t TxSize, TxPos, RxPos;
-  uint8_t TxBuffer[UART_BUF_SIZE], RxBuffer[UART_BUF_SIZE];
-  uint64_t lastSentTickCount;
-} TSPort;
-
-typedef struct
-{
-  TSPort* Port;
-  uint16_t len;
-  uint8_t payload[UART_BUF_SIZE];
-} TPacket;
-
-extern const osThreadAttr_t dhThread_attr;
-extern TSPort WiFiPort;
-extern osMessageQueueId_t SPortMsgQ;
-
-void dhThread(void *arg);
-
-#endif
-
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __WIFI_THREAD_H__
+#define __WIFI_THREAD_H__
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+#include "stm32f10x.h"
+#include "jsmn.h"
+
+#define PKT_PLAYLOAD_SIZE           264
+#define UART_BUF_SIZE						    (PKT_PLAYLOAD_SIZE+4)
+#define BATCH_CMDS                  8   //commands in one batch frame
+#define UART_RX_RING                128 //DMA receive ring, drained at half and full
+#define RX_FRAMES                   3   //receive buffers shared by the ports
+#define RX_SPLITS                   3   //idle lines inside a frame tried as its start
+#define RX_TOKENS                   80  //jsmn tokens of a request
+
+typedef struct TPacket TPacket;
+
+typedef struct 
+{
+  USART_TypeDef* Uart;
+  DMA_Channel_TypeDef *RxDma, *TxDma;
+  TIM_TypeDef *GapTim; //ends a frame an idle line left incomplete
+  uint16_t TxSize;
+  uint16_t RxPos; //bytes of the frame so far, past the buffer too
+  uint16_t RxSplit[RX_SPLITS]; //where the bytes after each idle line start
+  uint8_t RxSplits;
+  uint16_t RingPos; //next byte of Ring to move to Rx
+  uint16_t RxCrcPos; //bytes of Rx in RxCrc, and fed to RxParser
+  uint32_t RxCrc; //running, 4 bytes behind as the last 4 may be the CRC
+  jsmn_parser RxParser; //tokenises a JSON frame into Tokens as it arrives
+  jsmntok_t Tokens[RX_TOKENS]; //of the port's oldest frame not yet dispatched
+  __IO uint8_t RxQueued; //frames posted and not yet dispatched, while any Tokens is theirs
+  uint8_t Cbor; //replies in CBOR, as the last request was
+  TPacket *Rx; //frame being received, NULL between frames or none free
+  uint32_t RxFrames, TxFrames;
+  uint32_t RxDrops; //frames lost for want of a buffer
+  uint32_t RxOverruns; //frames longer than a buffer
+  uint32_t LastRxTick; //kernel tick of the last frame from the server
+  uint8_t Ring[UART_RX_RING];
+  uint8_t TxBuffer[UART_BUF_SIZE];
+  uint64_t lastSentTickCount;
+} TSPort;
+
+struct TPacket
+{
+  TSPort* Port;
+  uint16_t len;
+  int16_t TokenCount; //in Port->Tokens on receive, JSMN_ERROR_xxx, 0 left to dhThread
+  uint8_t payload[UART_BUF_SIZE];
+};
+
+extern const osThreadAttr_t dhThread_attr;
+extern TSPort WiFiPort, GprsPort;
+extern osMessageQueueId_t SPortMsgQ;
+
+void dhThread(void *arg);
+void SPort_RxDrain(TSPort *port);
+void SPort_RxIdle(TSPort *port);
+void SPort_RxGap(TSPort *port);
+void SPort_TxDone(TSPort *port);
+
+#endif
+
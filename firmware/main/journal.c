@@ -0,0 +1,285 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#include <string.h>
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "hal.h"
+#include "app_main.h"
+#include "crc32.h"
+#include "trans.h"
+#include "trace.h"
+#include "ledger.h"
+#include "journal.h"
+
+/* Session journal
+ *
+ * A ring of JOURNAL_SLOTS records in EEPROM, two 24C64 pages each.
+ * Records are never updated in place: the next one goes to the slot after
+ * the newest, so a write torn by a power cut, in either page, only loses
+ * itself and the record before it is still valid. Every record carries the
+ * whole session (payer, start time, meter reading and its split by tariff
+ * class), replay only needs the newest one and the ring may wrap during a
+ * long session.
+ * Written from the app_main loop, never from the billing path.
+ *
+ * Connectors share the ring, the connector is in the high nibble of Flags
+ * and replay takes the newest record of each. A slot holding the newest
+ * record of another open session is skipped so it is never overwritten.
+ */
+
+typedef char TJournalRecFits[(sizeof(TJournalRec)%EEP_PAGE_SIZE==0)? 1: -1];
+typedef char TJournalRingFits[(EEP_JOURNAL_ADDR+JOURNAL_SLOTS*sizeof(TJournalRec) <= EEP_LEDGER_ACK_ADDR)? 1: -1];
+typedef char TJournalConnFits[(CONNECTORS <= (JR_CONN_MASK>>JR_CONN_SHIFT)+1)? 1: -1];
+typedef char TJournalGroupFits[(POLICY_GROUPS <= (0xFF>>JR_GROUP_SHIFT)+1)? 1: -1];
+
+extern TI2C I2C2Port;
+
+static struct
+{
+  uint32_t Seq; //of the newest record
+  uint8_t Slot; //where the next record goes
+} Jr;
+
+static struct
+{
+  uint8_t Open; //session started and not ended yet
+  uint8_t Slot; //of its newest record
+  uint16_t Session;
+  TTransState State;
+  uint32_t ChargingSec, ParkingMin, Energy_Wh; //as last written
+  uint32_t Tick; //kernel tick of the last record
+} Cn[CONNECTORS];
+
+static uint16_t slotAddr(uint8_t slot)
+{
+  return EEP_JOURNAL_ADDR + slot*sizeof(TJournalRec);
+}
+
+//the newest record of another open session
+static int slotHeld(uint8_t slot, uint8_t conn)
+{
+  uint8_t c;
+  for (c=0; c<CONNECTORS; c++)
+    if ((c != conn) && Cn[c].Open && (Cn[c].Slot == slot))
+      return 1;
+  return 0;
+}
+
+static int readRec(uint8_t slot, TJournalRec *rec)
+{
+  int i;
+  for (i=0; i<3; i++)
+  {
+    if (!EEPRead(&I2C2Port, slotAddr(slot), rec, sizeof(*rec)))
+      continue;
+    return ValidateCrc32Blk(rec, sizeof(*rec)) && ((rec->Type&JR_TYPE_MASK)>=jrStart) && ((rec->Type&JR_TYPE_MASK)<=jrEnd);
+  }
+  return 0;
+}
+
+//on failure nothing moves, the same record is tried again on the next tick
+static void writeRec(uint8_t conn, TJournalType type, const TTransSession *session, const TBill *bill)
+{
+  TJournalRec rec, chk;
+  while (slotHeld(Jr.Slot, conn))
+    Jr.Slot = (Jr.Slot+1)%JOURNAL_SLOTS;
+  memset(&rec, 0, sizeof(rec));
+  rec.Seq = Jr.Seq+1;
+  rec.Type = type|(session->Group<<JR_GROUP_SHIFT);
+  rec.Flags = (conn<<JR_CONN_SHIFT)|(session->IsPayByRFIDCard? JR_PAY_BY_CARD: 0)|(session->IsFreeCard? JR_FREE_CARD: 0);
+  memcpy(rec.CardSn, session->CardSn, sizeof(rec.CardSn));
+  rec.Credit = session->Credit;
+  rec.ChargingSec = bill->ChargingSec;
+  rec.Energy_Wh = bill->Energy_Wh;
+  rec.EnergyFee = bill->EnergyFee;
+  rec.ParkingMin = bill->ParkingMin;
+  rec.StartTime = session->StartTime;
+  memcpy(rec.ClassWh, bill->ClassWh, sizeof(rec.ClassWh));
+  CalcCrc32Blk(&rec, sizeof(rec));
+  if (!EEPWrite(&I2C2Port, slotAddr(Jr.Slot), &rec, sizeof(rec)))
+    return;
+  if (!readRec(Jr.Slot, &chk) || memcmp(&rec, &chk, sizeof(rec)))
+    return;
+  Jr.Seq = rec.Seq;
+  Cn[conn].Slot = Jr.Slot;
+  Jr.Slot = (Jr.Slot+1)%JOURNAL_SLOTS;
+  Cn[conn].Open = type!=jrEnd;
+  Cn[conn].Session = session->Session;
+  Cn[conn].State = session->State;
+  Cn[conn].ChargingSec = bill->ChargingSec;
+  Cn[conn].ParkingMin = bill->ParkingMin;
+  Cn[conn].Energy_Wh = bill->Energy_Wh;
+  Cn[conn].Tick = osKernelGetTickCount();
+  Trace_Record(teJournal, conn<<4|type);
+}
+
+//finds the newest record of each connector, a session it leaves open is
+//restored into billing
+void Journal_Replay(void)
+{
+  TJournalRec rec, last[CONNECTORS];
+  TTransSession session;
+  TBill bill;
+  uint8_t slot, conn, found = 0, lastSlot[CONNECTORS], seen[CONNECTORS];
+
+  memset(seen, 0, sizeof(seen));
+
+  for (slot=0; slot<JOURNAL_SLOTS; slot++)
+  {
+    if (!readRec(slot, &rec))
+      continue;
+    if (!found || (rec.Seq > Jr.Seq))
+    {
+      Jr.Seq = rec.Seq;
+      Jr.Slot = (slot+1)%JOURNAL_SLOTS;
+    }
+    found = 1;
+    conn = rec.Flags>>JR_CONN_SHIFT;
+    if (conn >= CONNECTORS)
+      continue;
+    if (!seen[conn] || (rec.Seq > last[conn].Seq))
+    {
+      last[conn] = rec;
+      lastSlot[conn] = slot;
+    }
+    seen[conn] = 1;
+  }
+  //bill serials are end record sequences and must keep rising over a blank
+  //or corrupt ring, only a session pushed just before its end record was cut
+  //may already have Jr.Seq+1
+  if (!found || (Ledger_GetNewest() > Jr.Seq+1))
+    Jr.Seq = Ledger_GetNewest();
+  for (conn=0; conn<CONNECTORS; conn++)
+  {
+    if (!seen[conn] || ((last[conn].Type&JR_TYPE_MASK) == jrEnd))
+      continue;
+    memset(&session, 0, sizeof(session));
+    session.Session = 1;
+    memcpy(session.CardSn, last[conn].CardSn, sizeof(session.CardSn));
+    session.Credit = last[conn].Credit;
+    session.IsPayByRFIDCard = (last[conn].Flags & JR_PAY_BY_CARD)!=0;
+    session.IsFreeCard = (last[conn].Flags & JR_FREE_CARD)!=0;
+    session.Group = last[conn].Type>>JR_GROUP_SHIFT;
+    session.StartTime = last[conn].StartTime;
+    memset(&bill, 0, sizeof(bill));
+    bill.ChargingSec = last[conn].ChargingSec;
+    bill.ParkingMin = last[conn].ParkingMin;
+    bill.Energy_Wh = last[conn].Energy_Wh;
+    bill.EnergyFee = last[conn].EnergyFee;
+    memcpy(bill.ClassWh, last[conn].ClassWh, sizeof(bill.ClassWh));
+    Trans_Restore(conn, &session, &bill);
+    Cn[conn].Open = 1;
+    Cn[conn].Slot = lastSlot[conn];
+    Cn[conn].Session = session.Session;
+    Cn[conn].State = trBilling;
+    Cn[conn].ChargingSec = last[conn].ChargingSec;
+    Cn[conn].ParkingMin = last[conn].ParkingMin;
+    Cn[conn].Energy_Wh = last[conn].Energy_Wh;
+    Cn[conn].Tick = osKernelGetTickCount();
+    Trace_Record(teJournal, conn<<4);
+  }
+}
+
+//the paid session goes to the ledger before its end record, a cut in
+//between replays the session and it is pushed again under the same serial
+static void endSession(uint8_t conn)
+{
+  TTransDone done;
+  TTransSession session;
+  TLedgerRec rec;
+
+  Trans_GetDone(conn, &done);
+  memset(&session, 0, sizeof(session));
+  session.Session = Cn[conn].Session;
+  session.State = trPaid;
+  if (done.Session == Cn[conn].Session)
+  {
+    memset(&rec, 0, sizeof(rec));
+    rec.Serial = Jr.Seq+1; //of the end record
+    rec.StartTime = done.StartTime;
+    rec.EndTime = done.EndTime;
+    memcpy(rec.CardSn, done.CardSn, sizeof(rec.CardSn));
+    rec.ChargingSec = done.Bill.ChargingSec;
+    rec.ParkingMin = done.Bill.ParkingMin;
+    rec.Flags = (done.Group<<LEDGER_GROUP_SHIFT)|(done.Bill.IsPayByRFIDCard? LEDGER_PAY_BY_CARD: 0)|(done.IsFreeCard? LEDGER_FREE_CARD: 0);
+    rec.Connector = conn;
+    rec.Energy_Wh = done.Bill.Energy_Wh;
+    memcpy(rec.ClassWh, done.Bill.ClassWh, sizeof(rec.ClassWh));
+    rec.EnergyFee = done.Bill.EnergyFee;
+    rec.ParkingFee = done.Bill.ParkingFee;
+    rec.ParkPenalty = done.Bill.ParkPenalty;
+    rec.PaidAmount = done.Bill.PaidAmount;
+    if (!Ledger_Push(&rec))
+      return;
+    memcpy(session.CardSn, done.CardSn, sizeof(session.CardSn));
+    session.IsPayByRFIDCard = done.Bill.IsPayByRFIDCard;
+    session.IsFreeCard = done.IsFreeCard;
+    session.Group = done.Group;
+    session.StartTime = done.StartTime;
+  }
+  else
+    memset(&done.Bill, 0, sizeof(done.Bill));
+  writeRec(conn, jrEnd, &session, &done.Bill);
+}
+
+//start, state changes and periodic meter checkpoints while a session is
+//metered, end once it is paid
+static void tickConn(uint8_t conn)
+{
+  TTransSession session;
+  TBill bill;
+  TJournalType type;
+  uint8_t metered;
+
+  Trans_GetSession(conn, &session);
+  Trans_GetBill(conn, &bill);
+  metered = (session.State==trCharging)||(session.State==trParking)||(session.State==trBilling);
+  if (Cn[conn].Open && (!metered || (session.Session!=Cn[conn].Session))) //paid, or paid and the next one started
+  {
+    endSession(conn);
+    return;
+  }
+  if (!metered)
+    return;
+  if (!Cn[conn].Open)
+    type = jrStart;
+  else if (session.State != Cn[conn].State)
+    type = jrCheckpoint;
+  else if (((bill.Energy_Wh!=Cn[conn].Energy_Wh)||(bill.ChargingSec!=Cn[conn].ChargingSec)||(bill.ParkingMin!=Cn[conn].ParkingMin)) &&
+    ((session.State==trBilling)||(osKernelGetTickCount()-Cn[conn].Tick >= MsToOSTicks(JOURNAL_CHECKPOINT_SEC*1000))))
+    type = jrCheckpoint;
+  else
+    return;
+  writeRec(conn, type, &session, &bill);
+}
+
+//polled from the app_main loop
+void Journal_Tick(void)
+{
+  uint8_t conn;
+  for (conn=0; conn<CONNECTORS; conn++)
+    tickConn(conn);
+}
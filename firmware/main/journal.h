@@ -0,0 +1,66 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stdint.h>
+#include "i2c_hw.h"
+#include "RFID_Card.h"
+
+#define JOURNAL_SLOTS               16  //ring of two-page records
+#define JOURNAL_CHECKPOINT_SEC      30  //meter checkpoint interval while metering
+
+#define JR_PAY_BY_CARD              0x01
+#define JR_FREE_CARD                0x02
+#define JR_CONN_SHIFT               4     //connector in the high nibble of Flags
+#define JR_CONN_MASK                0xF0
+#define JR_TYPE_MASK                0x0F  //TJournalType in the low nibble of Type
+#define JR_GROUP_SHIFT              4     //card group in the high nibble of Type
+
+typedef enum {jrStart=1, jrCheckpoint, jrEnd} TJournalType;
+
+//two EEPROM pages, each record is complete on its own so the newest valid
+//one is all a replay needs. CRC32 over both so a torn write is not taken as valid.
+typedef struct
+{
+  uint32_t Seq; //newest record has the highest
+  uint8_t Type; //TJournalType, card group above JR_GROUP_SHIFT
+  uint8_t Flags; //JR_xxx, connector in JR_CONN_MASK
+  uint16_t ParkingMin;
+  TCardSn CardSn;
+  TMilli Credit;
+  uint32_t ChargingSec;
+  uint32_t Energy_Wh;
+  TMilli EnergyFee;
+  uint32_t StartTime; //local seconds, 0 unknown
+  uint32_t ClassWh[TARIFF_CLASSES];
+  uint8_t Spare[12];
+  uint32_t Crc;
+} TJournalRec;
+
+void Journal_Replay(void);
+void Journal_Tick(void);
+
+#endif
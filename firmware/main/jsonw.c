@@ -0,0 +1,289 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <string.h>
+#include "jsonw.h"
+
+/* Streaming JSON writer
+ *
+ * Replies used to be built by snprintf with %f conversions, on the soft
+ * float M3 each one pulls the full float formatter in and costs thousands
+ * of cycles. Here numbers are integers or fixed-point, written digit by
+ * digit from the end of a small scratch, and every write is length checked.
+ *
+ * The same calls write CBOR for clients that asked for it: objects and
+ * arrays of indefinite length so nothing is counted ahead, keys as text,
+ * fixed-point as a decimal fraction (tag 4) and bytes as a byte string.
+ */
+
+#define CBOR_UINT           0x00
+#define CBOR_NEGINT         0x20
+#define CBOR_BYTES          0x40
+#define CBOR_TEXT           0x60
+#define CBOR_DECIMAL        0xC4  //tag 4 [exponent, mantissa]
+#define CBOR_PAIR           0x82  //array of 2
+#define CBOR_FALSE          0xF4
+#define CBOR_TRUE           0xF5
+#define CBOR_ARRAY_START    0x9F
+#define CBOR_MAP_START      0xBF
+#define CBOR_BREAK          0xFF
+
+static void put(TJsonW *w, const char *s, int len)
+{
+  if (w->Overflow || (w->Len+len >= w->Size))
+  {
+    w->Overflow = 1;
+    return;
+  }
+  memcpy(&w->Buf[w->Len], s, len);
+  w->Len += len;
+}
+
+//major type and its argument in the shortest form
+static void head(TJsonW *w, uint8_t major, uint32_t v)
+{
+  char s[5];
+  if (v < 24)
+  {
+    s[0] = major|v;
+    put(w, s, 1);
+  }
+  else if (v <= 0xFF)
+  {
+    s[0] = major|24;
+    s[1] = v;
+    put(w, s, 2);
+  }
+  else if (v <= 0xFFFF)
+  {
+    s[0] = major|25;
+    s[1] = v>>8;
+    s[2] = v;
+    put(w, s, 3);
+  }
+  else
+  {
+    s[0] = major|26;
+    s[1] = v>>24;
+    s[2] = v>>16;
+    s[3] = v>>8;
+    s[4] = v;
+    put(w, s, 5);
+  }
+}
+
+static void putKey(TJsonW *w, const char *key)
+{
+  char s[2+32+2];
+  int len = 0, n;
+  if (w->Cbor)
+  {
+    if (key)
+    {
+      head(w, CBOR_TEXT, strlen(key));
+      put(w, key, strlen(key));
+    }
+    return;
+  }
+  if (w->Comma)
+    s[len++] = ',';
+  w->Comma = 1;
+  if (!key)
+  {
+    put(w, s, len);
+    return;
+  }
+  n = strlen(key);
+  if (n > sizeof(s)-4)
+  {
+    w->Overflow = 1;
+    return;
+  }
+  s[len++] = '"';
+  memcpy(&s[len], key, n);
+  len += n;
+  s[len++] = '"';
+  s[len++] = ':';
+  put(w, s, len);
+}
+
+//decimal digits of v ending at end, a point inserted before the last decimals
+static char* digits(char *end, uint32_t v, uint8_t decimals)
+{
+  char *p = end;
+  do
+  {
+    *--p = '0' + v%10;
+    v /= 10;
+    if (decimals && (--decimals == 0))
+    {
+      *--p = '.';
+      if (v == 0)
+        *--p = '0';
+    }
+  } while (v || decimals);
+  return p;
+}
+
+static void number(TJsonW *w, const char *k, uint32_t mag, int neg, uint8_t decimals)
+{
+  char s[16], *p;
+  if (decimals > 9)
+    decimals = 9;
+  putKey(w, k);
+  if (w->Cbor)
+  {
+    if (decimals)
+    {
+      s[0] = CBOR_DECIMAL;
+      s[1] = CBOR_PAIR;
+      s[2] = CBOR_NEGINT|(decimals-1);
+      put(w, s, 3);
+    }
+    if (neg && mag)
+      head(w, CBOR_NEGINT, mag-1);
+    else
+      head(w, CBOR_UINT, mag);
+    return;
+  }
+  p = digits(&s[sizeof(s)], mag, decimals);
+  if (neg)
+    *--p = '-';
+  put(w, p, &s[sizeof(s)]-p);
+}
+
+void JsonW_Begin(TJsonW *w, char *buf, int size, int cbor)
+{
+  w->Buf = buf;
+  w->Size = size;
+  w->Len = 0;
+  w->Comma = 0;
+  w->Overflow = 0;
+  w->Cbor = cbor;
+  JsonW_Open(w, NULL, '{');
+}
+
+void JsonW_Str(TJsonW *w, const char *k, const char *s)
+{
+  int n = strlen(s);
+  putKey(w, k);
+  if (w->Cbor)
+  {
+    head(w, CBOR_TEXT, n);
+    put(w, s, n);
+    return;
+  }
+  put(w, "\"", 1);
+  put(w, s, n);
+  put(w, "\"", 1);
+}
+
+void JsonW_Int(TJsonW *w, const char *key, int32_t v)
+{
+  number(w, key, v<0? -(uint32_t)v: v, v<0, 0);
+}
+
+void JsonW_Uint(TJsonW *w, const char *key, uint32_t v)
+{
+  number(w, key, v, 0, 0);
+}
+
+void JsonW_Fixed(TJsonW *w, const char *key, int32_t v, uint8_t decimals)
+{
+  number(w, key, v<0? -(uint32_t)v: v, v<0, decimals);
+}
+
+void JsonW_Float(TJsonW *w, const char *key, float v, uint8_t decimals)
+{
+  float scale = 1;
+  uint8_t i;
+  for (i=0; i<decimals; i++)
+    scale *= 10;
+  v *= scale;
+  number(w, key, (uint32_t)((v<0? -v: v)+0.5f), v<=-0.5f, decimals);
+}
+
+void JsonW_Bool(TJsonW *w, const char *k, int v)
+{
+  putKey(w, k);
+  if (w->Cbor)
+  {
+    char c = v? CBOR_TRUE: CBOR_FALSE;
+    put(w, &c, 1);
+  }
+  else if (v)
+    put(w, "true", 4);
+  else
+    put(w, "false", 5);
+}
+
+void JsonW_Bytes(TJsonW *w, const char *k, const void *b, int n)
+{
+  const char hex[] = "0123456789abcdef";
+  const uint8_t *p = b;
+  char s[2];
+  putKey(w, k);
+  if (w->Cbor)
+  {
+    head(w, CBOR_BYTES, n);
+    put(w, b, n);
+    return;
+  }
+  put(w, "\"", 1);
+  for (; n>0; n--, p++)
+  {
+    s[0] = hex[*p>>4];
+    s[1] = hex[*p&0x0F];
+    put(w, s, 2);
+  }
+  put(w, "\"", 1);
+}
+
+void JsonW_Open(TJsonW *w, const char *k, char bracket)
+{
+  putKey(w, k);
+  if (w->Cbor)
+    bracket = bracket=='['? CBOR_ARRAY_START: CBOR_MAP_START;
+  put(w, &bracket, 1);
+  w->Comma = 0;
+}
+
+void JsonW_Close(TJsonW *w, char bracket)
+{
+  if (w->Cbor)
+    bracket = CBOR_BREAK;
+  put(w, &bracket, 1);
+  w->Comma = 1;
+}
+
+int JsonW_End(TJsonW *w)
+{
+  JsonW_Close(w, '}');
+  if (w->Overflow)
+    return -1;
+  w->Buf[w->Len] = 0;
+  return w->Len;
+}
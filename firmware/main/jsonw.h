@@ -0,0 +1,60 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#ifndef __JSONW_H__
+#define __JSONW_H__
+
+#include <stdint.h>
+
+//a JSON or CBOR object written straight into a caller's buffer, no
+//allocation and no printf. A value that does not fit sets Overflow and
+//nothing after it is written, JsonW_End then fails instead of sending a
+//truncated reply.
+typedef struct
+{
+  char *Buf;
+  uint16_t Size; //of Buf, the terminator included
+  uint16_t Len;
+  uint8_t Comma; //a value precedes, the next one needs a separator
+  uint8_t Overflow;
+  uint8_t Cbor; //RFC 7049 instead of JSON text
+} TJsonW;
+
+//key is NULL for an array element
+void JsonW_Begin(TJsonW *w, char *buf, int size, int cbor);
+void JsonW_Str(TJsonW *w, const char *key, const char *s); //s is not escaped
+void JsonW_Int(TJsonW *w, const char *key, int32_t v);
+void JsonW_Uint(TJsonW *w, const char *key, uint32_t v);
+void JsonW_Fixed(TJsonW *w, const char *key, int32_t v, uint8_t decimals); //v in 1/10^decimals units
+void JsonW_Float(TJsonW *w, const char *key, float v, uint8_t decimals); //rounded to fixed, |v| below 2^31/10^decimals
+void JsonW_Bool(TJsonW *w, const char *key, int v);
+void JsonW_Bytes(TJsonW *w, const char *key, const void *b, int n); //hex text in JSON
+void JsonW_Open(TJsonW *w, const char *key, char bracket); //'[' or '{'
+void JsonW_Close(TJsonW *w, char bracket); //']' or '}'
+int JsonW_End(TJsonW *w); //closes the object, the length or -1 on overflow
+
+#define JsonW_Milli(w, key, v)    JsonW_Fixed(w, key, v, 3)
+
+#endif
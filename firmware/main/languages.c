@@ -1,197 +1,197 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#include "languages.h"
-
-const unsigned char FontGB12[][18] =
-{
-  {0x00,0x02,0x46,0x4A,0x50,0xE0,0x50,0x4A,0x46,0x02,0x00,0x00,0x00,0x00,0x74,0x04,0x00,0x00}, /*  */
-  {0x88,0x88,0xFF,0x48,0x2C,0xA4,0x75,0x26,0x24,0xE4,0x2C,0x00,0x88,0x0F,0x98,0x25,0x85,0x08}, /*  */
-  {0x88,0x88,0xFF,0x48,0x08,0x08,0xFF,0x28,0x28,0x29,0xEA,0x00,0x88,0x4F,0x92,0x58,0x52,0x08}, /*  */
-  {0x88,0x88,0xFF,0x48,0xFE,0x22,0x22,0x3E,0x22,0x22,0x3E,0x00,0x88,0x0F,0x87,0x88,0x88,0x0E}, /*  */
-  {0xFE,0x02,0xF2,0x02,0xFE,0x20,0x18,0x67,0x84,0x7C,0x04,0x00,0x68,0x21,0x84,0x24,0x21,0x0C}, /*  */
-  {0x44,0x25,0xF6,0x4C,0xA0,0xFC,0xA4,0x24,0x3F,0x24,0xEC,0x00,0x00,0x8F,0xB4,0x58,0x52,0x08}, /*  */
-  {0x08,0x91,0x42,0x00,0xFC,0x44,0x46,0x45,0x44,0xFC,0x00,0x00,0xF1,0x00,0x8F,0x88,0xF8,0x00}, /*  */
-  {0x02,0x82,0x42,0x22,0x12,0xFA,0x06,0x12,0x22,0x42,0x82,0x00,0x01,0x00,0xF0,0x00,0x00,0x00}, /*  */
-  {0x88,0x88,0xFF,0x48,0xC0,0x2A,0x0A,0xFE,0x09,0x29,0xE8,0x00,0x88,0x0F,0x9F,0xF8,0x98,0x0F}, /*  */
-  {0xD4,0x14,0xFF,0x94,0x94,0x20,0xD2,0x4E,0x42,0x52,0xDE,0x00,0x2F,0x47,0x88,0xAB,0xAA,0x0B}, /*  */
-  {0x04,0x64,0x54,0x4C,0x46,0xF5,0x44,0x44,0x44,0x44,0x04,0x00,0x22,0x22,0xF2,0x22,0x22,0x02}, /*  */
-  {0x04,0x44,0x64,0xD4,0x4D,0x46,0xC4,0x44,0x64,0x44,0x04,0x00,0x88,0x34,0x00,0x87,0x88,0x0E}, /*  */
-  {0x80,0x3C,0x20,0x20,0x20,0xFF,0x20,0x20,0x20,0x3C,0x80,0x00,0x8F,0x88,0xF8,0x88,0x88,0x0F}, /*  */
-  {0xFF,0x09,0x15,0xE3,0x48,0x54,0x52,0xF1,0x52,0x54,0x48,0x00,0x1F,0x52,0x12,0xF8,0x21,0x04}, /*  */
-  {0x08,0xF4,0x12,0x11,0x12,0xF4,0x08,0x00,0xFC,0x00,0xFF,0x00,0x70,0x98,0x89,0x0E,0x88,0x0F}, /*  */
-  {0x58,0x57,0xF4,0x54,0x20,0xA4,0xBF,0xA4,0xBF,0xA4,0x20,0x00,0x00,0x4F,0xF0,0xAA,0xFA,0x00}, /*  */
-  {0x88,0x88,0xFF,0x48,0x02,0x02,0x02,0xFE,0x02,0x02,0x02,0x00,0x88,0x0F,0x80,0xF8,0x00,0x00}, /*  */
-  {0x00,0xFC,0x24,0x24,0x24,0xFF,0x24,0x24,0x24,0xFC,0x00,0x00,0x10,0x11,0x71,0x99,0x99,0x0C}, /*  */
-  {0x1C,0x04,0xD4,0x14,0x14,0xF5,0x96,0x94,0x94,0x04,0x0C,0x00,0x48,0x43,0xF8,0x88,0x88,0x08}, /*  */
-  {0x12,0xF4,0x00,0x48,0x9A,0x2A,0x0F,0xEA,0x0A,0x2A,0x18,0x00,0xF0,0x19,0x59,0x13,0x95,0x01}, /*  */
-  {0x00,0x00,0xFE,0x0A,0x8A,0xBE,0xAB,0xAA,0xBE,0x8A,0x0A,0x00,0x48,0x83,0x98,0x4A,0x9A,0x08}, /*  */
-  {0x56,0x5A,0x2E,0x2B,0x5A,0x46,0xFA,0x0A,0xEE,0x0A,0xFA,0x00,0xF0,0x99,0x0F,0x49,0x43,0x09}, /*  */
-  {0x40,0x4F,0xD9,0x29,0x0F,0x09,0x09,0xCF,0x09,0x09,0xEF,0x00,0x00,0x4F,0x02,0x30,0x88,0x0F}, /*  */
-  {0x80,0xBA,0x6A,0xBA,0xAF,0xAA,0xFF,0xAA,0x2A,0xAE,0xE0,0x00,0x80,0xB8,0x34,0xB4,0x88,0x00}, /*  */
-  {0x40,0x20,0x10,0x2C,0x23,0xE0,0x21,0x26,0xE8,0x10,0x20,0x00,0x80,0x48,0x12,0x88,0x07,0x00}, /*  */
-  {0x00,0xFF,0x89,0x89,0xFF,0x00,0xFF,0xA1,0x29,0x29,0xE7,0x00,0x78,0x80,0x0F,0x8F,0x25,0x0D}, /*  */
-  {0x00,0x08,0x04,0xBF,0xEA,0xAA,0xAA,0xAA,0xAA,0x3E,0x02,0x00,0x24,0x89,0xA9,0xA4,0x89,0x08}, /*  */
-  {0x20,0x10,0xFC,0x03,0x08,0x28,0xC8,0x08,0xFF,0x08,0x08,0x00,0x00,0x0F,0x00,0x88,0x0F,0x00}, /*  */
-  {0x40,0x44,0x55,0x56,0x54,0x7C,0x54,0x56,0x55,0x44,0x40,0x00,0xF8,0x99,0x9F,0x9F,0xF9,0x08}, /*  */
-  {0xC8,0x48,0x7F,0x48,0xC8,0x40,0x30,0xCF,0x08,0xF8,0x08,0x00,0x47,0x44,0x87,0x48,0x43,0x08}, /*  */
-  {0x40,0x48,0x48,0x49,0x4A,0xF8,0x4C,0x4A,0x49,0x48,0x40,0x00,0x88,0x24,0x01,0x21,0x84,0x08}, /*  */
-  {0xC8,0x3F,0x08,0xF8,0x40,0x42,0x42,0xF2,0x4A,0x46,0x40,0x00,0x58,0x43,0x80,0xF8,0x00,0x00}, /*  */
-  {0x54,0x54,0xFF,0x54,0x54,0x80,0x92,0xFE,0x49,0x49,0x40,0x00,0x12,0x1F,0x02,0x70,0x88,0x0E}, /*  */
-  {0x20,0x10,0xFC,0x03,0x48,0x3A,0x2A,0xEA,0x2A,0x2E,0x08,0x00,0x00,0x0F,0x59,0x13,0x53,0x09}, /*  */
-  {0x00,0x00,0xFC,0x24,0x24,0x25,0x26,0x24,0x24,0x3C,0x00,0x00,0x48,0x03,0x00,0x00,0x00,0x00}, /*  */
-  {0x10,0x08,0xAC,0xAA,0xAB,0xAA,0xAA,0xAE,0xA8,0xF8,0x00,0x00,0x68,0x60,0x98,0x8A,0x2C,0x0C}, /*  */
-  {0x10,0x12,0xF4,0x00,0x10,0x10,0x10,0xFF,0x10,0x10,0x10,0x00,0x00,0x4F,0x02,0xF0,0x00,0x00}, /*  */
-  {0x22,0x32,0xEE,0x00,0x08,0xAA,0xAA,0xFF,0xAA,0xBE,0x08,0x00,0x25,0x85,0xAA,0xFA,0xAA,0x0A}, /*  */
-  {0xD8,0xB4,0x93,0x48,0x04,0xA4,0xA4,0xBF,0xA4,0xA4,0x04,0x00,0x44,0x22,0xF0,0x88,0xF8,0x00}, /*  */
-  {0x20,0x20,0x20,0x20,0xFF,0xA4,0xA4,0x24,0x24,0x20,0x20,0x00,0x00,0x00,0x0F,0x10,0x21,0x00}, /*  */
-  {0x20,0x22,0x22,0xFE,0x22,0x22,0x22,0xFE,0x22,0x22,0x20,0x00,0x48,0x12,0x00,0xF0,0x00,0x00}, /*  */
-  {0x02,0xF2,0x12,0x12,0x12,0xF2,0x02,0x02,0xFE,0x02,0x02,0x00,0x10,0x11,0x11,0x88,0x0F,0x00}, /*  */
-  {0x02,0x32,0xAA,0x47,0x22,0x92,0x4A,0x02,0xFC,0x00,0xFF,0x00,0x99,0x24,0x21,0x84,0x81,0x0F}, /*  */
-  {0x0E,0x22,0x92,0x5E,0x2A,0x2B,0x2A,0x5A,0x82,0x02,0x0E,0x00,0x11,0xF0,0x99,0xF9,0x10,0x01}, /*  */
-  {0x88,0xAA,0xAA,0xAF,0xAA,0xAA,0x10,0x0F,0xF4,0x04,0x1C,0x00,0x24,0xF8,0xA0,0x24,0x21,0x0C}, /*  */
-  {0x02,0xFE,0x4A,0xFE,0x82,0x00,0x25,0x26,0xFC,0x26,0x25,0x00,0x12,0xF1,0x80,0x34,0x30,0x0C}, /*  */
-  {0x34,0x2C,0xF7,0xA4,0xFA,0x4A,0x3E,0xCA,0x7E,0x8A,0xFA,0x00,0x11,0x0F,0x0F,0x01,0x88,0x07}, /*  */
-  {0x08,0x91,0x42,0x20,0x10,0xCF,0x41,0x41,0x4F,0xD0,0x10,0x00,0xF1,0x80,0x88,0x25,0x85,0x08}, /* û */
-  {0x00,0xF9,0x09,0x09,0xFD,0x4B,0x49,0xF9,0x09,0x09,0xF9,0x00,0xF0,0x88,0x9F,0xF9,0x88,0x0F}, /*  */
-  {0x12,0xD2,0xFE,0x91,0x51,0x3C,0x00,0x7F,0x00,0xC4,0x18,0x00,0x03,0x0F,0x89,0x24,0x01,0x00}, /*  */
-  {0x88,0x68,0xFF,0x28,0x4A,0xFA,0xAF,0xAA,0xAF,0xFA,0x02,0x00,0x01,0x0F,0xAA,0x36,0xA6,0x0A}, /* ģ */
-  {0x00,0xF8,0x08,0x08,0xC8,0x3F,0x48,0x88,0x08,0xF8,0x00,0x00,0xF0,0x12,0x00,0x90,0xF8,0x00}, /*  */
-  {0x58,0x57,0xF4,0x54,0x00,0x22,0xFE,0x22,0x22,0xFE,0x00,0x00,0x00,0x4F,0x8A,0x8F,0xF8,0x08}, /* ť */
-  {0x88,0x88,0xFF,0x48,0x48,0x00,0xFC,0x46,0x45,0x44,0xFC,0x00,0x88,0x0F,0x00,0x8F,0x88,0x0F}, /*  */
-  {0x00,0x00,0x00,0xFE,0x48,0x48,0x48,0x4F,0xC8,0x08,0x08,0x00,0x48,0x12,0x00,0x00,0x0F,0x00}, /* Ƭ */
-  {0x08,0x91,0x42,0x50,0x48,0x57,0x54,0x54,0xD4,0x14,0x04,0x00,0xF1,0x00,0x00,0x00,0x43,0x0E}, /*  */
-  {0x00,0x20,0x10,0x08,0x07,0x84,0x74,0x84,0x04,0x14,0x0C,0x00,0x80,0x48,0x12,0x10,0x42,0x08}, /* Ƿ */
-  {0x88,0x68,0xFF,0x28,0x10,0xE8,0x24,0x23,0x24,0xE8,0x10,0x00,0x01,0x0F,0x70,0x88,0x99,0x0C}, /* ǹ */
-  {0x10,0x12,0xF4,0x00,0x22,0xEA,0xAA,0xBF,0xAA,0xEA,0x22,0x00,0x00,0x27,0xF1,0x22,0xFA,0x00}, /*  */
-  {0x00,0x00,0x00,0x81,0x62,0x1C,0x60,0x80,0x00,0x00,0x00,0x00,0x48,0x12,0x00,0x10,0x42,0x08}, /*  */
-  {0x12,0xD2,0xFE,0x91,0x11,0x00,0xF2,0x54,0x5F,0x54,0xF2,0x00,0x03,0x0F,0x01,0x1F,0x91,0x0F}, /*  */
-  {0x08,0x09,0xFA,0x10,0x08,0x67,0xA1,0x21,0xA7,0x68,0x08,0x00,0x00,0x4F,0x8A,0x25,0x85,0x08}, /*  */
-  {0x20,0x28,0x26,0x24,0xA4,0x7F,0xA4,0x24,0x24,0x20,0x20,0x00,0x88,0x24,0x01,0x21,0x84,0x08}, /* ʧ */
-  {0xFE,0x22,0x22,0xFE,0x08,0x28,0xC8,0x08,0xFF,0x08,0x08,0x00,0x23,0x32,0x00,0x88,0x0F,0x00}, /* ʱ */
-  {0x04,0x24,0x24,0xE4,0x24,0x04,0xFF,0x04,0x05,0x06,0x04,0x00,0x44,0x34,0x22,0x30,0x84,0x0E}, /* ʽ */
-  {0x12,0xD2,0xFE,0x91,0x11,0x00,0x80,0x70,0x0F,0x00,0x00,0x00,0x03,0x0F,0x61,0x45,0x32,0x06}, /* ˽ */
-  {0x10,0xFC,0x03,0x80,0x82,0xBA,0xAA,0xAB,0xAA,0xBA,0x82,0x00,0xF0,0x10,0xA2,0xEA,0x22,0x01}, /* ͣ */
-  {0x20,0x22,0xE4,0x00,0xF9,0xA9,0xAD,0xF9,0xAD,0xAB,0xF9,0x00,0x48,0x43,0x8B,0xB8,0xA8,0x0B}, /* ͨ */
-  {0x10,0xFC,0x03,0x04,0x34,0xC4,0x05,0x06,0xC4,0x34,0x04,0x00,0xF0,0x80,0x98,0xE8,0x89,0x08}, /* λ */
-  {0x08,0x91,0x42,0x80,0xBE,0xAA,0xAA,0xAA,0xBE,0x80,0x00,0x00,0xF1,0xF8,0xF8,0xF8,0xF8,0x08}, /*  */
-  {0x40,0x48,0xA4,0xAB,0xD2,0x92,0x92,0xAA,0xA6,0x40,0x40,0x00,0x80,0x48,0x03,0x88,0x07,0x00}, /*  */
-  {0x00,0x42,0x52,0x5A,0x76,0xD2,0x52,0x49,0x45,0x61,0xC0,0x00,0x48,0x12,0xF8,0x10,0x42,0x08}, /* ϵ */
-  {0x02,0x02,0x02,0x02,0x02,0xFE,0x12,0x22,0x42,0x82,0x02,0x00,0x00,0x00,0xF0,0x00,0x00,0x00}, /*  */
-  {0xFE,0x82,0x1A,0xE6,0x00,0xFE,0x2A,0xEA,0x2A,0xBE,0x40,0x00,0x0F,0x01,0xF0,0x48,0x43,0x08}, /*  */
-  {0x00,0x80,0x40,0x30,0x00,0xFF,0x00,0x10,0x20,0x40,0x80,0x00,0x01,0x80,0xF8,0x00,0x00,0x01}, /* С */
-  {0x08,0x06,0x62,0x5A,0x52,0x52,0x52,0x52,0x52,0xD2,0x06,0x00,0x11,0x11,0x11,0x99,0x78,0x00}, /* д */
-  {0x12,0x56,0x5A,0xF3,0x5A,0x56,0x12,0xFE,0x12,0xF1,0x11,0x00,0x24,0xF9,0xA1,0x34,0xF0,0x00}, /*  */
-  {0x10,0xFC,0x03,0xF8,0x48,0xA7,0xAA,0x52,0xAA,0x26,0x40,0x00,0xF0,0x30,0xA8,0x9A,0x24,0x00}, /*  */
-  {0x2C,0xA5,0xA5,0xAD,0xE5,0xBF,0xA5,0xAD,0xA5,0xA5,0x2C,0x00,0xF0,0x00,0x07,0x07,0xF8,0x00}, /*  */
-  {0x10,0x12,0xF4,0x00,0x22,0xFE,0x22,0x22,0xFE,0x00,0x00,0x00,0x00,0x4F,0xF2,0x00,0x43,0x0F}, /* Ѷ */
-  {0x82,0xBA,0xAA,0xAA,0xFE,0xAA,0xBE,0xAA,0xAA,0xBA,0x82,0x00,0x88,0xBA,0x44,0x9A,0x88,0x08}, /* Ҫ */
-  {0x00,0xFA,0x22,0x22,0x22,0x22,0x22,0x22,0x3E,0x00,0x00,0x00,0x70,0x88,0x88,0x88,0xF8,0x00}, /*  */
-  {0x00,0x00,0xFE,0x92,0x92,0x92,0xFE,0x92,0x92,0x92,0xFE,0x00,0x48,0x03,0x00,0x0F,0x88,0x0F}, /*  */
-  {0x84,0x44,0x24,0xF4,0x5C,0x57,0x54,0x54,0xF4,0x04,0x04,0x00,0x00,0xF0,0x11,0x99,0x0F,0x00}, /*  */
-  {0x20,0x50,0x48,0x54,0x52,0xF1,0x52,0x54,0x48,0x50,0x20,0x00,0x48,0x92,0xF8,0x10,0x42,0x08}, /*  */
-  {0x00,0x00,0x00,0x3F,0x24,0x24,0x24,0x24,0x24,0xE4,0x04,0x00,0x11,0x11,0x11,0x99,0x78,0x00}, /*  */
-  {0x08,0x91,0x42,0x00,0xFE,0x02,0xFA,0xAE,0xAA,0xAA,0xFA,0x00,0xF1,0x48,0x4B,0x82,0x2F,0x0C}, /* Դ */
-  {0x2A,0x2E,0xAB,0xFE,0xAA,0xC0,0xBE,0x8A,0x89,0x79,0x08,0x00,0x00,0xAF,0xAA,0xAA,0x0F,0x00}, /*  */
-  {0xFE,0x02,0xFA,0x02,0xFE,0x20,0xFF,0xA8,0x24,0x22,0x20,0x00,0x68,0x21,0x04,0x8F,0x21,0x04}, /*  */
-  {0xFE,0x82,0x1A,0xE6,0x08,0xFA,0xAE,0xAB,0xAE,0xFA,0x08,0x00,0x0F,0x01,0x22,0xF2,0x22,0x02}, /*  */
-  {0x00,0xF8,0x88,0x88,0x88,0xFF,0x88,0x88,0x88,0xF8,0x00,0x00,0x00,0x00,0xF0,0x00,0x00,0x00}, /*  */
-  {0x58,0x57,0xF4,0x54,0xF8,0x88,0x88,0xFF,0x88,0x88,0xF8,0x00,0x00,0x4F,0x02,0xF0,0x00,0x00}, /*  */
-  {0x00,0x00,0x78,0x49,0x4A,0x48,0x4C,0x4A,0x49,0x78,0x00,0x00,0x68,0x70,0x98,0x8A,0x1C,0x06}, /*  */
-  {0x00,0x00,0xDE,0x12,0x12,0xF2,0x92,0x92,0x9E,0x00,0x00,0x00,0x48,0x43,0xF8,0x88,0x88,0x08}, /*  */
-  {0x00,0xFE,0x82,0x42,0x3A,0x42,0xFF,0x42,0x3A,0x42,0x82,0x00,0x78,0x98,0x99,0x9F,0x99,0x08}  /*  */
-};
-
-const char MsgGB12_0[] = {0x45,0x56,0x41,0x43,0x43,0x20,0x20,0x76,0x33,0x2E,0x30,0x00}; /*EVACC  v3.0*/
-const char MsgGB12_1[] = {0xA1,0xD2,0x00}; /**/
-const char MsgGB12_2[] = {0xA1,0xB9,0xA1,0xFC,0x00}; /**/
-const char MsgGB12_3[] = {0xA1,0xEB,0xA1,0xE0,0x00}; /*Сʱ*/
-const char MsgGB12_4[] = {0x41,0x00}; /*A*/
-const char MsgGB12_5[] = {0x4B,0x57,0x68,0x00}; /*KWh*/
-const char MsgGB12_6[] = {0x43,0x00}; /*C*/
-const char MsgGB12_7[] = {0xA1,0xA1,0x00}; /**/
-const char MsgGB12_8[] = {0xA1,0xC1,0xA1,0xE0,0x00}; /*ʱ*/
-const char MsgGB12_9[] = {0xA1,0xB8,0xA1,0xF3,0x00}; /**/
-const char MsgGB12_10[] = {0xA1,0xF5,0xA1,0xB6,0x00}; /**/
-const char MsgGB12_11[] = {0xA1,0xD6,0xA1,0xED,0xA1,0xC8,0x3B,0xA1,0xAF,0xA1,0xC6,0x3B,0xA1,0xE2,0xA1,0xF4,0xA1,0xDE,0xA1,0xB3,0xA1,0xC8,0x00}; /*¿;;˽趨*/
-const char MsgGB12_12[] = {0xA1,0xB4,0xA1,0xC8,0xA1,0xDF,0xA1,0xA5,0x00}; /*ʧ*/
-const char MsgGB12_13[] = {0xA1,0xEC,0xA1,0xC8,0xA1,0xDF,0xA1,0xA5,0x00}; /*дʧ*/
-const char MsgGB12_14[] = {0xA1,0xD9,0xA1,0xB8,0x3B,0xA1,0xDB,0xA1,0xCE,0xA1,0xE8,0x3B,0xA1,0xCC,0xA1,0xC3,0xA1,0xBA,0xA1,0xE7,0x00}; /*Ƿ;ϵ;ͻ*/
-const char MsgGB12_15[] = {0xA1,0xF5,0xA1,0xB6,0xA1,0xA8,0xA1,0xFE,0x00}; /**/
-const char MsgGB12_16[] = {0xA1,0xC8,0xA1,0xD4,0xA1,0xF5,0xA1,0xB6,0x00}; /**/
-const char MsgGB12_17[] = {0xA1,0xDB,0xA1,0xA4,0xA1,0xAC,0xA1,0xB2,0xA1,0xDA,0x3B,0xA1,0xA9,0xA1,0xDC,0x3B,0xA1,0xD8,0xA1,0xAB,0xA1,0xAC,0xA1,0xB2,0xA2,0xA1,0x00}; /*ѳǹ;;*/
-const char MsgGB12_18[] = {0xA1,0xF6,0xA1,0xAB,0xA1,0xCF,0x3B,0xA1,0xE4,0xA1,0xF0,0xA1,0xFB,0x3B,0xA1,0xDB,0xA1,0xDD,0xA1,0xC2,0xA1,0xD7,0xA1,0xCB,0x00}; /*복;ͨѶ;ԺƬ*/
-const char MsgGB12_19[] = {0xA1,0xDB,0xA1,0xA3,0xA1,0xAD,0x3B,0xA1,0xAC,0xA1,0xB2,0xA1,0xDA,0x3B,0xA1,0xC7,0xA1,0xF9,0x00}; /*γ;ǹ;*/
-const char MsgGB12_20[] = {0xA1,0xD6,0xA1,0xC8,0xA1,0xBC,0xA1,0xCD,0x00}; /*Ŀ*/
-const char MsgGB12_21[] = {0xA1,0xB1,0xA1,0xC9,0x41,0x50,0x50,0xA1,0xBC,0xA1,0xCD,0x00}; /*APP*/
-const char MsgGB12_22[] = {0xA1,0xA7,0x00}; /**/
-const char MsgGB12_23[] = {0xA1,0xB2,0x00}; /**/
-const char MsgGB12_24[] = {0xA1,0xB7,0xA1,0xCD,0x00}; /**/
-const char MsgGB12_25[] = {0xA1,0xFD,0xA1,0xC5,0x00}; /*ܼ*/
-const char MsgGB12_26[] = {0xA1,0xF2,0xA1,0xBC,0x00}; /*Ѹ*/
-const char MsgGB12_27[] = {0xA1,0xF5,0xA1,0xB6,0x00}; /**/
-const char MsgGB12_28[] = {0xA1,0xBE,0xA1,0xFA,0x3B,0xA1,0xD1,0xA1,0xBD,0x3B,0xA1,0xD0,0xA1,0xBF,0xA1,0xC0,0x00}; /*;;ûغ*/
-const char MsgGB12_29[] = {0xA1,0xBE,0xA1,0xFA,0x3A,0xA1,0xC4,0xA1,0xE3,0xA1,0xA2,0xA1,0xD5,0x3B,0xA1,0xA6,0xA1,0xA2,0xA1,0xE9,0x00}; /*:ͣť;*/
-const char MsgGB12_30[] = {0xA1,0xA8,0xA1,0xCA,0xA1,0xEE,0xA1,0xBB,0xA1,0xBE,0xA1,0xFA,0x3B,0x3B,0xA1,0xEF,0xA1,0xF1,0x3B,0xA1,0xB2,0xA1,0xF7,0xA1,0xBB,0xA1,0xE5,0x00}; /*޸;;Ҫ;Դλ*/
-const char MsgGB12_31[] = {0x28,0xA1,0xAE,0xA1,0xB0,0xA1,0xD3,0xA1,0xE1,0x29,0x00}; /*(ģʽ)*/
-const char MsgGB12_32[] = {0xA1,0xE6,0xA1,0xB5,0xA1,0xAA,0xA1,0xEA,0x00}; /*¶ȳ*/
-const char MsgGB12_33[] = {0xA1,0xF8,0xA1,0xE3,0xA1,0xBA,0xA1,0xE7,0x3B,0xA1,0xE6,0xA1,0xB5,0xA1,0xAA,0xA1,0xEA,0x00}; /*ͣ;¶ȳ*/
-
-const TDialog DialogGB12[] =
-{
-  {"EVACC v3.0", MsgGB12_0},
-  {"s", MsgGB12_1},
-  {"min", MsgGB12_2},
-  {"hr", MsgGB12_3},
-  {"A", MsgGB12_4},
-  {"KWh", MsgGB12_5},
-  {"C", MsgGB12_6},
-  {"$", MsgGB12_7},
-  {"TIME ELASPED", MsgGB12_8},
-  {"FREE", MsgGB12_9},
-  {"CREDIT", MsgGB12_10},
-  {"CHECK A NEW CARD;TO MAKE;PRIVATE CARD", MsgGB12_11},
-  {"READ CARD ERROR", MsgGB12_12},
-  {"WRITE CARD ERROR", MsgGB12_13},
-  {"FEE UNPAID;CONTACT;CUSTOMER SERVICE;PLEASE", MsgGB12_14},
-  {"INSUFFICIENT BALANCE", MsgGB12_15},
-  {"CARD BALANCE", MsgGB12_16},
-  {"PLUG IN;CHARGING GUN;TO;START", MsgGB12_17},
-  {"TALKING TO;VEHICLE;ONE MOMENT;PLEASE", MsgGB12_18},
-  {"UNPLUG;CHARGING GUN;TO;CHECK OUT", MsgGB12_19},
-  {"CHECK CARD TO PAY", MsgGB12_20},
-  {"OPEN APP TO PAY", MsgGB12_21},
-  {"PARKING", MsgGB12_22},
-  {"ENERGY", MsgGB12_23},
-  {"PENALTY", MsgGB12_24},
-  {"TOTAL", MsgGB12_25},
-  {"PAID", MsgGB12_26},
-  {"BALANCE", MsgGB12_27},
-  {"ERROR;LID;IS OPENED", MsgGB12_28},
-  {"ERROR;PANIC BUTTON;IS PRESSED", MsgGB12_29},
-  {"FATAL ERROR!;POWER CYCLE;TO RESET", MsgGB12_30},
-  {"(DEBUG MODE)", MsgGB12_31},
-  {"OVER TEMP.", MsgGB12_32},
-  {"SERVICE SUSPENDED;OVER TEMPERATURE", MsgGB12_33}
-};
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include "languages.h"
+
+const unsigned char FontGB12[][18] =
+{
+  {0x00,0x02,0x46,0x4A,0x50,0xE0,0x50,0x4A,0x46,0x02,0x00,0x00,0x00,0x00,0x74,0x04,0x00,0x00}, /*  */
+  {0x88,0x88,0xFF,0x48,0x2C,0xA4,0x75,0x26,0x24,0xE4,0x2C,0x00,0x88,0x0F,0x98,0x25,0x85,0x08}, /*  */
+  {0x88,0x88,0xFF,0x48,0x08,0x08,0xFF,0x28,0x28,0x29,0xEA,0x00,0x88,0x4F,0x92,0x58,0x52,0x08}, /*  */
+  {0x88,0x88,0xFF,0x48,0xFE,0x22,0x22,0x3E,0x22,0x22,0x3E,0x00,0x88,0x0F,0x87,0x88,0x88,0x0E}, /*  */
+  {0xFE,0x02,0xF2,0x02,0xFE,0x20,0x18,0x67,0x84,0x7C,0x04,0x00,0x68,0x21,0x84,0x24,0x21,0x0C}, /*  */
+  {0x44,0x25,0xF6,0x4C,0xA0,0xFC,0xA4,0x24,0x3F,0x24,0xEC,0x00,0x00,0x8F,0xB4,0x58,0x52,0x08}, /*  */
+  {0x08,0x91,0x42,0x00,0xFC,0x44,0x46,0x45,0x44,0xFC,0x00,0x00,0xF1,0x00,0x8F,0x88,0xF8,0x00}, /*  */
+  {0x02,0x82,0x42,0x22,0x12,0xFA,0x06,0x12,0x22,0x42,0x82,0x00,0x01,0x00,0xF0,0x00,0x00,0x00}, /*  */
+  {0x88,0x88,0xFF,0x48,0xC0,0x2A,0x0A,0xFE,0x09,0x29,0xE8,0x00,0x88,0x0F,0x9F,0xF8,0x98,0x0F}, /*  */
+  {0xD4,0x14,0xFF,0x94,0x94,0x20,0xD2,0x4E,0x42,0x52,0xDE,0x00,0x2F,0x47,0x88,0xAB,0xAA,0x0B}, /*  */
+  {0x04,0x64,0x54,0x4C,0x46,0xF5,0x44,0x44,0x44,0x44,0x04,0x00,0x22,0x22,0xF2,0x22,0x22,0x02}, /*  */
+  {0x04,0x44,0x64,0xD4,0x4D,0x46,0xC4,0x44,0x64,0x44,0x04,0x00,0x88,0x34,0x00,0x87,0x88,0x0E}, /*  */
+  {0x80,0x3C,0x20,0x20,0x20,0xFF,0x20,0x20,0x20,0x3C,0x80,0x00,0x8F,0x88,0xF8,0x88,0x88,0x0F}, /*  */
+  {0xFF,0x09,0x15,0xE3,0x48,0x54,0x52,0xF1,0x52,0x54,0x48,0x00,0x1F,0x52,0x12,0xF8,0x21,0x04}, /*  */
+  {0x08,0xF4,0x12,0x11,0x12,0xF4,0x08,0x00,0xFC,0x00,0xFF,0x00,0x70,0x98,0x89,0x0E,0x88,0x0F}, /*  */
+  {0x58,0x57,0xF4,0x54,0x20,0xA4,0xBF,0xA4,0xBF,0xA4,0x20,0x00,0x00,0x4F,0xF0,0xAA,0xFA,0x00}, /*  */
+  {0x88,0x88,0xFF,0x48,0x02,0x02,0x02,0xFE,0x02,0x02,0x02,0x00,0x88,0x0F,0x80,0xF8,0x00,0x00}, /*  */
+  {0x00,0xFC,0x24,0x24,0x24,0xFF,0x24,0x24,0x24,0xFC,0x00,0x00,0x10,0x11,0x71,0x99,0x99,0x0C}, /*  */
+  {0x1C,0x04,0xD4,0x14,0x14,0xF5,0x96,0x94,0x94,0x04,0x0C,0x00,0x48,0x43,0xF8,0x88,0x88,0x08}, /*  */
+  {0x12,0xF4,0x00,0x48,0x9A,0x2A,0x0F,0xEA,0x0A,0x2A,0x18,0x00,0xF0,0x19,0x59,0x13,0x95,0x01}, /*  */
+  {0x00,0x00,0xFE,0x0A,0x8A,0xBE,0xAB,0xAA,0xBE,0x8A,0x0A,0x00,0x48,0x83,0x98,0x4A,0x9A,0x08}, /*  */
+  {0x56,0x5A,0x2E,0x2B,0x5A,0x46,0xFA,0x0A,0xEE,0x0A,0xFA,0x00,0xF0,0x99,0x0F,0x49,0x43,0x09}, /*  */
+  {0x40,0x4F,0xD9,0x29,0x0F,0x09,0x09,0xCF,0x09,0x09,0xEF,0x00,0x00,0x4F,0x02,0x30,0x88,0x0F}, /*  */
+  {0x80,0xBA,0x6A,0xBA,0xAF,0xAA,0xFF,0xAA,0x2A,0xAE,0xE0,0x00,0x80,0xB8,0x34,0xB4,0x88,0x00}, /*  */
+  {0x40,0x20,0x10,0x2C,0x23,0xE0,0x21,0x26,0xE8,0x10,0x20,0x00,0x80,0x48,0x12,0x88,0x07,0x00}, /*  */
+  {0x00,0xFF,0x89,0x89,0xFF,0x00,0xFF,0xA1,0x29,0x29,0xE7,0x00,0x78,0x80,0x0F,0x8F,0x25,0x0D}, /*  */
+  {0x00,0x08,0x04,0xBF,0xEA,0xAA,0xAA,0xAA,0xAA,0x3E,0x02,0x00,0x24,0x89,0xA9,0xA4,0x89,0x08}, /*  */
+  {0x20,0x10,0xFC,0x03,0x08,0x28,0xC8,0x08,0xFF,0x08,0x08,0x00,0x00,0x0F,0x00,0x88,0x0F,0x00}, /*  */
+  {0x40,0x44,0x55,0x56,0x54,0x7C,0x54,0x56,0x55,0x44,0x40,0x00,0xF8,0x99,0x9F,0x9F,0xF9,0x08}, /*  */
+  {0xC8,0x48,0x7F,0x48,0xC8,0x40,0x30,0xCF,0x08,0xF8,0x08,0x00,0x47,0x44,0x87,0x48,0x43,0x08}, /*  */
+  {0x40,0x48,0x48,0x49,0x4A,0xF8,0x4C,0x4A,0x49,0x48,0x40,0x00,0x88,0x24,0x01,0x21,0x84,0x08}, /*  */
+  {0xC8,0x3F,0x08,0xF8,0x40,0x42,0x42,0xF2,0x4A,0x46,0x40,0x00,0x58,0x43,0x80,0xF8,0x00,0x00}, /*  */
+  {0x54,0x54,0xFF,0x54,0x54,0x80,0x92,0xFE,0x49,0x49,0x40,0x00,0x12,0x1F,0x02,0x70,0x88,0x0E}, /*  */
+  {0x20,0x10,0xFC,0x03,0x48,0x3A,0x2A,0xEA,0x2A,0x2E,0x08,0x00,0x00,0x0F,0x59,0x13,0x53,0x09}, /*  */
+  {0x00,0x00,0xFC,0x24,0x24,0x25,0x26,0x24,0x24,0x3C,0x00,0x00,0x48,0x03,0x00,0x00,0x00,0x00}, /*  */
+  {0x10,0x08,0xAC,0xAA,0xAB,0xAA,0xAA,0xAE,0xA8,0xF8,0x00,0x00,0x68,0x60,0x98,0x8A,0x2C,0x0C}, /*  */
+  {0x10,0x12,0xF4,0x00,0x10,0x10,0x10,0xFF,0x10,0x10,0x10,0x00,0x00,0x4F,0x02,0xF0,0x00,0x00}, /*  */
+  {0x22,0x32,0xEE,0x00,0x08,0xAA,0xAA,0xFF,0xAA,0xBE,0x08,0x00,0x25,0x85,0xAA,0xFA,0xAA,0x0A}, /*  */
+  {0xD8,0xB4,0x93,0x48,0x04,0xA4,0xA4,0xBF,0xA4,0xA4,0x04,0x00,0x44,0x22,0xF0,0x88,0xF8,0x00}, /*  */
+  {0x20,0x20,0x20,0x20,0xFF,0xA4,0xA4,0x24,0x24,0x20,0x20,0x00,0x00,0x00,0x0F,0x10,0x21,0x00}, /*  */
+  {0x20,0x22,0x22,0xFE,0x22,0x22,0x22,0xFE,0x22,0x22,0x20,0x00,0x48,0x12,0x00,0xF0,0x00,0x00}, /*  */
+  {0x02,0xF2,0x12,0x12,0x12,0xF2,0x02,0x02,0xFE,0x02,0x02,0x00,0x10,0x11,0x11,0x88,0x0F,0x00}, /*  */
+  {0x02,0x32,0xAA,0x47,0x22,0x92,0x4A,0x02,0xFC,0x00,0xFF,0x00,0x99,0x24,0x21,0x84,0x81,0x0F}, /*  */
+  {0x0E,0x22,0x92,0x5E,0x2A,0x2B,0x2A,0x5A,0x82,0x02,0x0E,0x00,0x11,0xF0,0x99,0xF9,0x10,0x01}, /*  */
+  {0x88,0xAA,0xAA,0xAF,0xAA,0xAA,0x10,0x0F,0xF4,0x04,0x1C,0x00,0x24,0xF8,0xA0,0x24,0x21,0x0C}, /*  */
+  {0x02,0xFE,0x4A,0xFE,0x82,0x00,0x25,0x26,0xFC,0x26,0x25,0x00,0x12,0xF1,0x80,0x34,0x30,0x0C}, /*  */
+  {0x34,0x2C,0xF7,0xA4,0xFA,0x4A,0x3E,0xCA,0x7E,0x8A,0xFA,0x00,0x11,0x0F,0x0F,0x01,0x88,0x07}, /*  */
+  {0x08,0x91,0x42,0x20,0x10,0xCF,0x41,0x41,0x4F,0xD0,0x10,0x00,0xF1,0x80,0x88,0x25,0x85,0x08}, /* û */
+  {0x00,0xF9,0x09,0x09,0xFD,0x4B,0x49,0xF9,0x09,0x09,0xF9,0x00,0xF0,0x88,0x9F,0xF9,0x88,0x0F}, /*  */
+  {0x12,0xD2,0xFE,0x91,0x51,0x3C,0x00,0x7F,0x00,0xC4,0x18,0x00,0x03,0x0F,0x89,0x24,0x01,0x00}, /*  */
+  {0x88,0x68,0xFF,0x28,0x4A,0xFA,0xAF,0xAA,0xAF,0xFA,0x02,0x00,0x01,0x0F,0xAA,0x36,0xA6,0x0A}, /* ģ */
+  {0x00,0xF8,0x08,0x08,0xC8,0x3F,0x48,0x88,0x08,0xF8,0x00,0x00,0xF0,0x12,0x00,0x90,0xF8,0x00}, /*  */
+  {0x58,0x57,0xF4,0x54,0x00,0x22,0xFE,0x22,0x22,0xFE,0x00,0x00,0x00,0x4F,0x8A,0x8F,0xF8,0x08}, /* ť */
+  {0x88,0x88,0xFF,0x48,0x48,0x00,0xFC,0x46,0x45,0x44,0xFC,0x00,0x88,0x0F,0x00,0x8F,0x88,0x0F}, /*  */
+  {0x00,0x00,0x00,0xFE,0x48,0x48,0x48,0x4F,0xC8,0x08,0x08,0x00,0x48,0x12,0x00,0x00,0x0F,0x00}, /* Ƭ */
+  {0x08,0x91,0x42,0x50,0x48,0x57,0x54,0x54,0xD4,0x14,0x04,0x00,0xF1,0x00,0x00,0x00,0x43,0x0E}, /*  */
+  {0x00,0x20,0x10,0x08,0x07,0x84,0x74,0x84,0x04,0x14,0x0C,0x00,0x80,0x48,0x12,0x10,0x42,0x08}, /* Ƿ */
+  {0x88,0x68,0xFF,0x28,0x10,0xE8,0x24,0x23,0x24,0xE8,0x10,0x00,0x01,0x0F,0x70,0x88,0x99,0x0C}, /* ǹ */
+  {0x10,0x12,0xF4,0x00,0x22,0xEA,0xAA,0xBF,0xAA,0xEA,0x22,0x00,0x00,0x27,0xF1,0x22,0xFA,0x00}, /*  */
+  {0x00,0x00,0x00,0x81,0x62,0x1C,0x60,0x80,0x00,0x00,0x00,0x00,0x48,0x12,0x00,0x10,0x42,0x08}, /*  */
+  {0x12,0xD2,0xFE,0x91,0x11,0x00,0xF2,0x54,0x5F,0x54,0xF2,0x00,0x03,0x0F,0x01,0x1F,0x91,0x0F}, /*  */
+  {0x08,0x09,0xFA,0x10,0x08,0x67,0xA1,0x21,0xA7,0x68,0x08,0x00,0x00,0x4F,0x8A,0x25,0x85,0x08}, /*  */
+  {0x20,0x28,0x26,0x24,0xA4,0x7F,0xA4,0x24,0x24,0x20,0x20,0x00,0x88,0x24,0x01,0x21,0x84,0x08}, /* ʧ */
+  {0xFE,0x22,0x22,0xFE,0x08,0x28,0xC8,0x08,0xFF,0x08,0x08,0x00,0x23,0x32,0x00,0x88,0x0F,0x00}, /* ʱ */
+  {0x04,0x24,0x24,0xE4,0x24,0x04,0xFF,0x04,0x05,0x06,0x04,0x00,0x44,0x34,0x22,0x30,0x84,0x0E}, /* ʽ */
+  {0x12,0xD2,0xFE,0x91,0x11,0x00,0x80,0x70,0x0F,0x00,0x00,0x00,0x03,0x0F,0x61,0x45,0x32,0x06}, /* ˽ */
+  {0x10,0xFC,0x03,0x80,0x82,0xBA,0xAA,0xAB,0xAA,0xBA,0x82,0x00,0xF0,0x10,0xA2,0xEA,0x22,0x01}, /* ͣ */
+  {0x20,0x22,0xE4,0x00,0xF9,0xA9,0xAD,0xF9,0xAD,0xAB,0xF9,0x00,0x48,0x43,0x8B,0xB8,0xA8,0x0B}, /* ͨ */
+  {0x10,0xFC,0x03,0x04,0x34,0xC4,0x05,0x06,0xC4,0x34,0x04,0x00,0xF0,0x80,0x98,0xE8,0x89,0x08}, /* λ */
+  {0x08,0x91,0x42,0x80,0xBE,0xAA,0xAA,0xAA,0xBE,0x80,0x00,0x00,0xF1,0xF8,0xF8,0xF8,0xF8,0x08}, /*  */
+  {0x40,0x48,0xA4,0xAB,0xD2,0x92,0x92,0xAA,0xA6,0x40,0x40,0x00,0x80,0x48,0x03,0x88,0x07,0x00}, /*  */
+  {0x00,0x42,0x52,0x5A,0x76,0xD2,0x52,0x49,0x45,0x61,0xC0,0x00,0x48,0x12,0xF8,0x10,0x42,0x08}, /* ϵ */
+  {0x02,0x02,0x02,0x02,0x02,0xFE,0x12,0x22,0x42,0x82,0x02,0x00,0x00,0x00,0xF0,0x00,0x00,0x00}, /*  */
+  {0xFE,0x82,0x1A,0xE6,0x00,0xFE,0x2A,0xEA,0x2A,0xBE,0x40,0x00,0x0F,0x01,0xF0,0x48,0x43,0x08}, /*  */
+  {0x00,0x80,0x40,0x30,0x00,0xFF,0x00,0x10,0x20,0x40,0x80,0x00,0x01,0x80,0xF8,0x00,0x00,0x01}, /* С */
+  {0x08,0x06,0x62,0x5A,0x52,0x52,0x52,0x52,0x52,0xD2,0x06,0x00,0x11,0x11,0x11,0x99,0x78,0x00}, /* д */
+  {0x12,0x56,0x5A,0xF3,0x5A,0x56,0x12,0xFE,0x12,0xF1,0x11,0x00,0x24,0xF9,0xA1,0x34,0xF0,0x00}, /*  */
+  {0x10,0xFC,0x03,0xF8,0x48,0xA7,0xAA,0x52,0xAA,0x26,0x40,0x00,0xF0,0x30,0xA8,0x9A,0x24,0x00}, /*  */
+  {0x2C,0xA5,0xA5,0xAD,0xE5,0xBF,0xA5,0xAD,0xA5,0xA5,0x2C,0x00,0xF0,0x00,0x07,0x07,0xF8,0x00}, /*  */
+  {0x10,0x12,0xF4,0x00,0x22,0xFE,0x22,0x22,0xFE,0x00,0x00,0x00,0x00,0x4F,0xF2,0x00,0x43,0x0F}, /* Ѷ */
+  {0x82,0xBA,0xAA,0xAA,0xFE,0xAA,0xBE,0xAA,0xAA,0xBA,0x82,0x00,0x88,0xBA,0x44,0x9A,0x88,0x08}, /* Ҫ */
+  {0x00,0xFA,0x22,0x22,0x22,0x22,0x22,0x22,0x3E,0x00,0x00,0x00,0x70,0x88,0x88,0x88,0xF8,0x00}, /*  */
+  {0x00,0x00,0xFE,0x92,0x92,0x92,0xFE,0x92,0x92,0x92,0xFE,0x00,0x48,0x03,0x00,0x0F,0x88,0x0F}, /*  */
+  {0x84,0x44,0x24,0xF4,0x5C,0x57,0x54,0x54,0xF4,0x04,0x04,0x00,0x00,0xF0,0x11,0x99,0x0F,0x00}, /*  */
+  {0x20,0x50,0x48,0x54,0x52,0xF1,0x52,0x54,0x48,0x50,0x20,0x00,0x48,0x92,0xF8,0x10,0x42,0x08}, /*  */
+  {0x00,0x00,0x00,0x3F,0x24,0x24,0x24,0x24,0x24,0xE4,0x04,0x00,0x11,0x11,0x11,0x99,0x78,0x00}, /*  */
+  {0x08,0x91,0x42,0x00,0xFE,0x02,0xFA,0xAE,0xAA,0xAA,0xFA,0x00,0xF1,0x48,0x4B,0x82,0x2F,0x0C}, /* Դ */
+  {0x2A,0x2E,0xAB,0xFE,0xAA,0xC0,0xBE,0x8A,0x89,0x79,0x08,0x00,0x00,0xAF,0xAA,0xAA,0x0F,0x00}, /*  */
+  {0xFE,0x02,0xFA,0x02,0xFE,0x20,0xFF,0xA8,0x24,0x22,0x20,0x00,0x68,0x21,0x04,0x8F,0x21,0x04}, /*  */
+  {0xFE,0x82,0x1A,0xE6,0x08,0xFA,0xAE,0xAB,0xAE,0xFA,0x08,0x00,0x0F,0x01,0x22,0xF2,0x22,0x02}, /*  */
+  {0x00,0xF8,0x88,0x88,0x88,0xFF,0x88,0x88,0x88,0xF8,0x00,0x00,0x00,0x00,0xF0,0x00,0x00,0x00}, /*  */
+  {0x58,0x57,0xF4,0x54,0xF8,0x88,0x88,0xFF,0x88,0x88,0xF8,0x00,0x00,0x4F,0x02,0xF0,0x00,0x00}, /*  */
+  {0x00,0x00,0x78,0x49,0x4A,0x48,0x4C,0x4A,0x49,0x78,0x00,0x00,0x68,0x70,0x98,0x8A,0x1C,0x06}, /*  */
+  {0x00,0x00,0xDE,0x12,0x12,0xF2,0x92,0x92,0x9E,0x00,0x00,0x00,0x48,0x43,0xF8,0x88,0x88,0x08}, /*  */
+  {0x00,0xFE,0x82,0x42,0x3A,0x42,0xFF,0x42,0x3A,0x42,0x82,0x00,0x78,0x98,0x99,0x9F,0x99,0x08}  /*  */
+};
+
+const char MsgGB12_0[] = {0x45,0x56,0x41,0x43,0x43,0x20,0x20,0x76,0x33,0x2E,0x30,0x00}; /*EVACC  v3.0*/
+const char MsgGB12_1[] = {0xA1,0xD2,0x00}; /**/
+const char MsgGB12_2[] = {0xA1,0xB9,0xA1,0xFC,0x00}; /**/
+const char MsgGB12_3[] = {0xA1,0xEB,0xA1,0xE0,0x00}; /*Сʱ*/
+const char MsgGB12_4[] = {0x41,0x00}; /*A*/
+const char MsgGB12_5[] = {0x4B,0x57,0x68,0x00}; /*KWh*/
+const char MsgGB12_6[] = {0x43,0x00}; /*C*/
+const char MsgGB12_7[] = {0xA1,0xA1,0x00}; /**/
+const char MsgGB12_8[] = {0xA1,0xC1,0xA1,0xE0,0x00}; /*ʱ*/
+const char MsgGB12_9[] = {0xA1,0xB8,0xA1,0xF3,0x00}; /**/
+const char MsgGB12_10[] = {0xA1,0xF5,0xA1,0xB6,0x00}; /**/
+const char MsgGB12_11[] = {0xA1,0xD6,0xA1,0xED,0xA1,0xC8,0x3B,0xA1,0xAF,0xA1,0xC6,0x3B,0xA1,0xE2,0xA1,0xF4,0xA1,0xDE,0xA1,0xB3,0xA1,0xC8,0x00}; /*¿;;˽趨*/
+const char MsgGB12_12[] = {0xA1,0xB4,0xA1,0xC8,0xA1,0xDF,0xA1,0xA5,0x00}; /*ʧ*/
+const char MsgGB12_13[] = {0xA1,0xEC,0xA1,0xC8,0xA1,0xDF,0xA1,0xA5,0x00}; /*дʧ*/
+const char MsgGB12_14[] = {0xA1,0xD9,0xA1,0xB8,0x3B,0xA1,0xDB,0xA1,0xCE,0xA1,0xE8,0x3B,0xA1,0xCC,0xA1,0xC3,0xA1,0xBA,0xA1,0xE7,0x00}; /*Ƿ;ϵ;ͻ*/
+const char MsgGB12_15[] = {0xA1,0xF5,0xA1,0xB6,0xA1,0xA8,0xA1,0xFE,0x00}; /**/
+const char MsgGB12_16[] = {0xA1,0xC8,0xA1,0xD4,0xA1,0xF5,0xA1,0xB6,0x00}; /**/
+const char MsgGB12_17[] = {0xA1,0xDB,0xA1,0xA4,0xA1,0xAC,0xA1,0xB2,0xA1,0xDA,0x3B,0xA1,0xA9,0xA1,0xDC,0x3B,0xA1,0xD8,0xA1,0xAB,0xA1,0xAC,0xA1,0xB2,0xA2,0xA1,0x00}; /*ѳǹ;;*/
+const char MsgGB12_18[] = {0xA1,0xF6,0xA1,0xAB,0xA1,0xCF,0x3B,0xA1,0xE4,0xA1,0xF0,0xA1,0xFB,0x3B,0xA1,0xDB,0xA1,0xDD,0xA1,0xC2,0xA1,0xD7,0xA1,0xCB,0x00}; /*복;ͨѶ;ԺƬ*/
+const char MsgGB12_19[] = {0xA1,0xDB,0xA1,0xA3,0xA1,0xAD,0x3B,0xA1,0xAC,0xA1,0xB2,0xA1,0xDA,0x3B,0xA1,0xC7,0xA1,0xF9,0x00}; /*γ;ǹ;*/
+const char MsgGB12_20[] = {0xA1,0xD6,0xA1,0xC8,0xA1,0xBC,0xA1,0xCD,0x00}; /*Ŀ*/
+const char MsgGB12_21[] = {0xA1,0xB1,0xA1,0xC9,0x41,0x50,0x50,0xA1,0xBC,0xA1,0xCD,0x00}; /*APP*/
+const char MsgGB12_22[] = {0xA1,0xA7,0x00}; /**/
+const char MsgGB12_23[] = {0xA1,0xB2,0x00}; /**/
+const char MsgGB12_24[] = {0xA1,0xB7,0xA1,0xCD,0x00}; /**/
+const char MsgGB12_25[] = {0xA1,0xFD,0xA1,0xC5,0x00}; /*ܼ*/
+const char MsgGB12_26[] = {0xA1,0xF2,0xA1,0xBC,0x00}; /*Ѹ*/
+const char MsgGB12_27[] = {0xA1,0xF5,0xA1,0xB6,0x00}; /**/
+const char MsgGB12_28[] = {0xA1,0xBE,0xA1,0xFA,0x3B,0xA1,0xD1,0xA1,0xBD,0x3B,0xA1,0xD0,0xA1,0xBF,0xA1,0xC0,0x00}; /*;;ûغ*/
+const char MsgGB12_29[] = {0xA1,0xBE,0xA1,0xFA,0x3A,0xA1,0xC4,0xA1,0xE3,0xA1,0xA2,0xA1,0xD5,0x3B,0xA1,0xA6,0xA1,0xA2,0xA1,0xE9,0x00}; /*:ͣť;*/
+const char MsgGB12_30[] = {0xA1,0xA8,0xA1,0xCA,0xA1,0xEE,0xA1,0xBB,0xA1,0xBE,0xA1,0xFA,0x3B,0x3B,0xA1,0xEF,0xA1,0xF1,0x3B,0xA1,0xB2,0xA1,0xF7,0xA1,0xBB,0xA1,0xE5,0x00}; /*޸;;Ҫ;Դλ*/
+const char MsgGB12_31[] = {0x28,0xA1,0xAE,0xA1,0xB0,0xA1,0xD3,0xA1,0xE1,0x29,0x00}; /*(ģʽ)*/
+const char MsgGB12_32[] = {0xA1,0xE6,0xA1,0xB5,0xA1,0xAA,0xA1,0xEA,0x00}; /*¶ȳ*/
+const char MsgGB12_33[] = {0xA1,0xF8,0xA1,0xE3,0xA1,0xBA,0xA1,0xE7,0x3B,0xA1,0xE6,0xA1,0xB5,0xA1,0xAA,0xA1,0xEA,0x00}; /*ͣ;¶ȳ*/
+
+const TDialog DialogGB12[] =
+{
+  {"EVACC v3.0", MsgGB12_0},
+  {"s", MsgGB12_1},
+  {"min", MsgGB12_2},
+  {"hr", MsgGB12_3},
+  {"A", MsgGB12_4},
+  {"KWh", MsgGB12_5},
+  {"C", MsgGB12_6},
+  {"$", MsgGB12_7},
+  {"TIME ELASPED", MsgGB12_8},
+  {"FREE", MsgGB12_9},
+  {"CREDIT", MsgGB12_10},
+  {"CHECK A NEW CARD;TO MAKE;PRIVATE CARD", MsgGB12_11},
+  {"READ CARD ERROR", MsgGB12_12},
+  {"WRITE CARD ERROR", MsgGB12_13},
+  {"FEE UNPAID;CONTACT;CUSTOMER SERVICE;PLEASE", MsgGB12_14},
+  {"INSUFFICIENT BALANCE", MsgGB12_15},
+  {"CARD BALANCE", MsgGB12_16},
+  {"PLUG IN;CHARGING GUN;TO;START", MsgGB12_17},
+  {"TALKING TO;VEHICLE;ONE MOMENT;PLEASE", MsgGB12_18},
+  {"UNPLUG;CHARGING GUN;TO;CHECK OUT", MsgGB12_19},
+  {"CHECK CARD TO PAY", MsgGB12_20},
+  {"OPEN APP TO PAY", MsgGB12_21},
+  {"PARKING", MsgGB12_22},
+  {"ENERGY", MsgGB12_23},
+  {"PENALTY", MsgGB12_24},
+  {"TOTAL", MsgGB12_25},
+  {"PAID", MsgGB12_26},
+  {"BALANCE", MsgGB12_27},
+  {"ERROR;LID;IS OPENED", MsgGB12_28},
+  {"ERROR;PANIC BUTTON;IS PRESSED", MsgGB12_29},
+  {"FATAL ERROR!;POWER CYCLE;TO RESET", MsgGB12_30},
+  {"(DEBUG MODE)", MsgGB12_31},
+  {"OVER TEMP.", MsgGB12_32},
+  {"SERVICE SUSPENDED;OVER TEMPERATURE", MsgGB12_33}
+};
@@ -0,0 +1,189 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#include <string.h>
+#include "stm32f10x.h"
+#include "hal.h"
+#include "app_main.h"
+#include "i2c_hw.h"
+#include "crc32.h"
+#include "ledger.h"
+
+/* Store-and-forward of paid sessions
+ *
+ * LEDGER_SLOTS records in EEPROM, a new one goes to an empty or
+ * acknowledged slot, the oldest first. Once all are unacknowledged the
+ * stored ones are kept and the new one is dropped and counted, bills/sync
+ * reports the count. The serial of every slot is kept in RAM, lookups
+ * never scan the EEPROM. The acknowledged serial and the drop count have
+ * their own block and survive resets, bills/sync resumes after the serial.
+ * A session paid again after a journal replay has the same serial and
+ * replaces its record.
+ * Pushed from the app_main loop, read and acknowledged from dhThread.
+ */
+
+typedef char TLedgerRecFits[(sizeof(TLedgerRec)%EEP_PAGE_SIZE==0)? 1: -1];
+
+extern TI2C I2C2Port;
+
+typedef struct
+{
+  uint32_t Acked; //serial
+  uint32_t Dropped; //sessions that found every slot unacknowledged
+} TLedgerAck;
+
+static uint32_t Serial[LEDGER_SLOTS]; //0 empty
+static TLedgerAck Ack;
+
+static uint16_t slotAddr(int slot)
+{
+  return EEP_LEDGER_ADDR + slot*sizeof(TLedgerRec);
+}
+
+static int readRec(int slot, TLedgerRec *rec)
+{
+  int i;
+  for (i=0; i<3; i++)
+  {
+    if (!EEPRead(&I2C2Port, slotAddr(slot), rec, sizeof(*rec)))
+      continue;
+    return ValidateCrc32Blk(rec, sizeof(*rec)) && rec->Serial;
+  }
+  return 0;
+}
+
+void Ledger_Init(void)
+{
+  TLedgerRec rec;
+  int slot;
+  
+  if (!EEP_ReadBlk(EEP_LEDGER_ACK_ADDR, &Ack, sizeof(Ack), NULL))
+    memset(&Ack, 0, sizeof(Ack));
+  for (slot=0; slot<LEDGER_SLOTS; slot++)
+    Serial[slot] = readRec(slot, &rec)? rec.Serial: 0;
+}
+
+//stores a paid session, 0 on EEPROM failure so the caller retries.
+//With no slot to spare the session is counted as dropped instead.
+int Ledger_Push(TLedgerRec *rec)
+{
+  TLedgerRec chk;
+  TLedgerAck ack;
+  int slot, i;
+
+  for (slot=-1, i=0; i<LEDGER_SLOTS; i++)
+  {
+    if (Serial[i] == rec->Serial)
+    {
+      slot = i;
+      break;
+    }
+    if ((Serial[i] <= Ack.Acked) && ((slot<0) || (Serial[i] < Serial[slot])))
+      slot = i;
+  }
+  if (slot < 0)
+  {
+    ack = Ack;
+    ack.Dropped++;
+    return EEP_WriteBlk(EEP_LEDGER_ACK_ADDR, &ack, sizeof(ack), &Ack, NULL);
+  }
+  CalcCrc32Blk(rec, sizeof(*rec));
+  Serial[slot] = 0; //not readable while rewritten
+  if (!EEPWrite(&I2C2Port, slotAddr(slot), rec, sizeof(*rec)))
+    return 0;
+  if (!readRec(slot, &chk) || memcmp(rec, &chk, sizeof(*rec)))
+    return 0;
+  Serial[slot] = rec->Serial;
+  return 1;
+}
+
+//oldest stored record after the given serial, 0 when there is none.
+//An unreadable record is skipped, it would stall every later sync.
+int Ledger_Next(uint32_t after, TLedgerRec *rec)
+{
+  for (;;)
+  {
+    uint32_t serial = 0;
+    int slot = -1, i;
+    for (i=0; i<LEDGER_SLOTS; i++)
+      if ((Serial[i] > after) && ((slot<0) || (Serial[i] < serial)))
+      {
+        slot = i;
+        serial = Serial[i];
+      }
+    if (slot < 0)
+      return 0;
+    if (readRec(slot, rec) && (rec->Serial==serial))
+      return 1;
+    after = serial;
+  }
+}
+
+//everything up to serial is upstream, written only when it moves forward
+void Ledger_Ack(uint32_t serial)
+{
+  uint32_t newest = 0;
+  int i;
+  for (i=0; i<LEDGER_SLOTS; i++)
+    if (Serial[i] > newest)
+      newest = Serial[i];
+  if (serial > newest)
+    serial = newest;
+  if (serial > Ack.Acked)
+  {
+    TLedgerAck ack = Ack;
+    ack.Acked = serial;
+    EEP_WriteBlk(EEP_LEDGER_ACK_ADDR, &ack, sizeof(ack), &Ack, NULL);
+  }
+}
+
+uint32_t Ledger_GetAcked(void)
+{
+  return Ack.Acked;
+}
+
+//highest serial stored or acknowledged, a new one must go above it
+uint32_t Ledger_GetNewest(void)
+{
+  uint32_t newest = Ack.Acked;
+  int i;
+  for (i=0; i<LEDGER_SLOTS; i++)
+    if (Serial[i] > newest)
+      newest = Serial[i];
+  return newest;
+}
+
+int Ledger_GetPending(void)
+{
+  int n = 0, i;
+  for (i=0; i<LEDGER_SLOTS; i++)
+    n += Serial[i] > Ack.Acked;
+  return n;
+}
+
+uint32_t Ledger_GetDropped(void)
+{
+  return Ack.Dropped;
+}
@@ -0,0 +1,62 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __LEDGER_H__
+#define __LEDGER_H__
+
+#include <stdint.h>
+#include "RFID_Card.h"
+
+#define LEDGER_SLOTS                32  //paid sessions kept until acknowledged
+
+#define LEDGER_PAY_BY_CARD          0x01
+#define LEDGER_FREE_CARD            0x02
+#define LEDGER_GROUP_SHIFT          4     //card group in the high nibble of Flags
+
+//a paid session, two EEPROM pages
+typedef struct
+{
+  uint32_t Serial; //journal sequence of the session end, increasing
+  uint32_t StartTime, EndTime; //local seconds, 0 unknown
+  TCardSn CardSn; //zero unless paid by card
+  uint32_t ChargingSec;
+  uint16_t ParkingMin;
+  uint8_t Flags; //LEDGER_xxx, card group above LEDGER_GROUP_SHIFT
+  uint8_t Connector;
+  uint32_t Energy_Wh;
+  uint32_t ClassWh[TARIFF_CLASSES];
+  TMilli EnergyFee, ParkingFee, ParkPenalty, PaidAmount;
+  uint32_t Crc;
+} TLedgerRec;
+
+void Ledger_Init(void);
+int Ledger_Push(TLedgerRec *rec);
+int Ledger_Next(uint32_t after, TLedgerRec *rec);
+void Ledger_Ack(uint32_t serial);
+uint32_t Ledger_GetAcked(void);
+uint32_t Ledger_GetNewest(void);
+int Ledger_GetPending(void);
+uint32_t Ledger_GetDropped(void);
+
+#endif
@@ -1,50 +1,50 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#ifndef __MEM_H__
-  #define __MEM_H__
-  
-#include "cmsis_os2.h"
-#include "stdint.h"
-
-typedef struct
-{
-  uint32_t Code;
-  uint16_t BufSize;
-  osMemoryPoolId_t *MemPool; 
-  union 
-  {
-    void *Ptr;
-    uint32_t Value;
-  } Buf;
-} TMsgItem;
-
-
-void RecycleMsgItem(TMsgItem *ItemPtr);
-TMsgItem *NewMsgItem(int32_t MsgCode, uint16_t BufSize);
-TMsgItem *DupMsgItem(TMsgItem *SrcItem);
-void InitMemotyPools(void);
-
-#endif
-
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __MEM_H__
+  #define __MEM_H__
+  
+#include "cmsis_os2.h"
+#include "stdint.h"
+
+typedef struct
+{
+  uint32_t Code;
+  uint16_t BufSize;
+  osMemoryPoolId_t *MemPool; 
+  union 
+  {
+    void *Ptr;
+    uint32_t Value;
+  } Buf;
+} TMsgItem;
+
+
+void RecycleMsgItem(TMsgItem *ItemPtr);
+TMsgItem *NewMsgItem(int32_t MsgCode, uint16_t BufSize);
+TMsgItem *DupMsgItem(TMsgItem *SrcItem);
+void InitMemotyPools(void);
+
+#endif
+
@@ -0,0 +1,105 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include "stm32f10x.h"
+#include "hal.h"
+#include "app_main.h"
+#include "trace.h"
+#include "tariff.h"
+#include "schedule.h"
+
+/* Charging windows
+ *
+ * When windows are set, the pilot only offers current inside them: an EV
+ * plugged in earlier waits in S6Vdc and the pilot moves on to S6Vac by
+ * itself once a window opens, a session still running when it closes is
+ * offered 0A until the next one. Windows follow the weekday and weekend
+ * profiles of the tariff, a window belongs to the day it starts on. Like
+ * the tariff the state is located once and kept until NextBoundary.
+ * Without wall time the schedule does not apply.
+ */
+
+static uint32_t NextBoundary; //local seconds
+static uint8_t IsOpen = 1;
+static __IO uint8_t Changed = 1;
+
+//table or clock changed, locate the window again on the next call
+void Schedule_Changed(void)
+{
+  Changed = 1;
+}
+
+static void nearer(uint32_t t, uint32_t now)
+{
+  if ((t>now) && (t<NextBoundary))
+    NextBoundary = t;
+}
+
+//windows of the day before can run past midnight into today
+static void locate(uint32_t now)
+{
+  TSchedule *schedule = &Config.Public.Schedule;
+  uint32_t day = now/SECS_PER_DAY, midnight = day*SECS_PER_DAY;
+  int d, n;
+
+  IsOpen = 0;
+  NextBoundary = midnight+SECS_PER_DAY; //the profile may change at midnight
+  for (d=0; d<2; d++)
+  {
+    uint32_t base = midnight - d*SECS_PER_DAY; //start of the window's day
+    int p = Tariff_ProfileOf(day-d);
+    for (n=0; n<schedule->Count[p]; n++)
+    {
+      uint32_t start = base + schedule->Window[p][n][0]*60;
+      uint32_t end = base + schedule->Window[p][n][1]*60;
+      if (end <= start)
+        end += SECS_PER_DAY;
+      if ((now>=start) && (now<end))
+        IsOpen = 1;
+      nearer(start, now);
+      nearer(end, now);
+    }
+  }
+}
+
+//called from the pilot thread whenever it decides on an offer
+int Schedule_IsOpen(void)
+{
+  TSchedule *schedule = &Config.Public.Schedule;
+  uint32_t now = LocalTime_Get();
+  uint8_t was = IsOpen;
+
+  if ((now==0) || ((schedule->Count[TARIFF_WEEKDAY]==0) && (schedule->Count[TARIFF_WEEKEND]==0)))
+    IsOpen = 1;
+  else if (Changed || (now>=NextBoundary))
+  {
+    Changed = 0;
+    locate(now);
+  }
+  if (IsOpen != was)
+    Trace_Record(teSchedule, IsOpen);
+  return IsOpen;
+}
@@ -0,0 +1,110 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "hal.h"
+#include "setpoint.h"
+
+#define REF_SLOTS                   (EV_RESPONSE_MS/1000+1)
+
+static uint16_t Limits[SETPOINT_SOURCES] = {SETPOINT_NONE, SETPOINT_NONE, SETPOINT_NONE, SETPOINT_NONE, SETPOINT_NONE};
+static uint16_t RampRate = DEF_CURRENT_RAMP_RATE;
+static uint32_t RampmA, RampTick;
+static uint16_t RefMax[REF_SLOTS];
+static uint32_t RefSec;
+
+void Setpoint_Set(TSetpointSource source, uint16_t amps)
+{
+  if (source>=SETPOINT_SOURCES)
+    return;
+  MASK_IRQ
+    Limits[source] = amps;
+  UNMASK_IRQ
+}
+
+uint16_t Setpoint_GetLimit(void)
+{
+  uint16_t limit = SETPOINT_NONE;
+  MASK_IRQ
+    for (int i=0; i<SETPOINT_SOURCES; i++)
+      if (Limits[i] < limit)
+        limit = Limits[i];
+  UNMASK_IRQ
+  return limit;
+}
+
+void Setpoint_SetRampRate(uint16_t ampsPerSec)
+{
+  MASK_IRQ
+    RampRate = ampsPerSec? ampsPerSec: DEF_CURRENT_RAMP_RATE;
+  UNMASK_IRQ
+}
+
+uint16_t Setpoint_GetRampRate(void)
+{
+  return RampRate;
+}
+
+//returns the current to offer in mA, ramp=0 jumps to target (EV not drawing)
+uint32_t Setpoint_Ramp(uint16_t target, int ramp)
+{
+  uint32_t now = osKernelGetTickCount();
+  uint32_t targetmA = (uint32_t)target*1000;
+  
+  if (!ramp || (targetmA <= RampmA))
+    RampmA = targetmA;
+  else
+  {
+    if (RampmA < CHARGE_CURRENT_MIN*1000) //resume from the lowest offer
+      RampmA = CHARGE_CURRENT_MIN*1000;
+    RampmA += RampRate*(now-RampTick)*MsPerTick; //A/s * ms = mA
+    if (RampmA > targetmA)
+      RampmA = targetmA;
+  }
+  RampTick = now;
+  return RampmA;
+}
+
+//highest offer of the last EV_RESPONSE_MS, for over current detection
+uint16_t Setpoint_ResponseRef(uint16_t offered)
+{
+  uint32_t sec = osKernelGetTickCount()*MsPerTick/1000;
+  uint16_t ref = 0;
+  
+  if (sec-RefSec >= REF_SLOTS) //long gap, forget history
+  {
+    for (int i=0; i<REF_SLOTS; i++)
+      RefMax[i] = 0;
+    RefSec = sec;
+  }
+  while (RefSec != sec)
+    RefMax[++RefSec%REF_SLOTS] = 0;
+  if (offered > RefMax[sec%REF_SLOTS])
+    RefMax[sec%REF_SLOTS] = offered;
+  for (int i=0; i<REF_SLOTS; i++)
+    if (RefMax[i] > ref)
+      ref = RefMax[i];
+  return ref;
+}
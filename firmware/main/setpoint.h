@@ -0,0 +1,49 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __SETPOINT_H__
+#define __SETPOINT_H__
+
+#include <stdint.h>
+
+/* Charging current setpoint
+ *
+ * Subsystems push their own current limit, the lowest one wins. Raising the
+ * offer is ramped at the ramp rate (A/s). Lowering is applied at once, the EV 
+ * is given EV_RESPONSE_MS to follow before the old offer stops counting as 
+ * the over-current reference.
+ */
+#define SETPOINT_NONE               0xffff
+#define EV_RESPONSE_MS              5000 /* IEC 61851-1 */
+
+typedef enum {spRemote, spThermal, spTariff, spTaper, spBudget, SETPOINT_SOURCES} TSetpointSource;
+
+void Setpoint_Set(TSetpointSource source, uint16_t amps);
+uint16_t Setpoint_GetLimit(void);
+void Setpoint_SetRampRate(uint16_t ampsPerSec);
+uint16_t Setpoint_GetRampRate(void);
+uint32_t Setpoint_Ramp(uint16_t target, int ramp);
+uint16_t Setpoint_ResponseRef(uint16_t offered);
+
+#endif
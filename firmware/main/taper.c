@@ -0,0 +1,124 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include <math.h>
+#include <string.h>
+#include "stm32f10x.h"
+#include "hal.h"
+#include "app_main.h"
+#include "setpoint.h"
+#include "taper.h"
+
+/* Constant-voltage taper detection
+ *
+ * The CV phase of the EV battery draws an exponentially falling current 
+ * I(t) = I0*exp(-t/tau). Window averages falling steadily below the offer mark 
+ * the taper, tau comes from the ratio of successive windows. Remaining time 
+ * to TAPER_END_DA is tau*ln(I/Iend), remaining energy is V*tau*(I-Iend).
+ */
+#define SAMPLES_PER_WINDOW          (TAPER_WINDOW_SEC*CT_SAMPLE_FREQ/CT_SAMPLE_SIZE)
+
+static TTaperInfo Info;
+static uint32_t Sum, Count;
+static uint16_t PrevAvg;
+static uint8_t Declines;
+static float Tau;
+
+void Taper_Reset(void)
+{
+  MASK_IRQ
+    memset(&Info, 0, sizeof(Info));
+    Info.Limit = SETPOINT_NONE;
+    Sum = Count = PrevAvg = Declines = 0;
+    Tau = 0;
+  UNMASK_IRQ
+  Setpoint_Set(spTaper, SETPOINT_NONE);
+}
+
+static void predict(uint16_t avg)
+{
+  float v = Config.Private.Power.ChargeVoltage;
+  if (avg <= TAPER_END_DA)
+  {
+    Info.RemainSec = Info.RemainWh = 0;
+    return;
+  }
+  Info.RemainSec = Tau*logf((float)avg/TAPER_END_DA);
+  Info.RemainWh = v*Tau*(avg-TAPER_END_DA)/10/3600;
+}
+
+//called by CTThread for every sample block while the contactor is on
+void Taper_Sample(uint16_t total_dA, uint16_t offered)
+{
+  uint16_t limit;
+  
+  Sum += total_dA;
+  if (++Count < SAMPLES_PER_WINDOW)
+    return;
+  uint16_t avg = Sum/Count;
+  Sum = Count = 0;
+  
+  limit = Info.Limit;
+  if ((avg+TAPER_MARGIN_DA >= offered*10) && (limit==SETPOINT_NONE)) //drawing what is offered, constant current
+    Declines = 0;
+  else if (PrevAvg && ((uint32_t)avg*1000 <= (uint32_t)PrevAvg*(1000-TAPER_DECLINE_PERMILLE)))
+  {
+    float tau = -TAPER_WINDOW_SEC/logf((float)avg/PrevAvg);
+    Tau = Declines? (Tau*3+tau)/4: tau; //smoothed
+    if (Declines < TAPER_DECLINE_WINDOWS)
+      Declines++;
+  }
+  else if ((limit!=SETPOINT_NONE) && (avg+TAPER_MARGIN_DA >= limit*10)) //EV wants more than the reduced offer
+  {
+    Declines = 0;
+    limit = SETPOINT_NONE;
+  }
+  
+  if (Declines >= TAPER_DECLINE_WINDOWS)
+  {
+    uint16_t a = (avg+9)/10+TAPER_HEADROOM_A;
+    if (a < CHARGE_CURRENT_MIN)
+      a = CHARGE_CURRENT_MIN;
+    if (a < limit) //only ever lowered while tapering
+      limit = a;
+  }
+  MASK_IRQ
+    Info.Current_dA = avg;
+    Info.Tapering = Declines >= TAPER_DECLINE_WINDOWS;
+    Info.Limit = limit;
+    if (Info.Tapering)
+      predict(avg);
+    else
+      Info.RemainSec = Info.RemainWh = 0;
+  UNMASK_IRQ
+  PrevAvg = avg;
+  Setpoint_Set(spTaper, limit);
+}
+
+void Taper_GetInfo(TTaperInfo *info)
+{
+  MASK_IRQ
+    *info = Info;
+  UNMASK_IRQ
+}
@@ -0,0 +1,50 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __TAPER_H__
+#define __TAPER_H__
+
+#include <stdint.h>
+
+#define TAPER_WINDOW_SEC            60
+#define TAPER_DECLINE_WINDOWS       3    /* successive declining windows to call it a taper */
+#define TAPER_DECLINE_PERMILLE      20   /* min. decline per window */
+#define TAPER_MARGIN_DA             20   /* current must be this far below the offer */
+#define TAPER_HEADROOM_A            3    /* reservation kept above the drawn current */
+#define TAPER_END_DA                20   /* EV assumed to stop below this */
+
+typedef struct
+{
+  uint8_t Tapering;
+  uint16_t Current_dA;          /* last window average */
+  uint16_t Limit;               /* A, SETPOINT_NONE if not limiting */
+  uint32_t RemainSec;
+  uint32_t RemainWh;
+} TTaperInfo;
+
+void Taper_Reset(void);
+void Taper_Sample(uint16_t total_dA, uint16_t offered);
+void Taper_GetInfo(TTaperInfo *info);
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#include "stm32f10x.h"
+#include "hal.h"
+#include "app_main.h"
+#include "tariff.h"
+
+/* Time-of-use tariff
+ *
+ * Each day profile lists bands by start minute, a band lasts until the next
+ * one starts, before the first band the last one wraps around from the 
+ * previous evening. The band in effect is located once and kept until
+ * NextBoundary, so the per-second billing tick only compares two counters.
+ * Only Trans_BillTick calls in here.
+ */
+
+static uint32_t BandStart, NextBoundary; //local seconds
+static uint8_t CurClass, InUse;
+static __IO uint8_t Changed = 1;
+
+//table or clock changed, locate the band again on the next call
+void Tariff_Changed(void)
+{
+  Changed = 1;
+}
+
+//TARIFF_WEEKDAY or TARIFF_WEEKEND of a local day number, schedule.c shares it
+int Tariff_ProfileOf(uint32_t day)
+{
+  uint8_t wday = (day+6)%7; //0 Sunday
+  return (wday==0)||(wday==6)? TARIFF_WEEKEND: TARIFF_WEEKDAY;
+}
+
+static void locate(uint32_t now)
+{
+  uint32_t day = now/SECS_PER_DAY, midnight = day*SECS_PER_DAY;
+  uint16_t min = now%SECS_PER_DAY/60;
+  int p = Tariff_ProfileOf(day);
+  int i, n = Config.Public.Tariff.Count[p];
+  const uint16_t *band = Config.Public.Tariff.Band[p];
+
+  BandStart = now;
+  NextBoundary = midnight+SECS_PER_DAY; //the profile may change at midnight
+  InUse = n>0;
+  if (!InUse)
+    return;
+  for (i=0; (i<n) && (TARIFF_BAND_MIN(band[i])<=min); i++);
+  CurClass = TARIFF_BAND_CLASS(band[i? i-1: n-1]);
+  if (i<n)
+    NextBoundary = midnight + TARIFF_BAND_MIN(band[i])*60;
+}
+
+//energy rate in effect now, milli-currency per kWh, and its class
+//TRates applies while the profile is empty or the wall time is unknown
+TMilli Tariff_GetRate(uint8_t *cls)
+{
+  uint32_t now = LocalTime_Get();
+
+  *cls = 0;
+  if (now==0)
+    return Config.Public.Rates.Energy_kWh;
+  if (Changed || (now>=NextBoundary) || (now<BandStart))
+  {
+    Changed = 0;
+    locate(now);
+  }
+  if (!InUse)
+    return Config.Public.Rates.Energy_kWh;
+  *cls = CurClass;
+  return Config.Public.Tariff.Energy_kWh[CurClass];
+}
@@ -0,0 +1,149 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <string.h>
+#include <stdlib.h>
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "hal.h"
+#include "app_main.h"
+#include "trans.h"
+#include "CT_Thread.h"
+#include "PilotThread.h"
+#include "telemetry.h"
+
+/* Telemetry deadbands
+ *
+ * Each connector keeps the sample it last pushed. A state, pilot or error
+ * change is pending at once. Current, energy and temperature are compared
+ * every Telemetry.PeriodSec while charging, or along with a state change,
+ * and are pending only when they moved past their deadband from the last
+ * push. Nothing is queued: the link takes a fresh sample of a connector
+ * with pending fields when it is free, and the fields it got out become
+ * the new reference, so a slow or lost link sends the latest values once.
+ * Polled from the dhThread loop, which is also the only caller of Peek and
+ * Sent, so no locking.
+ */
+
+static TTeleSample Last[CONNECTORS]; //as last pushed
+static uint8_t Pending[CONNECTORS]; //TELE_xxx waiting for the link
+static uint32_t SampleTick;
+
+static void sample(uint8_t conn, TTeleSample *s)
+{
+  TBill bill;
+  float current;
+
+  memset(s, 0, sizeof(*s));
+  s->State = Trans_GetState(conn);
+  Trans_GetBill(conn, &bill);
+  s->Energy_Wh = bill.Energy_Wh;
+  if (conn != PILOT_CONN)
+    return;
+  s->Pilot = ReadCurStateObj()->Id;
+  s->Errors = (IsPanic()? TELE_ERR_PANIC: 0)|(IsFatalError()? TELE_ERR_HARDWARE: 0)|(IsCoverOpended()? TELE_ERR_LID: 0);
+  GetPowerVar(&current, NULL);
+  s->Current_mA = current*1000;
+  s->Temp_mC = CurTemperature*1000;
+}
+
+//fields of s that differ from the last push, the measured ones only when sampled
+static uint8_t changed(uint8_t conn, const TTeleSample *s, int sampled)
+{
+  const TTelemetry *cfg = &Config.Public.Telemetry;
+  const TTeleSample *last = &Last[conn];
+  uint8_t fields = 0;
+
+  if ((s->State != last->State) || (s->Pilot != last->Pilot))
+    fields |= TELE_STATE;
+  if (s->Errors != last->Errors)
+    fields |= TELE_ERROR;
+  if (sampled || fields) //a change also settles the measured fields, e.g. current after a stop
+  {
+    if (abs(s->Current_mA - last->Current_mA) > cfg->CurrentDb_mA)
+      fields |= TELE_CURRENT;
+    if ((s->Energy_Wh < last->Energy_Wh) || (s->Energy_Wh - last->Energy_Wh > cfg->EnergyDb_Wh))
+      fields |= TELE_ENERGY;
+    if (abs(s->Temp_mC - last->Temp_mC) > cfg->TempDb_mC)
+      fields |= TELE_TEMP;
+  }
+  return fields & cfg->Fields;
+}
+
+//polled from the dhThread loop
+void Telemetry_Tick(void)
+{
+  TTeleSample s;
+  uint8_t conn;
+  int sampled = 0;
+
+  if (!Config.Public.Telemetry.Fields)
+    return;
+  if (osKernelGetTickCount()-SampleTick >= MsToOSTicks(Config.Public.Telemetry.PeriodSec*1000))
+  {
+    SampleTick = osKernelGetTickCount();
+    sampled = 1;
+  }
+  for (conn=0; conn<CONNECTORS; conn++)
+  {
+    sample(conn, &s);
+    Pending[conn] |= changed(conn, &s, sampled && (s.State == trCharging));
+  }
+}
+
+//a connector with fields to push and a fresh sample of it, 0 none
+uint8_t Telemetry_Peek(uint8_t *conn, TTeleSample *s)
+{
+  uint8_t c;
+  for (c=0; c<CONNECTORS; c++)
+    if (Pending[c])
+    {
+      *conn = c;
+      sample(c, s);
+      return Pending[c];
+    }
+  return 0;
+}
+
+//the pushed fields become the reference of their deadbands
+void Telemetry_Sent(uint8_t conn, uint8_t fields, const TTeleSample *s)
+{
+  TTeleSample *last = &Last[conn];
+  Pending[conn] &= ~fields;
+  if (fields & TELE_STATE)
+  {
+    last->State = s->State;
+    last->Pilot = s->Pilot;
+  }
+  if (fields & TELE_ERROR)
+    last->Errors = s->Errors;
+  if (fields & TELE_CURRENT)
+    last->Current_mA = s->Current_mA;
+  if (fields & TELE_ENERGY)
+    last->Energy_Wh = s->Energy_Wh;
+  if (fields & TELE_TEMP)
+    last->Temp_mC = s->Temp_mC;
+}
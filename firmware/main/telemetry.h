@@ -0,0 +1,59 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <stdint.h>
+
+/* Unsolicited telemetry
+ *
+ * charger -> client: telemetry {conn, and the fields that changed}
+ *
+ * State, pilot and error changes are pushed as soon as they are seen. The
+ * measured fields are sampled every Telemetry.PeriodSec while charging and
+ * pushed only when they moved past their deadband since the last push, so
+ * an idle fleet sends nothing. Device wide fields ride on PILOT_CONN.
+ */
+
+typedef struct
+{
+  uint8_t State; //TTransState
+  uint8_t Pilot; //TPilotStateId
+  uint8_t Errors; //TELE_ERR_xxx
+  int32_t Current_mA;
+  uint32_t Energy_Wh; //of the session
+  int32_t Temp_mC;
+} TTeleSample;
+
+#define TELE_ERR_PANIC              0x01
+#define TELE_ERR_HARDWARE           0x02
+#define TELE_ERR_LID                0x04
+
+void Telemetry_Tick(void);
+uint8_t Telemetry_Peek(uint8_t *conn, TTeleSample *sample);
+void Telemetry_Sent(uint8_t conn, uint8_t fields, const TTeleSample *sample);
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+ 
+#include <string.h>
+#include "stm32f10x.h"
+#include "cmsis_os2.h"
+#include "hal.h"
+#include "app_main.h"
+#include "i2c_hw.h"
+#include "crc32.h"
+#include "CT_Thread.h"
+#include "totals.h"
+
+/* Energy registers
+ *
+ * Lifetime, daily and monthly totals fed from the CT thread's energy
+ * counter that, unlike the session meter, is never reset. They live in RAM
+ * and go to EEPROM each time the lifetime register crosses TOTALS_STEP_WH,
+ * so a power cut loses about one step at most. Records go round a ring of
+ * TOTALS_SLOTS pages as in the journal, spreading the wear, and the newest
+ * valid one is loaded at boot. Periods roll over on wall time, until it is
+ * known the energy goes to the stored periods.
+ * Updated from the app_main loop, read by dhThread.
+ */
+
+typedef char TTotalsRecFits[(sizeof(TTotalsRec)==EEP_PAGE_SIZE)? 1: -1];
+typedef char TTotalsRingFits[(EEP_TOTALS_ADDR+TOTALS_SLOTS*EEP_PAGE_SIZE <= 0x2000)? 1: -1];
+
+extern TI2C I2C2Port;
+
+static TTotalsRec Totals;
+static uint8_t Slot; //where the next record goes
+static uint32_t CountedWh; //CT energy total already added
+static uint32_t SavedWh; //lifetime register as last written
+
+static uint16_t slotAddr(uint8_t slot)
+{
+  return EEP_TOTALS_ADDR + slot*EEP_PAGE_SIZE;
+}
+
+static int readRec(uint8_t slot, TTotalsRec *rec)
+{
+  int i;
+  for (i=0; i<3; i++)
+  {
+    if (!EEPRead(&I2C2Port, slotAddr(slot), rec, sizeof(*rec)))
+      continue;
+    return ValidateCrc32Blk(rec, sizeof(*rec)) && rec->Seq;
+  }
+  return 0;
+}
+
+//months since 2000-01 of a local day number
+static uint16_t monthOf(uint32_t day)
+{
+  static const uint8_t mdays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  uint16_t year = 0, month = 0, n;
+
+  while (1)
+  {
+    n = (year%4)? 365: 366; //2000-2099
+    if (day < n)
+      break;
+    day -= n;
+    year++;
+  }
+  while (1)
+  {
+    n = mdays[month] + ((month==1) && !(year%4));
+    if (day < n)
+      break;
+    day -= n;
+    month++;
+  }
+  return year*12+month;
+}
+
+//moves the registers on to the day of now, a period skipped over had no energy
+static void roll(TTotalsRec *rec, uint32_t now)
+{
+  uint16_t day = now/SECS_PER_DAY+1;
+  uint16_t month;
+
+  if (rec->Day == day)
+    return;
+  month = monthOf(day-1);
+  if (rec->Day)
+  {
+    rec->PrevDayWh = (day == rec->Day+1)? rec->DayWh: 0;
+    rec->DayWh = 0;
+    if (month != rec->Month)
+    {
+      rec->PrevMonthWh = (month == rec->Month+1)? rec->MonthWh: 0;
+      rec->MonthWh = 0;
+    }
+  }
+  rec->Day = day;
+  rec->Month = month;
+}
+
+//on failure nothing moves, the write is tried again on the next tick
+static void writeRec(TTotalsRec *rec)
+{
+  TTotalsRec chk;
+  rec->Seq++;
+  CalcCrc32Blk(rec, sizeof(*rec));
+  if (!EEPWrite(&I2C2Port, slotAddr(Slot), rec, sizeof(*rec)))
+    return;
+  if (!readRec(Slot, &chk) || memcmp(rec, &chk, sizeof(*rec)))
+    return;
+  Slot = (Slot+1)%TOTALS_SLOTS;
+  SavedWh = rec->LifetimeWh;
+  MASK_IRQ
+    Totals.Seq = rec->Seq;
+  UNMASK_IRQ
+}
+
+void Totals_Init(void)
+{
+  TTotalsRec rec;
+  uint8_t slot;
+
+  memset(&Totals, 0, sizeof(Totals));
+  for (slot=0; slot<TOTALS_SLOTS; slot++)
+  {
+    if (!readRec(slot, &rec))
+      continue;
+    if (rec.Seq > Totals.Seq)
+    {
+      Totals = rec;
+      Slot = (slot+1)%TOTALS_SLOTS;
+    }
+  }
+  SavedWh = Totals.LifetimeWh;
+  CountedWh = GetEnergyTotal();
+}
+
+//polled from the app_main loop, the only writer, so only the copy back is masked
+void Totals_Tick(void)
+{
+  TTotalsRec rec = Totals;
+  uint32_t wh = GetEnergyTotal(), now = LocalTime_Get();
+
+  if (now)
+    roll(&rec, now);
+  rec.LifetimeWh += wh-CountedWh;
+  rec.DayWh += wh-CountedWh;
+  rec.MonthWh += wh-CountedWh;
+  MASK_IRQ
+    Totals = rec;
+  UNMASK_IRQ
+  CountedWh = wh;
+  if (rec.LifetimeWh/TOTALS_STEP_WH != SavedWh/TOTALS_STEP_WH)
+    writeRec(&rec);
+}
+
+void Totals_Get(TTotalsRec *totals)
+{
+  MASK_IRQ
+    *totals = Totals;
+  UNMASK_IRQ
+}
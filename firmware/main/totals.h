@@ -0,0 +1,51 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+ 
+#ifndef __TOTALS_H__
+#define __TOTALS_H__
+
+#include <stdint.h>
+
+#define TOTALS_SLOTS                16  //ring of one-page records
+#define TOTALS_STEP_WH             100  //lifetime register persisted every 0.1kWh
+
+//energy registers, one EEPROM page. Day and Month are stamps of the current
+//periods, the previous ones are the day and month right before them.
+typedef struct
+{
+  uint32_t Seq; //newest record has the highest
+  uint32_t LifetimeWh;
+  uint16_t Day; //local day number+1, 0 unknown
+  uint16_t Month; //months since 2000-01
+  uint32_t DayWh, MonthWh;
+  uint32_t PrevDayWh, PrevMonthWh;
+  uint32_t Crc;
+} TTotalsRec;
+
+void Totals_Init(void);
+void Totals_Tick(void);
+void Totals_Get(TTotalsRec *totals);
+
+#endif
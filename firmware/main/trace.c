@@ -0,0 +1,148 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include "stm32f10x.h"
+#include "hal.h"
+#include "CT_Thread.h"
+#include "PilotThread.h"
+#include "trace.h"
+
+#pragma O3 //recording must stay well below 1us (72 cycles), timing here is not delay loop based
+#pragma Otime
+
+static TTraceEntry Ring[TRACE_SIZE];
+static uint32_t Head; //number of entries ever recorded
+static uint32_t BaseCyc, BaseUs, UsPerCyc32, CycPerUs, MaxCycles;
+
+//us since boot from the DWT cycle counter, a multiply instead of a divide
+static uint32_t cyc2Us(uint32_t cyc)
+{
+  return ((uint64_t)(cyc-BaseCyc)*UsPerCyc32>>32) + BaseUs;
+}
+
+void Trace_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  CycPerUs = SystemCoreClock/1000000;
+  UsPerCyc32 = (0xffffffffUL+CycPerUs/2)/CycPerUs;
+}
+
+//the cycle counter wraps in ~60s, move the base forward at least that often
+void Trace_Tick(void)
+{
+  MASK_IRQ
+    uint32_t us = cyc2Us(DWT->CYCCNT) - BaseUs;
+    BaseUs += us;
+    BaseCyc += us*CycPerUs;
+  UNMASK_IRQ
+}
+
+uint32_t Trace_NowUs(void)
+{
+  MASK_IRQ
+    uint32_t us = cyc2Us(DWT->CYCCNT);
+  UNMASK_IRQ
+  return us;
+}
+
+void Trace_Record(TTraceEvent event, uint8_t arg)
+{
+  MASK_IRQ
+    uint32_t cyc = DWT->CYCCNT;
+    TTraceEntry *e = &Ring[Head++ & (TRACE_SIZE-1)];
+    e->TimeUs = cyc2Us(cyc);
+    e->Event = event;
+    e->Arg = arg;
+    e->Offered = CapacityOffered;
+    e->Flags = IS_CONTACTOR_ON? 1: 0;
+    e->Duty = PWM_TIMER->CCR1;
+    e->Phase[0] = PhaseDeciAmps[0];
+    e->Phase[1] = PhaseDeciAmps[1];
+    e->Phase[2] = PhaseDeciAmps[2];
+    cyc = DWT->CYCCNT-cyc;
+    if (cyc > MaxCycles)
+      MaxCycles = cyc;
+  UNMASK_IRQ
+}
+
+//copies up to count entries starting at seq from, returns seq of the next entry
+uint32_t Trace_Read(uint32_t from, TTraceEntry *entries, int count, int *read)
+{
+  int n = 0;
+  MASK_IRQ
+    if (from > Head)
+      from = Head;
+    if (Head-from > TRACE_SIZE) //overwritten already, start from the oldest
+      from = Head-TRACE_SIZE;
+  UNMASK_IRQ
+  for (; n<count; n++, from++)
+  {
+    MASK_IRQ
+      int valid = (from<Head) && (Head-from<=TRACE_SIZE);
+      if (valid)
+        entries[n] = Ring[from & (TRACE_SIZE-1)];
+    UNMASK_IRQ
+    if (!valid)
+      break;
+  }
+  *read = n;
+  return from;
+}
+
+uint32_t Trace_GetMaxCycles(void)
+{
+  return MaxCycles;
+}
+
+#ifdef IRQ_OFF_STATS
+static uint32_t IrqOffMax, IrqOffPc;
+
+//from UNMASK_IRQ, interrupts still disabled
+void Trace_IrqOff(uint32_t cycles)
+{
+  if (cycles > IrqOffMax)
+  {
+    IrqOffMax = cycles;
+    IrqOffPc = __return_address(); //the UNMASK_IRQ that closed the section
+  }
+}
+#endif
+
+//longest interrupt-disabled section in cycles and where it ended, 0 if not measured
+uint32_t Trace_GetIrqOff(uint32_t *pc)
+{
+#ifdef IRQ_OFF_STATS
+  MASK_IRQ
+    uint32_t ret = IrqOffMax;
+    *pc = IrqOffPc;
+    IrqOffMax = 0; //restart the measurement
+  UNMASK_IRQ
+  return ret;
+#else
+  *pc = 0;
+  return 0;
+#endif
+}
@@ -0,0 +1,63 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+
+#define TRACE_SIZE                  128 /* entries, power of 2 */
+
+typedef enum 
+{
+  teNone, 
+  tePilot,                      /* Arg: TPilotStateId */
+  teTrans,                      /* Arg: TTransState, connector in the high nibble */
+  teContactor,                  /* Arg: ON/OFF */
+  teOverCurrent,                /* Arg: 0 cleared, 1 timer started, 2 expired */
+  tePanic,                      /* Arg: psPanic */
+  teGrant,                      /* Arg: amps granted */
+  teJournal,                    /* Arg: TJournalType written, 0 session restored, connector in the high nibble */
+  teSchedule                    /* Arg: 1 charging window opened, 0 closed */
+} TTraceEvent;
+
+typedef struct
+{
+  uint32_t TimeUs;
+  uint8_t Event, Arg;
+  uint8_t Offered;              /* A */
+  uint8_t Flags;                /* bit0: contactor on */
+  uint16_t Duty;                /* PWM pulse, permille */
+  uint16_t Phase[3];            /* 0.1A */
+} TTraceEntry;
+
+void Trace_Init(void);
+void Trace_Tick(void);
+uint32_t Trace_NowUs(void);
+void Trace_Record(TTraceEvent event, uint8_t arg);
+uint32_t Trace_Read(uint32_t from, TTraceEntry *entries, int count, int *read);
+uint32_t Trace_GetMaxCycles(void);
+uint32_t Trace_GetIrqOff(uint32_t *pc);
+
+#endif
@@ -1,301 +1,542 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#include <string.h>
-#include "hal.h"
-#include "trans.h"
-#include "stm32f10x_it.h"
-#include "CT_Thread.h"
-#include "dhThread.h"
-#include "app_main.h"
-
-static TTrans Trans;
-
-TTransState Trans_GetState(void)
-{
-  MASK_IRQ
-    TTransState ret =  Trans.State;
-  UNMASK_IRQ
-  return ret;
-}
-
-char* Trans_GetStateName(void)
-{
-  char *s;
-  switch(Trans_GetState())
-  {
-    case trIdle:
-      s = "idle";
-      break;
-    case trHandshake:
-      s = "handshake";
-      break;
-    case trAuthen:
-      s = "authen";
-      break;
-    case trCharging:
-      s = "charging";
-      break;
-    case trParking:
-      s = "parking";
-      break;
-    case trBilling:
-      s = "billing";
-      break;
-    case trPaid:
-      s = "paid";
-      break;
-  }
-  return s;
-}
-
-int Trans_SetState(TTransState newState, float paidAmount)
-{
-  int ret = 0;
-  MASK_IRQ
-    switch(newState)
-    {
-      case trIdle:
-        if ( (Trans.State==trAuthen)||(Trans.State==trHandshake)||
-          ((Trans.State==trPaid)&&(Trans.PaidStateDelaySec==0)) )
-        {
-          Trans.State = trIdle;
-          ret = 1;
-        }
-        break;
-      
-      case trHandshake:
-        if (!IsHardwareOkay())
-          break;
-        if ((Trans.State==trPaid)||(Trans.State==trIdle))
-        {
-          Trans.PaidStateDelaySec = 0;
-          Trans.State = trHandshake;
-          ret = 1;
-        }
-        break;
-      
-      case trAuthen:
-        if (!IsHardwareOkay())
-          break;
-        if (Trans.State == trHandshake)
-        {
-            Trans.State = trAuthen;
-            ret = 1;
-        }
-        else if (Trans.State == trAuthen)
-        {
-          if (Config.Private.OpMode.OpenAndFree || Trans.Authorized) 
-          {            
-            CountUpTimerReset();
-            CountUpTimerStart();
-            ResetPowerVar(); //reset meter
-            Trans.State = trCharging;
-            ret = 1;
-          }
-        }
-        break;
-        
-      case trCharging:
-        break;
-      
-      case trParking:
-        if (Trans.State == trCharging)
-        {
-            if (Config.Private.OpMode.OpenAndFree) 
-              Trans_SetState(trBilling, 0);
-            else if (Trans.Bill.IsPayByRFIDCard)
-              Trans_SetState(trBilling, 0);
-            else
-            {
-              Trans.State = trParking;
-              CountUpTimerReset(); //reset timer to time parking seconds
-            }
-            ret = 1;
-        }
-        break;
-        
-      case trBilling:
-        if ((Trans.State==trCharging)||(Trans.State==trParking))
-        {
-          if (Config.Private.OpMode.OpenAndFree) 
-            Trans_SetState(trPaid, 0);
-          else 
-          {
-            Trans.State = trBilling;
-          }
-          CountUpTimerStop(); //stop counting parking seconds
-          ret = 1;
-          //tell user about end of charging
-        }
-        break;
-
-      case trPaid:
-        if ((Trans.State==trBilling)||(Trans.State==trCharging))
-        {
-          Trans.Authorized = FALSE;
-          Trans.Bill.PaidAmount = paidAmount;
-          Trans.Bill.IsPaid = 1;
-          if (Config.Private.OpMode.OpenAndFree)
-            Trans.PaidStateDelaySec = 0;
-          else
-            Trans.PaidStateDelaySec = 30; //delay 30s
-          Trans.State = trPaid;
-          ret = 1;
-        } 
-        break;
-    }
-  UNMASK_IRQ
-  return ret;
-}
-
-void Trans_SetAuthorized(uint8_t authorized)
-{
-  MASK_IRQ
-    Trans.Authorized = authorized;
-  UNMASK_IRQ
-}
-
-float Trans_CheckBill(void)
-{
-  TBill *pBill;
-  float parkingHr, payable;
-
-  MASK_IRQ
-    pBill = &Trans.Bill;
-    if (Trans.State == trCharging)    
-    {
-      pBill->ChargingSec = CountUpTimerGet();        
-      GetPowerVar(NULL, &pBill->Energy_kWh);
-    }
-    else if (Trans.State == trParking) //parking penality
-    {
-      pBill->ParkingMin = (CountUpTimerGet()+59)/60;  
-      if (pBill->ParkingMin > Config.Public.Rates.FreeParking_min)
-        pBill->ParkPenalty = (pBill->ParkingMin - Config.Public.Rates.FreeParking_min)*Config.Public.Rates.ParkPenalty_min;
-      else
-        pBill->ParkPenalty = 0;
-    }
-    pBill->EnergyFee = pBill->Energy_kWh*Config.Public.Rates.Energy_kWh; //energy fee
-    parkingHr = (pBill->ChargingSec+59)/60/60;
-    pBill->ParkingFee = parkingHr*Config.Public.Rates.Parking_hr; //parking fee
-    if (pBill->IsPayByRFIDCard && Trans.Card.ChargeCard.IsFreeCard)
-      pBill->PayableAmount = 0;
-    else
-      pBill->PayableAmount  = pBill->EnergyFee + pBill->ParkingFee + pBill->ParkPenalty;
-    payable = pBill->PayableAmount;
-  UNMASK_IRQ
-  return payable;
-}
-
-float Trans_GetCardCredit(void)
-{
-  MASK_IRQ    
-    float ret = Trans.Card.ChargeCard.Credit;
-  UNMASK_IRQ
-  return ret;
-}
-
-void Trans_SetCardCredit(float credit)
-{
-  MASK_IRQ
-    Trans.Card.ChargeCard.Credit = credit;
-  UNMASK_IRQ
-}
-
-uint8_t Trans_IsCreditOut(void)
-{
-  uint8_t ret = 0;
-  if (Config.Private.OpMode.OpenAndFree)
-    return 0;
-  float payable = Trans_CheckBill();
-  MASK_IRQ
-    ret = payable >= Trans.Credit+1;
-  UNMASK_IRQ
-  return ret;
-}
-
-void Trans_AuthenRFIDCard(TCard *ACard)
-{
-  MASK_IRQ
-    Trans.Authorized = TRUE;
-    memset(&Trans.Bill, 0, sizeof(Trans.Bill));
-    Trans.Bill.IsPayByRFIDCard = TRUE;    
-    memcpy(Trans.Card.CardSn, ACard->Serial, sizeof(Trans.Card.CardSn));
-    Trans.Card.ChargeCard = ACard->As.ChargeCard;
-    Trans.Credit = ACard->As.ChargeCard.Credit;
-  UNMASK_IRQ
-}
-
-void Trans_Authen(float credit, uint32_t delaySec)
-{
-  DlyTimerSet(delaySec);
-  MASK_IRQ
-    Trans.Authorized = TRUE;
-    Trans.Credit = credit;
-    memset(&Trans.Bill, 0, sizeof(Trans.Bill));
-    Trans.Bill.IsPayByRFIDCard = FALSE;    
-    memset(&Trans.Card, 0, sizeof(Trans.Card));
-  UNMASK_IRQ
-}
-
-uint8_t Trans_IsSameCard(TCard *ACard)
-{
-  MASK_IRQ
-    uint8_t ret = memcmp(ACard->Serial, Trans.Card.CardSn, sizeof(Trans.Card.CardSn))==0;
-  UNMASK_IRQ
-  return ret;
-}
-
-void Trans_GetBill(TBill *bill)
-{
-  float ret = Trans_CheckBill();
-  MASK_IRQ
-    *bill = Trans.Bill;
-  UNMASK_IRQ  
-}
-
-uint8_t Trans_IsPayByCard(void)
-{
-  MASK_IRQ
-    uint8_t ret = Trans.Bill.IsPayByRFIDCard;
-  UNMASK_IRQ  
-  return ret;
-}
-
-float Trans_GetPaidAmount(void)
-{
-  MASK_IRQ
-    float ret = Trans.Bill.PaidAmount;
-  UNMASK_IRQ  
-  return ret;
-}
-
-void Trans_PaidStateDelayTick(void)
-{
-  MASK_IRQ
-    if (Trans.PaidStateDelaySec>0)
-      Trans.PaidStateDelaySec--;
-  UNMASK_IRQ  
-}
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#include <string.h>
+#include "hal.h"
+#include "trans.h"
+#include "stm32f10x_it.h"
+#include "CT_Thread.h"
+#include "dhThread.h"
+#include "app_main.h"
+#include "trace.h"
+#include "taper.h"
+#include "tariff.h"
+
+static TTrans Trans[CONNECTORS];
+static TTransDone Done[CONNECTORS];
+
+//published copy of the bill, readers take it without masking interrupts
+static struct
+{
+  __IO uint32_t Seq; //odd while being written
+  TBill Bill;
+  uint8_t Closed;
+} Snap[CONNECTORS];
+
+//bill accumulator, touched by Trans_BillTick only
+static struct
+{
+  int64_t EnergyFee; //milli-currency*1000 
+  TTransState Meter; //trCharging or trParking while metering, trIdle otherwise
+} Acc[CONNECTORS];
+
+//called under MASK_IRQ after every change of Trans[conn].Bill
+static void publishBill(uint8_t conn)
+{
+  Snap[conn].Seq++;
+  __DMB();
+  Snap[conn].Bill = Trans[conn].Bill;
+  Snap[conn].Closed = Trans[conn].MeterClosed;
+  __DMB();
+  Snap[conn].Seq++;
+}
+
+//called under MASK_IRQ, zeroes the metered part of the bill
+static void resetMeter(uint8_t conn)
+{
+  TBill *b = &Trans[conn].Bill;
+  b->ChargingSec = b->ParkingMin = b->Energy_Wh = 0;
+  b->EnergyFee = b->ParkingFee = b->ParkPenalty = b->PayableAmount = 0;
+  memset(b->ClassWh, 0, sizeof(b->ClassWh));
+  Trans[conn].BillReset = 1;
+  Trans[conn].MeterClosed = 0;
+  Trans[conn].StopWh = ENERGY_NO_STOP;
+  publishBill(conn);
+}
+
+static void setState(uint8_t conn, TTransState state)
+{
+  Trans[conn].State = state;
+  Trace_Record(teTrans, conn<<4|state);
+}
+
+TTransState Trans_GetState(uint8_t conn)
+{
+  MASK_IRQ
+    TTransState ret =  Trans[conn].State;
+  UNMASK_IRQ
+  return ret;
+}
+
+char* Trans_GetStateName(uint8_t conn)
+{
+  char *s = "";
+  switch(Trans_GetState(conn))
+  {
+    case trIdle:
+      s = "idle";
+      break;
+    case trHandshake:
+      s = "handshake";
+      break;
+    case trAuthen:
+      s = "authen";
+      break;
+    case trCharging:
+      s = "charging";
+      break;
+    case trParking:
+      s = "parking";
+      break;
+    case trBilling:
+      s = "billing";
+      break;
+    case trPaid:
+      s = "paid";
+      break;
+  }
+  return s;
+}
+
+int Trans_SetState(uint8_t conn, TTransState newState, TMilli paidAmount)
+{
+  int ret = 0;
+  MASK_IRQ
+    switch(newState)
+    {
+      case trIdle:
+        if ( (Trans[conn].State==trAuthen)||(Trans[conn].State==trHandshake)||
+          ((Trans[conn].State==trPaid)&&(Trans[conn].PaidStateDelaySec==0)) )
+        {
+          setState(conn, trIdle);
+          ret = 1;
+        }
+        break;
+      
+      case trHandshake:
+        if (!IsHardwareOkay())
+          break;
+        if ((Trans[conn].State==trPaid)||(Trans[conn].State==trIdle))
+        {
+          Trans[conn].PaidStateDelaySec = 0;
+          setState(conn, trHandshake);
+          ret = 1;
+        }
+        break;
+      
+      case trAuthen:
+        if (!IsHardwareOkay())
+          break;
+        if (Trans[conn].State == trHandshake)
+        {
+            setState(conn, trAuthen);
+            ret = 1;
+        }
+        else if (Trans[conn].State == trAuthen)
+        {
+          if (Config.Private.OpMode.OpenAndFree || Trans[conn].Authorized) 
+          {            
+            //session timer, meter and taper analyser, the board has one set
+            CountUpTimerReset();
+            CountUpTimerStart();
+            ResetPowerVar(); //reset meter
+            resetMeter(conn);
+            Taper_Reset();
+            Trans[conn].Session++;
+            Trans[conn].StartTime = LocalTime_Get();
+            setState(conn, trCharging);
+            ret = 1;
+          }
+        }
+        break;
+        
+      case trCharging:
+        break;
+      
+      case trParking:
+        if (Trans[conn].State == trCharging)
+        {
+            if (Config.Private.OpMode.OpenAndFree) 
+              Trans_SetState(conn, trBilling, 0);
+            else if (Trans[conn].Bill.IsPayByRFIDCard)
+              Trans_SetState(conn, trBilling, 0);
+            else
+            {
+              setState(conn, trParking);
+              CountUpTimerReset(); //reset timer to time parking seconds
+            }
+            ret = 1;
+        }
+        break;
+        
+      case trBilling:
+        if ((Trans[conn].State==trCharging)||(Trans[conn].State==trParking))
+        {
+          if (Config.Private.OpMode.OpenAndFree) 
+            Trans_SetState(conn, trPaid, 0);
+          else 
+          {
+            setState(conn, trBilling);
+          }
+          CountUpTimerStop(); //stop counting parking seconds
+          ret = 1;
+          //tell user about end of charging
+        }
+        break;
+
+      case trPaid:
+        if ((Trans[conn].State==trBilling)||(Trans[conn].State==trCharging))
+        {
+          Trans[conn].Authorized = FALSE;
+          Trans[conn].Bill.PaidAmount = paidAmount;
+          Trans[conn].Bill.IsPaid = 1;
+          publishBill(conn);
+          Done[conn].Session = Trans[conn].Session;
+          Done[conn].StartTime = Trans[conn].StartTime;
+          Done[conn].EndTime = LocalTime_Get();
+          memcpy(Done[conn].CardSn, Trans[conn].Card.CardSn, sizeof(Done[conn].CardSn));
+          Done[conn].IsFreeCard = Trans[conn].Card.ChargeCard.IsFreeCard;
+          Done[conn].Group = Trans[conn].Group;
+          Done[conn].Bill = Trans[conn].Bill;
+          if (Config.Private.OpMode.OpenAndFree)
+            Trans[conn].PaidStateDelaySec = 0;
+          else
+            Trans[conn].PaidStateDelaySec = 30; //delay 30s
+          setState(conn, trPaid);
+          ret = 1;
+        } 
+        break;
+    }
+  UNMASK_IRQ
+  return ret;
+}
+
+void Trans_SetAuthorized(uint8_t conn, uint8_t authorized)
+{
+  MASK_IRQ
+    Trans[conn].Authorized = authorized;
+  UNMASK_IRQ
+}
+
+//metered part computed by the tick, dropped if the bill was restarted meanwhile
+static void storeBill(uint8_t conn, const TBill *bill, uint8_t closed, uint32_t stop)
+{
+  MASK_IRQ
+    Trans[conn].StopWh = stop;
+    if (!Trans[conn].BillReset) 
+    {
+      Trans[conn].Bill.ChargingSec = bill->ChargingSec;
+      Trans[conn].Bill.ParkingMin = bill->ParkingMin;
+      Trans[conn].Bill.Energy_Wh = bill->Energy_Wh;
+      memcpy(Trans[conn].Bill.ClassWh, bill->ClassWh, sizeof(bill->ClassWh));
+      Trans[conn].Bill.EnergyFee = bill->EnergyFee;
+      Trans[conn].Bill.ParkingFee = bill->ParkingFee;
+      Trans[conn].Bill.ParkPenalty = bill->ParkPenalty;
+      Trans[conn].Bill.PayableAmount = bill->PayableAmount;
+      Trans[conn].MeterClosed = closed;
+      publishBill(conn);
+    }
+  UNMASK_IRQ
+}
+
+//called under MASK_IRQ, one table index per session, the tick never looks up
+static void resolvePolicy(uint8_t conn, int32_t group)
+{
+  Trans[conn].Group = (group>=0)&&(group<POLICY_GROUPS)? group: 0;
+  Trans[conn].Policy = Config.Public.Policy.Group[Trans[conn].Group];
+}
+
+//what the session may spend, -1 unlimited. Called under MASK_IRQ.
+static TMilli costLimit(uint8_t conn)
+{
+  if (Config.Private.OpMode.OpenAndFree)
+    return -1;
+  if (Trans[conn].Bill.IsPayByRFIDCard)
+    return Trans[conn].Card.ChargeCard.IsFreeCard? -1: Trans[conn].Credit;
+  if (Trans[conn].CapAmount && (Trans[conn].CapAmount < Trans[conn].Credit))
+    return Trans[conn].CapAmount;
+  return Trans[conn].Credit;
+}
+
+static TMilli parkPenalty(uint32_t parkingMin)
+{
+  if (parkingMin > Config.Public.Rates.FreeParking_min)
+    return (parkingMin - Config.Public.Rates.FreeParking_min)*Config.Public.Rates.ParkPenalty_min;
+  return 0;
+}
+
+//per-second bill update by the connector's single owner, its pilot state
+//machine, with its session timer and energy counter. Inputs are taken and
+//the result stored under short masks, the arithmetic runs unmasked.
+void Trans_BillTick(uint8_t conn, uint32_t sec, uint32_t wh)
+{
+  TTransState state, prev;
+  TBill bill;
+  TMilli rate, limit;
+  TGroupPolicy policy;
+  uint32_t capWh, stop = ENERGY_NO_STOP;
+  uint8_t cls;
+
+  MASK_IRQ
+    state = Trans[conn].State;
+    bill = Trans[conn].Bill;
+    limit = costLimit(conn);
+    capWh = Trans[conn].CapWh;
+    policy = Trans[conn].Policy;
+    if (Trans[conn].BillReset)
+    {
+      Trans[conn].BillReset = 0;
+      Acc[conn].EnergyFee = 0;
+      Acc[conn].Meter = trIdle;
+    }
+  UNMASK_IRQ
+  rate = (int64_t)Tariff_GetRate(&cls)*policy.EnergyPct/100; //as charged to the group
+  prev = Acc[conn].Meter;
+  Acc[conn].Meter = ((state==trCharging)||(state==trParking))? state: trIdle;
+  //one more pass after leaving a metered state picks up its final reading
+  if ((state==trCharging)||(prev==trCharging))
+  {
+    if (state!=trParking) //parking restarts the timer
+      bill.ChargingSec = sec;
+    if (wh > bill.Energy_Wh) //split at band boundaries with one second resolution
+    {
+      Acc[conn].EnergyFee += (int64_t)(wh-bill.Energy_Wh)*rate;
+      bill.ClassWh[cls] += wh-bill.Energy_Wh;
+      bill.Energy_Wh = wh;
+    }
+  }
+  if ((state==trParking)||(prev==trParking)) //parking penality
+  {
+    bill.ParkingMin = (sec+59)/60;
+    bill.ParkPenalty = (policy.Flags & POLICY_NO_PENALTY)? 0: parkPenalty(bill.ParkingMin);
+  }
+  bill.EnergyFee = (Acc[conn].EnergyFee+500)/1000; //energy fee, rounded
+  bill.ParkingFee = ((bill.ChargingSec+59)/60/60)*Config.Public.Rates.Parking_hr; //parking fee, whole hours
+  bill.ParkingFee = (int64_t)bill.ParkingFee*policy.ParkingPct/100;
+  if (bill.IsPayByRFIDCard && Trans[conn].Card.ChargeCard.IsFreeCard)
+    bill.PayableAmount = 0;
+  else
+    bill.PayableAmount  = bill.EnergyFee + bill.ParkingFee + bill.ParkPenalty;
+  if (state==trCharging) //the cost cap is turned into energy at the current rate
+  {
+    if (capWh)
+      stop = capWh;
+    if ((limit>=0) && ((rate>0)||(bill.PayableAmount>=limit)))
+    {
+      int64_t left = limit>bill.PayableAmount? (int64_t)(limit-bill.PayableAmount)*1000/rate: 0;
+      if (bill.Energy_Wh+left < stop)
+        stop = bill.Energy_Wh+left;
+    }
+  }
+  storeBill(conn, &bill, Acc[conn].Meter==trIdle, stop);
+}
+
+//consistent copy of the published bill, retried if a tick published meanwhile
+static uint8_t readBill(uint8_t conn, TBill *bill)
+{
+  uint32_t seq;
+  uint8_t closed;
+  do
+  {
+    seq = Snap[conn].Seq;
+    __DMB();
+    *bill = Snap[conn].Bill;
+    closed = Snap[conn].Closed;
+    __DMB();
+  } while ((seq & 1)||(seq != Snap[conn].Seq));
+  return closed;
+}
+
+TMilli Trans_CheckBill(uint8_t conn)
+{
+  TBill bill;
+  readBill(conn, &bill);
+  return bill.PayableAmount;
+}
+
+//true once the tick has taken the final energy and parking readings
+uint8_t Trans_IsBillClosed(uint8_t conn)
+{
+  TBill bill;
+  return readBill(conn, &bill);
+}
+
+TMilli Trans_GetCardCredit(uint8_t conn)
+{
+  MASK_IRQ    
+    TMilli ret = Trans[conn].Card.ChargeCard.Credit;
+  UNMASK_IRQ
+  return ret;
+}
+
+void Trans_SetCardCredit(uint8_t conn, TMilli credit)
+{
+  MASK_IRQ
+    Trans[conn].Card.ChargeCard.Credit = credit;
+  UNMASK_IRQ
+}
+
+uint8_t Trans_IsCreditOut(uint8_t conn)
+{
+  uint8_t ret = 0;
+  if (Config.Private.OpMode.OpenAndFree)
+    return 0;
+  TMilli payable = Trans_CheckBill(conn);
+  MASK_IRQ
+    //the energy stop ends the session on the cap, this catches a rate or
+    //parking fee step that the stop did not foresee
+    ret = (payable >= Trans[conn].Credit+1000)||(Trans[conn].Bill.Energy_Wh >= Trans[conn].StopWh);
+  UNMASK_IRQ
+  return ret;
+}
+
+void Trans_AuthenRFIDCard(uint8_t conn, TCard *ACard)
+{
+  MASK_IRQ
+    Trans[conn].Authorized = TRUE;
+    memset(&Trans[conn].Bill, 0, sizeof(Trans[conn].Bill));
+    Trans[conn].Bill.IsPayByRFIDCard = TRUE;    
+    memcpy(Trans[conn].Card.CardSn, ACard->Serial, sizeof(Trans[conn].Card.CardSn));
+    Trans[conn].Card.ChargeCard = ACard->As.ChargeCard;
+    Trans[conn].Credit = ACard->As.ChargeCard.Credit;
+    Trans[conn].CapWh = Trans[conn].CapAmount = 0;
+    resolvePolicy(conn, ACard->As.ChargeCard.Group);
+    resetMeter(conn);
+  UNMASK_IRQ
+}
+
+//capWh and capAmount stop the session on an energy or cost cap, 0 for none
+void Trans_Authen(uint8_t conn, TMilli credit, uint32_t delaySec, uint32_t capWh, TMilli capAmount)
+{
+  DlyTimerSet(delaySec);
+  MASK_IRQ
+    Trans[conn].Authorized = TRUE;
+    Trans[conn].Credit = credit;
+    Trans[conn].CapWh = capWh;
+    Trans[conn].CapAmount = capAmount;
+    resolvePolicy(conn, 0);
+    memset(&Trans[conn].Bill, 0, sizeof(Trans[conn].Bill));
+    Trans[conn].Bill.IsPayByRFIDCard = FALSE;    
+    memset(&Trans[conn].Card, 0, sizeof(Trans[conn].Card));
+    resetMeter(conn);
+  UNMASK_IRQ
+}
+
+//meter reading where the charging has to stop, ENERGY_NO_STOP if no cap
+//applies. Recomputed by every bill tick.
+uint32_t Trans_GetEnergyStop(uint8_t conn)
+{
+  MASK_IRQ
+    uint32_t ret = Trans[conn].StopWh;
+  UNMASK_IRQ
+  return ret;
+}
+
+uint8_t Trans_IsSameCard(uint8_t conn, TCard *ACard)
+{
+  MASK_IRQ
+    uint8_t ret = memcmp(ACard->Serial, Trans[conn].Card.CardSn, sizeof(Trans[conn].Card.CardSn))==0;
+  UNMASK_IRQ
+  return ret;
+}
+
+void Trans_GetBill(uint8_t conn, TBill *bill)
+{
+  readBill(conn, bill);
+}
+
+uint8_t Trans_IsPayByCard(uint8_t conn)
+{
+  MASK_IRQ
+    uint8_t ret = Trans[conn].Bill.IsPayByRFIDCard;
+  UNMASK_IRQ  
+  return ret;
+}
+
+TMilli Trans_GetPaidAmount(uint8_t conn)
+{
+  MASK_IRQ
+    TMilli ret = Trans[conn].Bill.PaidAmount;
+  UNMASK_IRQ  
+  return ret;
+}
+
+void Trans_PaidStateDelayTick(uint8_t conn)
+{
+  MASK_IRQ
+    if (Trans[conn].PaidStateDelaySec>0)
+      Trans[conn].PaidStateDelaySec--;
+  UNMASK_IRQ  
+}
+
+void Trans_GetSession(uint8_t conn, TTransSession *session)
+{
+  MASK_IRQ
+    session->State = Trans[conn].State;
+    session->Session = Trans[conn].Session;
+    memcpy(session->CardSn, Trans[conn].Card.CardSn, sizeof(session->CardSn));
+    session->Credit = Trans[conn].Credit;
+    session->IsPayByRFIDCard = Trans[conn].Bill.IsPayByRFIDCard;
+    session->IsFreeCard = Trans[conn].Card.ChargeCard.IsFreeCard;
+    session->Group = Trans[conn].Group;
+    session->StartTime = Trans[conn].StartTime;
+  UNMASK_IRQ
+}
+
+//brings back a session cut by a power loss, it waits in billing with the
+//last checkpointed meter reading. Called once at boot before the threads run.
+void Trans_Restore(uint8_t conn, const TTransSession *session, const TBill *bill)
+{
+  MASK_IRQ
+    memset(&Trans[conn], 0, sizeof(Trans[conn]));
+    Trans[conn].Session = session->Session;
+    Trans[conn].Credit = session->Credit;
+    memcpy(Trans[conn].Card.CardSn, session->CardSn, sizeof(Trans[conn].Card.CardSn));
+    Trans[conn].Card.ChargeCard.Credit = session->Credit;
+    Trans[conn].Card.ChargeCard.IsFreeCard = session->IsFreeCard;
+    Trans[conn].Card.ChargeCard.Group = session->Group;
+    resolvePolicy(conn, session->Group);
+    Trans[conn].Bill.IsPayByRFIDCard = session->IsPayByRFIDCard;
+    Trans[conn].Bill.ChargingSec = bill->ChargingSec;
+    Trans[conn].Bill.ParkingMin = bill->ParkingMin;
+    Trans[conn].Bill.Energy_Wh = bill->Energy_Wh;
+    Trans[conn].Bill.EnergyFee = bill->EnergyFee;
+    memcpy(Trans[conn].Bill.ClassWh, bill->ClassWh, sizeof(Trans[conn].Bill.ClassWh));
+    Trans[conn].StartTime = session->StartTime;
+    Trans[conn].Bill.ParkPenalty = (Trans[conn].Policy.Flags & POLICY_NO_PENALTY)? 0: parkPenalty(bill->ParkingMin);
+    Trans[conn].MeterClosed = 1;
+    Acc[conn].EnergyFee = (int64_t)bill->EnergyFee*1000;
+    Acc[conn].Meter = trIdle;
+    setState(conn, trBilling);
+    publishBill(conn);
+  UNMASK_IRQ
+  Trans_BillTick(conn, 0, 0); //fees and payable amount, nothing is metered in billing
+}
+
+void Trans_GetDone(uint8_t conn, TTransDone *done)
+{
+  MASK_IRQ
+    *done = Done[conn];
+  UNMASK_IRQ
+}
@@ -1,72 +1,111 @@
-/**
- * The MIT License (MIT)
- *
- * Copyright (c) 2017 Ken W.T. Kan
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
- * THE SOFTWARE.
- */
- 
-#ifndef __TRANS_H__
-#define __TRANS_H__
-
-#include <stdint.h>
-#include "RFID_Card.h"
-
-typedef enum {trIdle, trHandshake, trAuthen, trCharging, trParking, trBilling, trPaid} TTransState;
-
-typedef struct
-{
-  uint32_t ChargingSec;
-  uint32_t ParkingMin;
-  float Energy_kWh;
-  float EnergyFee, ParkingFee, ParkPenalty; 
-  float PayableAmount, PaidAmount;
-  uint8_t IsPayByRFIDCard, IsPaid;
-} TBill;
-
-typedef struct
-{
-  TTransState State;
-  uint8_t Authorized;
-  float Credit;
-  TBill Bill;
-  struct
-  {
-    TCardSn CardSn;
-    TChargeCard ChargeCard;
-  } Card;
-  uint16_t PaidStateDelaySec;
-} TTrans;
-
-TTransState Trans_GetState(void);
-char* Trans_GetStateName(void);
-int Trans_SetState(TTransState newState, float paidAmount);
-void Trans_SetAuthorized(uint8_t authorized);
-float Trans_CheckBill(void);
-float Trans_GetCardCredit(void);
-void Trans_SetCardCredit(float credit);
-uint8_t Trans_IsCreditOut(void);
-void Trans_AuthenRFIDCard(TCard *ACard);
-void Trans_Authen(float credit, uint32_t delaySec);
-uint8_t Trans_IsSameCard(TCard *ACard);
-void Trans_GetBill(TBill *bill);
-uint8_t Trans_IsPayByCard(void);
-float Trans_GetPaidAmount(void);
-void Trans_PaidStateDelayTick(void);
-#endif
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Ken W.T. Kan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+ 
+#ifndef __TRANS_H__
+#define __TRANS_H__
+
+#include <stdint.h>
+#include "RFID_Card.h"
+
+typedef enum {trIdle, trHandshake, trAuthen, trCharging, trParking, trBilling, trPaid} TTransState;
+
+typedef struct
+{
+  uint32_t ChargingSec;
+  uint32_t ParkingMin;
+  uint32_t Energy_Wh;
+  uint32_t ClassWh[TARIFF_CLASSES]; //energy split by tariff class
+  TMilli EnergyFee, ParkingFee, ParkPenalty; //milli-currency
+  TMilli PayableAmount, PaidAmount;
+  uint8_t IsPayByRFIDCard, IsPaid;
+} TBill;
+
+typedef struct
+{
+  TTransState State;
+  uint8_t Authorized;
+  TMilli Credit;
+  TBill Bill;
+  struct
+  {
+    TCardSn CardSn;
+    TChargeCard ChargeCard;
+  } Card;
+  uint16_t PaidStateDelaySec;
+  uint8_t BillReset; //metered part restarted, owner drops its accumulator
+  uint8_t MeterClosed; //energy and parking time are final
+  uint16_t Session; //counts charging starts
+  uint32_t StartTime; //local seconds at charging start, 0 unknown
+  uint32_t CapWh; //energy cap, 0 none
+  TMilli CapAmount; //cost cap below the deposit, 0 none
+  uint32_t StopWh; //meter reading where a cap is reached, ENERGY_NO_STOP none
+  uint8_t Group; //card group the policy was resolved for
+  TGroupPolicy Policy; //resolved at authorisation, the bill tick only applies it
+} TTrans;
+
+//who pays for the session, as kept by the journal
+typedef struct
+{
+  TTransState State;
+  uint16_t Session;
+  TCardSn CardSn;
+  TMilli Credit;
+  uint8_t IsPayByRFIDCard, IsFreeCard;
+  uint8_t Group;
+  uint32_t StartTime; //local seconds at charging start, 0 unknown
+} TTransSession;
+
+//the last paid session, kept until the next one is paid
+typedef struct
+{
+  uint16_t Session;
+  uint32_t StartTime, EndTime; //local seconds, 0 unknown
+  TCardSn CardSn;
+  uint8_t IsFreeCard;
+  uint8_t Group;
+  TBill Bill;
+} TTransDone;
+
+TTransState Trans_GetState(uint8_t conn);
+char* Trans_GetStateName(uint8_t conn);
+int Trans_SetState(uint8_t conn, TTransState newState, TMilli paidAmount);
+void Trans_SetAuthorized(uint8_t conn, uint8_t authorized);
+void Trans_BillTick(uint8_t conn, uint32_t sec, uint32_t wh);
+TMilli Trans_CheckBill(uint8_t conn);
+uint8_t Trans_IsBillClosed(uint8_t conn);
+TMilli Trans_GetCardCredit(uint8_t conn);
+void Trans_SetCardCredit(uint8_t conn, TMilli credit);
+uint8_t Trans_IsCreditOut(uint8_t conn);
+void Trans_AuthenRFIDCard(uint8_t conn, TCard *ACard);
+void Trans_Authen(uint8_t conn, TMilli credit, uint32_t delaySec, uint32_t capWh, TMilli capAmount);
+uint32_t Trans_GetEnergyStop(uint8_t conn);
+uint8_t Trans_IsSameCard(uint8_t conn, TCard *ACard);
+void Trans_GetBill(uint8_t conn, TBill *bill);
+uint8_t Trans_IsPayByCard(uint8_t conn);
+TMilli Trans_GetPaidAmount(uint8_t conn);
+void Trans_PaidStateDelayTick(uint8_t conn);
+void Trans_GetSession(uint8_t conn, TTransSession *session);
+void Trans_Restore(uint8_t conn, const TTransSession *session, const TBill *bill);
+void Trans_GetDone(uint8_t conn, TTransDone *done);
+#endif